@@ -32,6 +32,10 @@ public class BattleFrame : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"NiagaraCore",
+				"NiagaraShader",
+				"RenderCore",
+				"RHI",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -5,4 +5,19 @@
 */
 
 #include "AgentConfigDataAsset.h"
+#include "BattleFrameBakedCurves.h"
 
+#if WITH_EDITOR
+void UAgentConfigDataAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// 只有曲线修改后才需要重新烘焙
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UAgentConfigDataAsset, Curves))
+	{
+		FBattleFrameCurveRegistry::Get().Invalidate(this);
+	}
+}
+#endif
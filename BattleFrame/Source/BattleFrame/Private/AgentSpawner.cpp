@@ -23,9 +23,15 @@
 #include "Traits/Team.h"
 #include "Traits/Tracing.h"
 #include "Traits/RegisterMultiple.h"
+#include "Traits/SpawnActor.h"
+#include "Traits/SpawningActor.h"
+#include "Traits/BakedCurves.h"
 #include "AnimToTextureDataAsset.h"
 #include "NiagaraSubjectRenderer.h"
 #include "BattleFrameFunctionLibraryRT.h"
+#include "BattleFrameGameMode.h"
+#include "BattleFrameBakedCurves.h"
+#include "BattleFrameRandom.h"
 
 
 AAgentSpawner* AAgentSpawner::Instance = nullptr;
@@ -60,6 +66,13 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
     const auto Mechanism = UMachine::ObtainMechanism(GetWorld());
     if (!Mechanism) return SpawnedAgents;
 
+    ABattleFrameGameMode* GameMode = ABattleFrameGameMode::GetInstance();
+
+    if (GameMode)
+    {
+        GameMode->WaitForCrowdSimulation();
+    }
+
     ConfigIndex = FMath::Clamp(ConfigIndex, 0, AgentConfigAssets.Num() - 1);
     if(!AgentConfigAssets.IsValidIndex(ConfigIndex)) return SpawnedAgents;
 
@@ -108,7 +121,7 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
     AgentConfig.SetTrait(DataAsset->FX);
     AgentConfig.SetTrait(DataAsset->Sound);
     AgentConfig.SetTrait(DataAsset->SpawnActor);
-    AgentConfig.SetTrait(DataAsset->Curves);
+    AgentConfig.SetTrait(FBakedCurves{ FBattleFrameCurveRegistry::Get().FindOrBake(DataAsset) });
 
     AgentConfig.SetTrait(FTracing{});
 
@@ -168,6 +181,8 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
         Animation.Dissolve = 0;
     }
 
+    AgentConfig.GetTraitRef<FAgent>().Team = FMath::Clamp(Team, 0, 9);
+
     switch (FMath::Clamp(Team, 0, 9))
     {
         case 0:
@@ -216,8 +231,12 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
 
         FVector SpawnPoint2D;
 
-        float RandomX = FMath::RandRange(-Region.X / 2, Region.X / 2);
-        float RandomY = FMath::RandRange(-Region.Y / 2, Region.Y / 2);
+        // 随机位置只由种子与生成序号决定
+        const uint64 Seed = GameMode ? static_cast<uint32>(GameMode->RandomSeed) : 0;
+        const uint64 Sequence = SpawnSequence++;
+
+        float RandomX = FBattleFrameRandom::FRandRange(-Region.X / 2, Region.X / 2, Seed, 0, Sequence * 2, EBattleFrameRandomPurpose::SpawnLocation);
+        float RandomY = FBattleFrameRandom::FRandRange(-Region.Y / 2, Region.Y / 2, Seed, 0, Sequence * 2 + 1, EBattleFrameRandomPurpose::SpawnLocation);
         SpawnPoint2D = Origin + FVector(RandomX, RandomY, 0);
 
         FVector SpawnPoint3D;
@@ -225,7 +244,7 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
 
         if (Move.bCanFly)
         {
-            SpawnPoint3D = FVector(SpawnPoint2D.X, SpawnPoint2D.Y, FMath::RandRange(Move.FlyHeightRange.X, Move.FlyHeightRange.Y));
+            SpawnPoint3D = FVector(SpawnPoint2D.X, SpawnPoint2D.Y, FBattleFrameRandom::FRandRange(Move.FlyHeightRange.X, Move.FlyHeightRange.Y, Seed, 0, Sequence, EBattleFrameRandomPurpose::SpawnHeight));
         }
         else
         {
@@ -290,6 +309,7 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
 
         Agent.SetTrait(FAvoiding{ SpawnPoint3D, Collider.Radius, Agent, Agent.CalcHash()});
 
+        // 出生与索敌的计时由游戏模式在第一次见到该个体时安排
         SpawnedAgents.Add(Agent);
     }
 
@@ -298,6 +318,11 @@ TArray<FSubjectHandle> AAgentSpawner::SpawnAgentsRectangular
 
 void AAgentSpawner::KillAllAgents()
 {
+    if (ABattleFrameGameMode* GameMode = ABattleFrameGameMode::GetInstance())
+    {
+        GameMode->WaitForCrowdSimulation();
+    }
+
     const auto Mechanism = UMachine::ObtainMechanism(GetWorld());
 
     FFilter Filter = FFilter::Make<FAgent>();
@@ -312,6 +337,11 @@ void AAgentSpawner::KillAllAgents()
 
 void AAgentSpawner::KillAgentsByIndex(int32 Index)
 {
+    if (ABattleFrameGameMode* GameMode = ABattleFrameGameMode::GetInstance())
+    {
+        GameMode->WaitForCrowdSimulation();
+    }
+
     const auto Mechanism = UMachine::ObtainMechanism(GetWorld());
 
     FFilter Filter = FFilter::Make<FAgent, FHealth>().Exclude<FDying>();
@@ -0,0 +1,116 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameBakedCurves.h"
+#include "AgentConfigDataAsset.h"
+
+namespace
+{
+	void BakeOrDefault(FBakedCurve& Baked, const FRuntimeFloatCurve& Curve, const FRuntimeFloatCurve& Default)
+	{
+		const FRichCurve* RichCurve = Curve.GetRichCurveConst();
+
+		// 没有关键帧时使用默认曲线
+		if (!RichCurve || RichCurve->GetNumKeys() == 0)
+		{
+			RichCurve = Default.GetRichCurveConst();
+		}
+
+		Baked.Bake(*RichCurve);
+	}
+}
+
+void FBakedCurve::Bake(const FRichCurve& Curve)
+{
+	EndTime = Curve.GetNumKeys() > 0 ? FMath::Max(Curve.GetLastKey().Time, 0.f) : 0.f;
+	SamplesPerSecond = EndTime > 0.f ? (SamplesNum - 1) / EndTime : 0.f;
+
+	for (int32 i = 0; i < SamplesNum; ++i)
+	{
+		Samples[i] = Curve.Eval(EndTime * i / (SamplesNum - 1));
+	}
+}
+
+FBattleFrameCurveRegistry& FBattleFrameCurveRegistry::Get()
+{
+	static FBattleFrameCurveRegistry Registry;
+	return Registry;
+}
+
+FBattleFrameCurveRegistry::FBattleFrameCurveRegistry()
+{
+	Sets.Reserve(ReservedSetsNum);
+	Bake(DefaultSet, nullptr);
+}
+
+int32 FBattleFrameCurveRegistry::FindOrBake(const UAgentConfigDataAsset* DataAsset)
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	const FObjectKey Key(DataAsset);
+
+	if (const int32* Found = Indices.Find(Key))
+	{
+		// 曲线被修改过，在原槽位重新烘焙
+		if (Invalidated.Remove(Key) > 0)
+		{
+			Bake(*Sets[*Found], DataAsset);
+		}
+
+		return *Found;
+	}
+
+	// 工作线程不加锁读取指针数组，超出预留会导致扩容
+	check(Sets.Num() < ReservedSetsNum);
+
+	TUniquePtr<FBakedCurveSet> Set = MakeUnique<FBakedCurveSet>();
+	Bake(*Set, DataAsset);
+
+	const int32 Index = Sets.Add(MoveTemp(Set));
+	Indices.Add(Key, Index);
+
+	return Index;
+}
+
+void FBattleFrameCurveRegistry::Invalidate(const UAgentConfigDataAsset* DataAsset)
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	const FObjectKey Key(DataAsset);
+
+	if (Indices.Contains(Key))
+	{
+		Invalidated.Add(Key, DataAsset);
+	}
+}
+
+void FBattleFrameCurveRegistry::RebakeInvalidated()
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	for (const TPair<FObjectKey, TWeakObjectPtr<const UAgentConfigDataAsset>>& Pair : Invalidated)
+	{
+		const UAgentConfigDataAsset* DataAsset = Pair.Value.Get();
+
+		if (DataAsset)
+		{
+			Bake(*Sets[Indices.FindChecked(Pair.Key)], DataAsset);
+		}
+	}
+
+	Invalidated.Reset();
+}
+
+void FBattleFrameCurveRegistry::Bake(FBakedCurveSet& Set, const UAgentConfigDataAsset* DataAsset)
+{
+	const FCurves Defaults;
+	const FCurves& Curves = IsValid(DataAsset) ? DataAsset->Curves : Defaults;
+
+	BakeOrDefault(Set.DissolveIn, Curves.DissolveIn, Defaults.DissolveIn);
+	BakeOrDefault(Set.DissolveOut, Curves.DissolveOut, Defaults.DissolveOut);
+	BakeOrDefault(Set.HitEmission, Curves.HitEmission, Defaults.HitEmission);
+	BakeOrDefault(Set.HitSqueezeSquash, Curves.HitSqueezeSquash, Defaults.HitSqueezeSquash);
+}
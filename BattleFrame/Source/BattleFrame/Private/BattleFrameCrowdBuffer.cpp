@@ -0,0 +1,76 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameCrowdBuffer.h"
+#include "Misc/ScopeLock.h"
+
+void FBattleFrameCrowdBuffer::SetNum(int32 InstancesNum, bool bAllowShrinking)
+{
+	const int32 OldNum = Num();
+	Data.SetNumZeroed(InstancesNum * Stride, bAllowShrinking);
+
+	for (int32 Id = OldNum; Id < InstancesNum; ++Id)
+	{
+		Data[Id * Stride + Orientation] = FVector4f(0.f, 0.f, 0.f, 1.f);
+		WritePooled(Id, true);
+	}
+}
+
+void FBattleFrameCrowdBuffer::Commit()
+{
+	// 渲染线程仍持有上一份快照时另开一份
+	if (!Spare.IsValid() || !Spare.IsUnique())
+	{
+		Spare = MakeShared<TArray<FVector4f>, ESPMode::ThreadSafe>();
+	}
+
+	*Spare = Data;
+
+	FScopeLock ScopeLock(&Mutex);
+	Swap(Spare, Published);
+	++Version;
+}
+
+uint64 FBattleFrameCrowdBuffer::GetVersion() const
+{
+	FScopeLock ScopeLock(&Mutex);
+	return Version;
+}
+
+FBattleFrameCrowdBuffer::FSnapshot FBattleFrameCrowdBuffer::GetPublished(uint64& KnownVersion) const
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	if (KnownVersion == Version) return FSnapshot();
+
+	KnownVersion = Version;
+	return Published;
+}
+
+FBattleFrameCrowdBufferRegistry& FBattleFrameCrowdBufferRegistry::Get()
+{
+	static FBattleFrameCrowdBufferRegistry Registry;
+	return Registry;
+}
+
+void FBattleFrameCrowdBufferRegistry::Register(const UObject* Component, const TSharedPtr<FBattleFrameCrowdBuffer>& Buffer)
+{
+	FScopeLock ScopeLock(&Mutex);
+	Buffers.Add(FObjectKey(Component), Buffer);
+}
+
+void FBattleFrameCrowdBufferRegistry::Unregister(const UObject* Component)
+{
+	FScopeLock ScopeLock(&Mutex);
+	Buffers.Remove(FObjectKey(Component));
+}
+
+TSharedPtr<FBattleFrameCrowdBuffer> FBattleFrameCrowdBufferRegistry::Find(const UObject* Component) const
+{
+	FScopeLock ScopeLock(&Mutex);
+	const TSharedPtr<FBattleFrameCrowdBuffer>* Found = Buffers.Find(FObjectKey(Component));
+	return Found ? *Found : TSharedPtr<FBattleFrameCrowdBuffer>();
+}
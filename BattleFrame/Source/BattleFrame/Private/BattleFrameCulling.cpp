@@ -0,0 +1,110 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameCulling.h"
+
+FBattleFrameCullingView FBattleFrameCullingView::MakePerspective(const FVector& Location, const FRotator& Rotation, float FOVDegrees, float AspectRatio, float MaxDistance, float Margin)
+{
+	FBattleFrameCullingView View;
+	View.bEnabled = MaxDistance > 0.f;
+	View.Location = Location;
+	View.MaxDistance = MaxDistance;
+	View.Margin = FMath::Max(Margin, 0.f);
+
+	const FRotationMatrix Axes(Rotation);
+	const FVector Forward = Axes.GetUnitAxis(EAxis::X);
+	const FVector Right = Axes.GetUnitAxis(EAxis::Y);
+	const FVector Up = Axes.GetUnitAxis(EAxis::Z);
+
+	View.Forward = Forward;
+	View.Right = Right;
+	View.Up = Up;
+	View.HalfWidth = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(FOVDegrees, 1.f, 179.f) * 0.5f));
+	View.HalfHeight = View.HalfWidth / FMath::Max(AspectRatio, KINDA_SMALL_NUMBER);
+
+	// 侧面经过相机，法线朝内
+	auto MakeSidePlane = [&](const FVector& Normal)
+	{
+		const FVector Unit = Normal.GetSafeNormal();
+		return FPlane(Unit, FVector::DotProduct(Unit, Location));
+	};
+
+	View.Planes[0] = MakeSidePlane(Right + Forward * View.HalfWidth);
+	View.Planes[1] = MakeSidePlane(-Right + Forward * View.HalfWidth);
+	View.Planes[2] = MakeSidePlane(Up + Forward * View.HalfHeight);
+	View.Planes[3] = MakeSidePlane(-Up + Forward * View.HalfHeight);
+	View.Planes[4] = FPlane(-Forward, -FVector::DotProduct(Forward, Location) - MaxDistance);
+
+	return View;
+}
+
+FBox FBattleFrameCullingView::GetBounds() const
+{
+	// 侧面外推 Margin 后顶点落到相机后方，水平与垂直两组侧面的顶点各自后退 Bh、Bv
+	const float Bh = Margin * FMath::Sqrt(1.f + HalfWidth * HalfWidth) / HalfWidth;
+	const float Bv = Margin * FMath::Sqrt(1.f + HalfHeight * HalfHeight) / HalfHeight;
+	const float NearDepth = -FMath::Min(Bh, Bv);
+	const float FarDepth = MaxDistance + Margin;
+
+	auto AddCorners = [&](FBox& Box, float Depth)
+	{
+		const FVector Center = Location + Forward * Depth;
+		const FVector HalfX = Right * (HalfWidth * (Depth + Bh));
+		const FVector HalfY = Up * (HalfHeight * (Depth + Bv));
+
+		Box += Center + HalfX + HalfY;
+		Box += Center + HalfX - HalfY;
+		Box += Center - HalfX + HalfY;
+		Box += Center - HalfX - HalfY;
+	};
+
+	FBox Box(ForceInit);
+	AddCorners(Box, NearDepth);
+	AddCorners(Box, FarDepth);
+
+	return Box;
+}
+
+void FBattleFrameCullingGrid::Build(const FBattleFrameCullingView& View, float CellSize)
+{
+	bEnabled = View.bEnabled;
+	VisibleNum = 0;
+
+	if (!bEnabled) return;
+
+	Bounds = View.GetBounds();
+
+	const FVector Size = Bounds.GetSize();
+	const float MaxSize = Size.GetMax();
+	const float FinalCellSize = FMath::Max3(CellSize, MaxSize / MaxCellsPerAxis, 1.f);
+
+	InvCellSize = 1.f / FinalCellSize;
+
+	// 向下取整再加一，恰好落在 Bounds.Max 上的点也有格子
+	CellsNum = FIntVector(
+		FMath::FloorToInt32(Size.X * InvCellSize) + 1,
+		FMath::FloorToInt32(Size.Y * InvCellSize) + 1,
+		FMath::FloorToInt32(Size.Z * InvCellSize) + 1);
+
+	Cells.SetNumUninitialized(CellsNum.X * CellsNum.Y * CellsNum.Z, false);
+
+	const FVector Extent(FinalCellSize * 0.5f);
+
+	for (int32 Z = 0; Z < CellsNum.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < CellsNum.Y; ++Y)
+		{
+			for (int32 X = 0; X < CellsNum.X; ++X)
+			{
+				const FVector Center = Bounds.Min + (FVector(X, Y, Z) + 0.5f) * FinalCellSize;
+				const bool bVisible = View.IntersectsBox(Center, Extent);
+
+				Cells[(Z * CellsNum.Y + Y) * CellsNum.X + X] = bVisible;
+				VisibleNum += bVisible;
+			}
+		}
+	}
+}
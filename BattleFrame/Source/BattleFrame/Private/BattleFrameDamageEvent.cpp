@@ -0,0 +1,50 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameDamageEvent.h"
+
+void FBattleFrameDamageBatch::Build(const TArray<FBattleFrameDamageEvent>& Unsorted)
+{
+	TargetIndices.Reset();
+	Targets.Reset();
+	Buckets.SetNumUninitialized(Unsorted.Num(), false);
+
+	// 按第一次出现的顺序给目标编号
+	for (int32 i = 0; i < Unsorted.Num(); ++i)
+	{
+		const int32 Bucket = TargetIndices.FindOrAdd(Unsorted[i].Target, Targets.Num());
+
+		if (Bucket == Targets.Num())
+		{
+			Targets.Add(Unsorted[i].Target);
+		}
+
+		Buckets[i] = Bucket;
+	}
+
+	Offsets.Reset();
+	Offsets.SetNumZeroed(Targets.Num() + 1, false);
+
+	for (const int32 Bucket : Buckets)
+	{
+		Offsets[Bucket + 1]++;
+	}
+
+	for (int32 i = 1; i < Offsets.Num(); ++i)
+	{
+		Offsets[i] += Offsets[i - 1];
+	}
+
+	// 稳定地放入各自的区间
+	Cursors.Reset();
+	Cursors.Append(Offsets.GetData(), Targets.Num());
+	Events.SetNum(Unsorted.Num(), false);
+
+	for (int32 i = 0; i < Unsorted.Num(); ++i)
+	{
+		Events[Cursors[Buckets[i]]++] = Unsorted[i];
+	}
+}
@@ -6,9 +6,16 @@
 #include "Traits/SubType.h"
 #include "SubjectHandle.h"
 #include "SubjectRecord.h"
+#include "BattleFrameGameMode.h"
 
 void UBattleFrameFunctionLibraryRT::SortSubjectsByDistance(UPARAM(ref) TArray<FSubjectHandle>& Results, const FVector& SortOrigin, ESortMode SortMode)
 {
+    // 读取位置前等待异步模拟
+    if (ABattleFrameGameMode* GameMode = ABattleFrameGameMode::GetInstance())
+    {
+        GameMode->WaitForCrowdSimulation();
+    }
+
     Results.Sort([&SortOrigin, SortMode](const FSubjectHandle& A, const FSubjectHandle& B) {
         const FVector PosA = A.GetTraitRef<FLocated, EParadigm::Unsafe>().Location;
         const FVector PosB = B.GetTraitRef<FLocated, EParadigm::Unsafe>().Location;
@@ -627,6 +634,16 @@ void UBattleFrameFunctionLibraryRT::SetSubTypeTraitByEnum(ESubType SubType, FSub
 	}
 }
 
+// 按SubType结构体取枚举，FSubType5 对应 ESubType::SubType5
+ESubType UBattleFrameFunctionLibraryRT::GetSubTypeEnumByStruct(const UScriptStruct* SubType)
+{
+	if (!SubType) return ESubType::None;
+
+	const int64 Value = StaticEnum<ESubType>()->GetValueByNameString(SubType->GetName());
+
+	return Value == INDEX_NONE ? ESubType::None : static_cast<ESubType>(Value);
+}
+
 // 按SubType序号Include Trait
 void UBattleFrameFunctionLibraryRT::IncludeSubTypeTraitByIndex(int32 Index, FFilter& Filter)
 {
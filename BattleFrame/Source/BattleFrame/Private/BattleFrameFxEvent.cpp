@@ -0,0 +1,144 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameFxEvent.h"
+
+namespace
+{
+	// 屏幕分区序号，屏幕外为 Regions * Regions
+	int32 GetScreenRegion(const FBattleFrameCullingView& View, const FVector& Location, int32 Regions)
+	{
+		FVector2D Screen;
+
+		if (!View.bEnabled || !View.ProjectToScreen(Location, Screen))
+		{
+			return Regions * Regions;
+		}
+
+		const int32 X = FMath::Min(static_cast<int32>(Screen.X * Regions), Regions - 1);
+		const int32 Y = FMath::Min(static_cast<int32>(Screen.Y * Regions), Regions - 1);
+
+		return Y * Regions + X;
+	}
+}
+
+int32 FBattleFrameFxBudget::GetMaxPerFrame(EBattleFrameFxCategory Category) const
+{
+	switch (Category)
+	{
+	case EBattleFrameFxCategory::Appear: return MaxAppearFxPerFrame;
+	case EBattleFrameFxCategory::Attack: return MaxAttackFxPerFrame;
+	case EBattleFrameFxCategory::Hit: return MaxHitFxPerFrame;
+	case EBattleFrameFxCategory::Death: return MaxDeathFxPerFrame;
+	default: return 0;
+	}
+}
+
+FBattleFrameFxEventQueue::FBattleFrameFxEventQueue()
+{
+	for (std::atomic<int32>& Num : RegisteredNum)
+	{
+		Num.store(0, std::memory_order_relaxed);
+	}
+}
+
+void FBattleFrameFxEventQueue::Register(ESubType SubType)
+{
+	if (SubType == ESubType::None) return;
+
+	RegisteredNum[static_cast<uint8>(SubType)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void FBattleFrameFxEventQueue::Unregister(ESubType SubType)
+{
+	if (SubType == ESubType::None) return;
+
+	const uint8 Type = static_cast<uint8>(SubType);
+
+	if (RegisteredNum[Type].fetch_sub(1, std::memory_order_relaxed) <= 1)
+	{
+		RegisteredNum[Type].store(0, std::memory_order_relaxed);
+		Buckets[Type].Empty();
+	}
+}
+
+int32 FBattleFrameFxEventQueue::Distribute(const FBattleFrameFxBudget* Budget, const FBattleFrameCullingView& View, TArray<FBattleFrameFxEvent>& OutUnrouted)
+{
+	Events.ConsumeTo(MergedEvents);
+
+	int32 DroppedNum = 0;
+
+	if (Budget)
+	{
+		// 分数高的优先，同分依次比较键值与位置
+		MergedEvents.Sort([](const FBattleFrameFxEvent& A, const FBattleFrameFxEvent& B)
+		{
+			if (A.Priority != B.Priority) return A.Priority > B.Priority;
+			if (A.Key != B.Key) return A.Key < B.Key;
+			if (A.Location.X != B.Location.X) return A.Location.X < B.Location.X;
+			if (A.Location.Y != B.Location.Y) return A.Location.Y < B.Location.Y;
+			return A.Location.Z < B.Location.Z;
+		});
+
+		const int32 Regions = FMath::Clamp(Budget->ScreenRegions, 1, 16);
+		RegionCounts.Reset();
+		RegionCounts.SetNumZeroed(Regions * Regions + 1);
+
+		int32 CategoryCounts[static_cast<uint8>(EBattleFrameFxCategory::Num)] = {};
+		int32 KeptNum = 0;
+
+		for (int32 i = 0; i < MergedEvents.Num(); ++i)
+		{
+			const FBattleFrameFxEvent& Event = MergedEvents[i];
+			const uint8 Category = static_cast<uint8>(Event.Category);
+			const int32 MaxPerFrame = Budget->GetMaxPerFrame(Event.Category);
+
+			if (MaxPerFrame > 0 && CategoryCounts[Category] >= MaxPerFrame)
+			{
+				++DroppedNum;
+				continue;
+			}
+
+			const int32 Region = GetScreenRegion(View, Event.Location, Regions);
+
+			if (Budget->MaxFxPerScreenRegion > 0 && RegionCounts[Region] >= Budget->MaxFxPerScreenRegion)
+			{
+				++DroppedNum;
+				continue;
+			}
+
+			++CategoryCounts[Category];
+			++RegionCounts[Region];
+			MergedEvents[KeptNum++] = Event;
+		}
+
+		MergedEvents.SetNum(KeptNum, false);
+	}
+
+	for (const FBattleFrameFxEvent& Event : MergedEvents)
+	{
+		if (IsRegistered(Event.SubType))
+		{
+			Buckets[static_cast<uint8>(Event.SubType)].Add(Event);
+		}
+		else
+		{
+			OutUnrouted.Add(Event);
+		}
+	}
+
+	MergedEvents.Reset();
+
+	return DroppedNum;
+}
+
+void FBattleFrameFxEventQueue::Consume(ESubType SubType, TArray<FBattleFrameFxEvent>& Out)
+{
+	TArray<FBattleFrameFxEvent>& Bucket = Buckets[static_cast<uint8>(SubType)];
+
+	Out.Append(Bucket);
+	Bucket.Reset();
+}
@@ -0,0 +1,127 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameFxSlotPool.h"
+
+void FBattleFrameFxSlotPool::Reset(bool bInLowestIndexFirst)
+{
+	bLowestIndexFirst = bInLowestIndexFirst;
+	Cooling.Reset();
+	Ready.Reset();
+	ReadyHeap.Reset();
+	Spawned.Reset();
+	SerialsBySlot.Reset();
+	NextSerial = 1;
+	ActiveNum = 0;
+}
+
+void FBattleFrameFxSlotPool::Update(double Now, double Cooldown)
+{
+	// 队列按释放时间排列，冷却时间对所有槽位相同，释放早的先结束，只需看队首
+	while (!Cooling.IsEmpty() && Cooling.First().ReleaseTime + Cooldown <= Now)
+	{
+		const int32 Slot = Cooling.Pop().Slot;
+
+		if (bLowestIndexFirst)
+		{
+			ReadyHeap.HeapPush(Slot);
+		}
+		else
+		{
+			Ready.Push(Slot);
+		}
+	}
+}
+
+int32 FBattleFrameFxSlotPool::Allocate(int32 MaxNum, bool& bOutNew, bool& bOutEvicted)
+{
+	bOutNew = false;
+	bOutEvicted = false;
+
+	int32 Slot = INDEX_NONE;
+
+	if (bLowestIndexFirst && ReadyHeap.Num() > 0)
+	{
+		ReadyHeap.HeapPop(Slot, false);
+	}
+	else if (!bLowestIndexFirst && !Ready.IsEmpty())
+	{
+		Slot = Ready.Pop();
+	}
+	else if (MaxNum <= 0 || Num() < MaxNum)
+	{
+		Slot = SerialsBySlot.Add(0);
+		bOutNew = true;
+	}
+	else
+	{
+		// 挤掉最早的特效
+		while (!Spawned.IsEmpty())
+		{
+			const FSpawned Oldest = Spawned.Pop();
+
+			if (SerialsBySlot[Oldest.Slot] == Oldest.Serial)
+			{
+				Slot = Oldest.Slot;
+				bOutEvicted = true;
+				--ActiveNum;
+				break;
+			}
+		}
+
+		// 全部在冷却中时提前复用最早释放的
+		if (Slot == INDEX_NONE && !Cooling.IsEmpty())
+		{
+			Slot = Cooling.Pop().Slot;
+		}
+	}
+
+	if (Slot != INDEX_NONE)
+	{
+		Occupy(Slot);
+	}
+
+	return Slot;
+}
+
+void FBattleFrameFxSlotPool::Release(int32 Slot, double ReleaseTime)
+{
+	if (!SerialsBySlot.IsValidIndex(Slot) || SerialsBySlot[Slot] == 0) return;
+
+	SerialsBySlot[Slot] = 0;
+	--ActiveNum;
+	Cooling.Push({ ReleaseTime, Slot });
+}
+
+void FBattleFrameFxSlotPool::Occupy(int32 Slot)
+{
+	SerialsBySlot[Slot] = NextSerial;
+	Spawned.Push({ NextSerial, Slot });
+	++ActiveNum;
+
+	if (++NextSerial == 0)
+	{
+		NextSerial = 1;
+	}
+
+	// 失效的条目过多时整理一次，均摊为 O(1)
+	if (Spawned.Num() > ActiveNum * 2 + 64)
+	{
+		TFifo<FSpawned> Live;
+
+		while (!Spawned.IsEmpty())
+		{
+			const FSpawned Entry = Spawned.Pop();
+
+			if (SerialsBySlot[Entry.Slot] == Entry.Serial)
+			{
+				Live.Push(Entry);
+			}
+		}
+
+		Spawned = MoveTemp(Live);
+	}
+}
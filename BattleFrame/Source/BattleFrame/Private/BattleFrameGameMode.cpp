@@ -6,6 +6,9 @@
 
 #include "BattleFrameGameMode.h"
 #include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/GameViewportClient.h"
 
 // Niagara 插件
 #include "NiagaraDataInterfaceArrayFunctionLibrary.h"
@@ -20,6 +23,12 @@
 #include "NeighborGridActor.h"
 #include "NeighborGridComponent.h"
 #include "BattleFrameFunctionLibraryRT.h"
+#include "BattleFrameStats.h"
+#include "BattleFrameBakedCurves.h"
+#include "BattleFrameAnimPhase.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/Task.h"
+#include "ProfilingDebugging/CountersTrace.h"
 
 // 移动相关 Traits
 #include "Traits/Move.h"
@@ -29,6 +38,7 @@
 #include "Traits/Death.h"
 #include "Traits/Dying.h"
 #include "Traits/DeathAnim.h"
+#include "Traits/DeathStarted.h"
 #include "Traits/DeathDissolve.h"
 #include "Traits/Appear.h"
 #include "Traits/Appearing.h"
@@ -39,8 +49,9 @@
 #include "Traits/RenderBatchData.h"
 #include "Traits/Attack.h"
 #include "Traits/Attacking.h"
-#include "Traits/TemporalDamaging.h"
+#include "Traits/Burning.h"
 #include "Traits/Tracing.h"
+#include "Traits/TimersScheduled.h"
 #include "Traits/SpawnActor.h"
 #include "Traits/Hit.h"
 #include "Traits/BeingHit.h"
@@ -51,7 +62,6 @@
 #include "Traits/Damage.h"
 #include "Traits/TextPopUp.h"
 #include "Traits/Freezing.h"
-#include "Traits/PoppingText.h"
 #include "Traits/Sound.h"
 #include "Traits/FX.h"
 #include "Traits/SpawningFx.h"
@@ -63,13 +73,185 @@
 #include "Traits/Located.h"
 #include "Traits/Avoidance.h"
 #include "Traits/Collider.h"
-#include "Traits/Curves.h"
+#include "Traits/BakedCurves.h"
 #include "Traits/Static.h"
 #include "Traits/Statistics.h"
 
 
 ABattleFrameGameMode* ABattleFrameGameMode::Instance = nullptr;
 
+TRACE_DECLARE_INT_COUNTER(BattleFrame_NiagaraUploadBytes, TEXT("BattleFrame/NiagaraUploadBytes"));
+
+namespace
+{
+	// 当前线程是否正在执行集群模拟
+	thread_local bool bCrowdSimulationThread = false;
+
+	// Niagara 数组在 GPU 上的单个元素大小，双精度类型以单精度存放
+	template<typename ElementType> constexpr int64 GetNiagaraElementSize() { return sizeof(ElementType); }
+	template<> constexpr int64 GetNiagaraElementSize<FVector>() { return sizeof(FVector3f); }
+	template<> constexpr int64 GetNiagaraElementSize<FVector4>() { return sizeof(FVector4f); }
+	template<> constexpr int64 GetNiagaraElementSize<FQuat>() { return sizeof(FQuat4f); }
+
+	// 长度变化或有改动时整体上传，没有改动则跳过，返回推送到 GPU 的字节数。
+	// 数组数据接口每次都会整体上传，逐个元素更新并不能减少传输量
+	template<typename ElementType, typename SetArrayType>
+	int64 UploadRenderChannel(FRenderBatchData& Data, ERenderChannel Channel, const FName Name, const TArray<ElementType>& Array, SetArrayType SetArray)
+	{
+		FRenderChannelState& State = Data.Channels[static_cast<uint8>(Channel)];
+
+		if (State.UploadedNum == Array.Num() && !State.bDirty)
+		{
+			return 0;
+		}
+
+		SetArray(Data.SpawnedNiagaraSystem, Name, Array);
+		State.UploadedNum = Array.Num();
+		State.bDirty = false;
+
+		return Array.Num() * GetNiagaraElementSize<ElementType>();
+	}
+
+	// 压缩编码的位置超出范围时，以本帧存活实例的包围盒中心为新原点重新编码；
+	// 包围盒本身超出编码范围时改为上传完整精度的数组
+	void RebaseQuantizeOrigin(FRenderBatchData& Data)
+	{
+		FBox Bounds(ForceInit);
+
+		for (int32 i = 0; i < Data.Transforms.Num(); ++i)
+		{
+			if (Data.ValidTransforms[i])
+			{
+				Bounds += Data.Transforms[i].GetLocation();
+			}
+		}
+
+		if (!Bounds.IsValid) return;
+
+		Data.bQuantizeChanged = true;
+
+		if (Bounds.GetExtent().GetMax() > FBattleFrameRenderQuantize::GetRange(Data.QuantizeStep))
+		{
+			// 材质特效与血条只有压缩值，解码后作为完整精度的初值，下次写入时更新
+			for (int32 i = 0; i < Data.Transforms.Num(); ++i)
+			{
+				Data.LocationArray[i] = Data.Transforms[i].GetLocation();
+				Data.OrientationArray[i] = Data.Transforms[i].GetRotation();
+				Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array[i] = FBattleFrameRenderQuantize::DecodeUnorm4(Data.Quantized_HitGlow_Freeze_Burn_Dissolve_Array[i]);
+				Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array[i] = FBattleFrameRenderQuantize::DecodeUnorm3(Data.Quantized_HealthBar_Array[i]);
+				Data.MarkDirty(i);
+			}
+
+			Data.bQuantized = false;
+			Data.Quantized_LocationXY_Array.Empty();
+			Data.Quantized_LocationZ_Yaw_Array.Empty();
+			Data.Quantized_HitGlow_Freeze_Burn_Dissolve_Array.Empty();
+			Data.Quantized_HealthBar_Array.Empty();
+			return;
+		}
+
+		Data.QuantizeOrigin = Bounds.GetCenter();
+
+		for (int32 i = 0; i < Data.Transforms.Num(); ++i)
+		{
+			if (!Data.ValidTransforms[i]) continue;
+
+			const FTransform& Transform = Data.Transforms[i];
+			Data.Write(ERenderChannel::QuantizedLocationXY, Data.Quantized_LocationXY_Array, i, FBattleFrameRenderQuantize::EncodeLocationXY(Transform.GetLocation(), Data.QuantizeOrigin, Data.QuantizeStep));
+			Data.Write(ERenderChannel::QuantizedLocationZYaw, Data.Quantized_LocationZ_Yaw_Array, i, FBattleFrameRenderQuantize::EncodeLocationZYaw(Transform.GetLocation(), Transform.GetRotation(), Data.QuantizeOrigin, Data.QuantizeStep));
+		}
+	}
+
+	// 个体移除前把渲染槽位还给批次
+	template<typename SubjectHandleType>
+	FORCEINLINE void ReleaseRenderInstance(SubjectHandleType Subject)
+	{
+		const FRendering* Rendering = Subject.template GetTraitPtr<FRendering, EParadigm::Unsafe>();
+
+		if (Rendering == nullptr) return;
+
+		if (FRenderBatchData* Data = Rendering->Renderer.template GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>())
+		{
+			Data->ReleaseInstance(Rendering->InstanceId);
+		}
+	}
+
+	// 血条向目标比例插值并决定是否显示
+	void UpdateHealthBar(FHealthBar& HealthBar, const FHealth& Health, float DeltaTime)
+	{
+		if (!HealthBar.bShowHealthBar)
+		{
+			HealthBar.Opacity = 0;
+			return;
+		}
+
+		HealthBar.TargetRatio = FMath::Clamp(Health.Current / Health.Maximum, 0, 1);
+		HealthBar.CurrentRatio = FMath::FInterpTo(HealthBar.CurrentRatio, HealthBar.TargetRatio, DeltaTime, HealthBar.InterpSpeed);// WIP use niagara instead
+
+		HealthBar.Opacity = HealthBar.HideOnFullHealth && Health.Current == Health.Maximum ? 0 : 1;
+
+		if (HealthBar.HideOnEmptyHealth && Health.Current <= 0)
+		{
+			HealthBar.Opacity = 0;
+		}
+	}
+
+	// 由渲染器以 Subject 形式处理的特效
+	FSubjectRecord MakeFxRecord(const FVector& Location, const FVector& Direction, const FVector& Scale, ESubType SubType)
+	{
+		FSubjectRecord FxRecord;
+		FxRecord.SetTrait(FSpawningFx{});
+		FxRecord.SetTrait(FLocated{ Location });
+		FxRecord.SetTrait(FDirected{ Direction });
+		FxRecord.SetTrait(FScaled{ Scale });
+
+		// 按枚举添加对应的 FSubTypeX
+		UBattleFrameFunctionLibraryRT::SetSubTypeTraitByEnum(SubType, FxRecord);
+
+		return FxRecord;
+	}
+
+	// 伤害数值的哈希，作为命中键的一部分
+	uint32 HashDmgSphere(const FDmgSphere& DmgSphere)
+	{
+		uint32 Hash = GetTypeHash(DmgSphere.Damage);
+		Hash = HashCombineFast(Hash, GetTypeHash(DmgSphere.KineticDmg));
+		Hash = HashCombineFast(Hash, GetTypeHash(DmgSphere.FireDmg));
+		Hash = HashCombineFast(Hash, GetTypeHash(DmgSphere.IceDmg));
+		Hash = HashCombineFast(Hash, GetTypeHash(DmgSphere.PercentDmg));
+		return Hash;
+	}
+
+	// 并行处理到期的计时，已失效的个体直接跳过
+	template<typename FunctionType>
+	void OperateTimersConcurrently(const TArray<FSubjectHandle>& Subjects, int32 ThreadsCount, int32 BatchSize, FunctionType&& Function)
+	{
+		ParallelFor(TEXT("BattleFrameTimers"), Subjects.Num(), BatchSize,
+			[&](int32 Index)
+			{
+				const FSubjectHandle& Subject = Subjects[Index];
+
+				if (Subject.IsValid())
+				{
+					Function(Subject);
+				}
+			}, ThreadsCount <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+}
+
+void FBattleFrameCrowdCompletionTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (IsValid(Target))
+	{
+		Target->CompleteCrowdFrame();
+	}
+}
+
+FString FBattleFrameCrowdCompletionTickFunction::DiagnosticMessage()
+{
+	return TEXT("FBattleFrameCrowdCompletionTickFunction");
+}
+
 void ABattleFrameGameMode::BeginPlay()
 {
 	Super::BeginPlay();
@@ -77,6 +259,13 @@ void ABattleFrameGameMode::BeginPlay()
 	Instance = this;
 	CurrentWorld = GetWorld();
 	Mechanism = GetMechanism();
+	SimulationTime = 0.0;
+	SimulationFrame = 0;
+	TimerWheel.Reset(SimulationTime);
+	Telemetry.Reset(bRecordTelemetry ? TelemetryCapacity : 0);
+	TextRing.Reset(TextRingCapacity);
+	FBattleFrameStageTuner::Get().Reset();
+	FBattleFrameStageTuner::Get().SetPresets(StageTuningPresets);
 	if (ANeighborGridActor::GetInstance()) { NeighborGrid = ANeighborGridActor::GetInstance()->GetComponent(); }
 	if (bIsGameOver || !CurrentWorld || !Mechanism || !NeighborGrid) return;
 }
@@ -87,14 +276,243 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 	Super::Tick(DeltaTime);
 
+	// 上一帧的异步模拟正常已在完成阶段结束，这里兜底
+	CompleteCrowdFrame();
+
+	// 编辑器中修改过的曲线在两帧之间重新烘焙
+	FBattleFrameCurveRegistry::Get().RebakeInvalidated();
+
 	if (bIsGameOver || !CurrentWorld || !Mechanism || !NeighborGrid) return;
 
-	//----------------------出生逻辑-------------------------
+	FBattleFrameStatsCollector& Collector = FBattleFrameStatsCollector::Get();
+	Collector.MaxHistoryFrames = StageStatsHistoryFrames;
+
+	FBattleFrameStageTuner& Tuner = FBattleFrameStageTuner::Get();
+	Tuner.bEnabled = bAutoTuneStages;
+	Tuner.MinParallelWorkUs = AutoTuneMinParallelWorkUs;
+	Tuner.MinBatchWorkUs = AutoTuneMinBatchWorkUs;
+	Tuner.MinSamples = FMath::Max(AutoTuneMinSamples, 1);
+	Tuner.ReprobeInterval = FMath::Max(AutoTuneReprobeInterval, 1);
+
+	if (bAsyncSimulation)
+	{
+		// 统计帧在完成阶段关闭，总耗时为墙钟时间
+		Collector.bEnabled = bRecordStageStats;
+
+		if (bRecordStageStats)
+		{
+			Collector.BeginFrame(GFrameCounter);
+		}
+
+		GatherCrowdInputs();
+
+		bCrowdFramePending = true;
+		SimulationTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, DeltaTime]()
+			{
+				SimulateCrowd(DeltaTime);
+				WriteCrowdSnapshot();
+			});
+	}
+	else
+	{
+		FBattleFrameFrameScope FrameScope(GFrameCounter, bRecordStageStats);
+
+		GatherCrowdInputs();
+		SimulateCrowd(DeltaTime);
+		WriteCrowdSnapshot();
+		PresentCrowd();
+		FrontSnapshot ^= 1;
+	}
+}
+
+void ABattleFrameGameMode::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		if (CrowdCompletionTick.bCanEverTick)
+		{
+			CrowdCompletionTick.Target = this;
+			CrowdCompletionTick.TickGroup = AsyncCompletionTickGroup;
+			CrowdCompletionTick.SetTickFunctionEnable(true);
+			CrowdCompletionTick.RegisterTickFunction(GetLevel());
+			CrowdCompletionTick.AddPrerequisite(this, PrimaryActorTick);
+		}
+	}
+	else if (CrowdCompletionTick.IsTickFunctionRegistered())
+	{
+		CrowdCompletionTick.UnRegisterTickFunction();
+	}
+}
+
+void ABattleFrameGameMode::WaitForCrowdSimulation()
+{
+	// 模拟内部（包括被收回到游戏线程执行时）不能等待自己
+	if (!IsInGameThread() || bCrowdSimulationThread || !SimulationTask.IsValid()) return;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("WaitForCrowdSimulation");
+
+	SimulationTask.Wait();
+	SimulationTask = UE::Tasks::FTask();
+}
+
+void ABattleFrameGameMode::CompleteCrowdFrame()
+{
+	if (!bCrowdFramePending) return;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("CompleteCrowdFrame");
+
+	WaitForCrowdSimulation();
+	bCrowdFramePending = false;
+
+	if (Mechanism && CurrentWorld)
+	{
+		PresentCrowd();
+	}
+
+	FrontSnapshot ^= 1;
+	FBattleFrameStatsCollector::Get().EndFrame();
+}
+
+TArray<FBattleFrameAgentSnapshot> ABattleFrameGameMode::QuerySnapshotAgentsInSphere(FVector Origin, float Radius) const
+{
+	TArray<FBattleFrameAgentSnapshot> Results;
+	const float RadiusSquared = FMath::Square(Radius);
+
+	for (const FBattleFrameAgentSnapshot& Agent : GetCrowdSnapshot().Agents)
+	{
+		if (FVector::DistSquared(Agent.Location, Origin) <= RadiusSquared)
+		{
+			Results.Add(Agent);
+		}
+	}
+
+	return Results;
+}
+
+FBattleFrameTelemetryAggregate ABattleFrameGameMode::GetTelemetryAggregate(float Window)
+{
+	WaitForCrowdSimulation();
+	return Telemetry.Aggregate(Window > 0.f ? SimulationTime - Window : TNumericLimits<double>::Lowest());
+}
+
+bool ABattleFrameGameMode::ExportTelemetryToCSV(const FString& FilePath)
+{
+	WaitForCrowdSimulation();
+	return Telemetry.ExportToCSV(FilePath);
+}
+
+void ABattleFrameGameMode::ResetTelemetry()
+{
+	WaitForCrowdSimulation();
+	Telemetry.Reset(bRecordTelemetry ? TelemetryCapacity : 0);
+}
+
+void ABattleFrameGameMode::GatherCrowdInputs()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("GatherCrowdInputs");
+
+	CrowdInputs = FCrowdInputs();
+	CrowdInputs.GameTime = GetGameTimeSinceCreation();
+
+	// 自定义目标
+	NewCustomTargetPaths.ConsumeTo(MergedCustomTargetPaths);
+	CustomTargetPaths.Append(MergedCustomTargetPaths);
+	MergedCustomTargetPaths.Reset();
+
+	for (const FSoftObjectPath& Path : CustomTargetPaths)
+	{
+		AActor* CustomTarget = TSoftObjectPtr<AActor>(Path).LoadSynchronous();
+
+		if (!IsValid(CustomTarget)) continue;
+
+		USubjectiveActorComponent* SubjectiveComponent = CustomTarget->FindComponentByClass<USubjectiveActorComponent>();
+
+		if (!IsValid(SubjectiveComponent)) continue;
+
+		const FSubjectHandle Handle = SubjectiveComponent->GetHandle();
+
+		if (Handle.IsValid() && Handle.HasTrait<FLocated>() && Handle.HasTrait<FHealth>() && !Handle.HasTrait<FDying>())
+		{
+			CrowdInputs.CustomTargets.Add(Path, { Handle, CustomTarget->GetActorLocation() });
+		}
+	}
+
+	// 流场，软引用与直接设置的指针都从这里查位置
+	for (TActorIterator<AFlowField> It(CurrentWorld); It; ++It)
+	{
+		AFlowField* FlowField = *It;
+
+		if (!IsValid(FlowField)) continue;
+
+		CrowdInputs.FlowFieldsByPath.Add(FSoftObjectPath(FlowField), FlowField);
+		CrowdInputs.FlowFieldLocations.Add(FlowField, FlowField->GetActorLocation());
+	}
+
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(CurrentWorld, 0);
+
+	if (IsValid(PlayerPawn))
+	{
+		USubjectiveActorComponent* SubjectiveComponent = PlayerPawn->FindComponentByClass<USubjectiveActorComponent>();
+
+		if (IsValid(SubjectiveComponent))
+		{
+			const FSubjectHandle PlayerHandle = SubjectiveComponent->GetHandle();
+
+			if (PlayerHandle.IsValid())
+			{
+				if (PlayerHandle.HasTrait<FLocated>() && PlayerHandle.HasTrait<FHealth>() && !PlayerHandle.HasTrait<FDying>())
+				{
+					CrowdInputs.PlayerHandle = PlayerHandle;
+					CrowdInputs.PlayerLocation = PlayerPawn->GetActorLocation();
+					CrowdInputs.bPlayerIsValid = true;
+				}
+			}
+		}
+	}
+
+	// 主视角，没有相机时不剔除，也不使用动画 LOD
+	if (bCullInvisibleAgents || bAnimationLOD || bBudgetFx)
+	{
+		APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(CurrentWorld, 0);
+
+		if (IsValid(CameraManager))
+		{
+			CrowdInputs.bViewIsValid = true;
+			CrowdInputs.ViewLocation = CameraManager->GetCameraLocation();
+		}
+
+		if ((bCullInvisibleAgents || bBudgetFx) && IsValid(CameraManager))
+		{
+			float AspectRatio = 16.f / 9.f;
+
+			if (GEngine && GEngine->GameViewport)
+			{
+				FVector2D ViewportSize;
+				GEngine->GameViewport->GetViewportSize(ViewportSize);
+
+				if (ViewportSize.Y > 0)
+				{
+					AspectRatio = ViewportSize.X / ViewportSize.Y;
+				}
+			}
+
+			CrowdInputs.CullingView = FBattleFrameCullingView::MakePerspective(
+				CameraManager->GetCameraLocation(),
+				CameraManager->GetCameraRotation(),
+				CameraManager->GetFOVAngle(),
+				AspectRatio,
+				CullingDistance,
+				CullingMargin);
+		}
+	}
 
-	// 统计Agent数量
+	// 统计Agent数量，给蓝图读取，放在游戏线程
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("CountAgent");
+		FBattleFrameStageScope StageScope(TEXT("CountAgent"));
 		if (bGenerateSubjectQuantity)
 		{
 			{
@@ -102,7 +520,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 				FFilter Filter = FFilter::Make<FAgent>();
 				auto Chain = Mechanism->EnchainSolid(Filter);
-				UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+				StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 				Chain->OperateConcurrently(
 					[&](FAgent& Agent)
@@ -118,7 +536,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 				FFilter Filter = FFilter::Make<FAgent, FAppearing>();
 				auto Chain = Mechanism->EnchainSolid(Filter);
-				UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+				StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 				Chain->OperateConcurrently(
 					[&](FAgent& Agent)
@@ -134,7 +552,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 				FFilter Filter = FFilter::Make<FAgent, FAttacking>();
 				auto Chain = Mechanism->EnchainSolid(Filter);
-				UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+				StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 				Chain->OperateConcurrently(
 					[&](FAgent& Agent)
@@ -150,7 +568,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 				FFilter Filter = FFilter::Make<FAgent, FBeingHit>();
 				auto Chain = Mechanism->EnchainSolid(Filter);
-				UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+				StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 				Chain->OperateConcurrently(
 					[&](FAgent& Agent)
@@ -166,7 +584,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 				FFilter Filter = FFilter::Make<FAgent, FDying>();
 				auto Chain = Mechanism->EnchainSolid(Filter);
-				UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+				StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 				Chain->OperateConcurrently(
 					[&](FAgent& Agent)
@@ -180,13 +598,34 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 		}
 	}
 	#pragma endregion
+}
+
+void ABattleFrameGameMode::SimulateCrowd(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("SimulateCrowd");
+
+	TGuardValue<bool> SimulationThreadGuard(bCrowdSimulationThread, true);
+
+	// 推进计时轮，到期事件由各阶段取走
+	SimulationTime += DeltaTime;
+	SimulationFrame++;
+	TimerWheel.Advance(SimulationTime);
+	HitIndices.Reset();
+
+	// 预烘焙的曲线，只读
+	const FBattleFrameCurveRegistry& CurveRegistry = FBattleFrameCurveRegistry::Get();
+
+	//----------------------出生逻辑-------------------------
 
 	// 统计游戏时长
 	#pragma region
 	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentStatistics");
+		FBattleFrameStageScope StageScope(TEXT("AgentStatistics"));
+
 		FFilter Filter = FFilter::Make<FStatistics>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FStatistics& Stats)
@@ -202,119 +641,65 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 	//----------------------出生逻辑-------------------------
 
-	// 出生总
+	// 安排新个体的计时
 	#pragma region
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAppearMain");
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentScheduleTimers");
+		FBattleFrameStageScope StageScope(TEXT("AgentScheduleTimers"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FLocated, FDirected, FAppear, FAppearing, FSpawnActor, FFX, FSound>();
+		// 不论由哪里生成，个体第一次出现时安排出生与索敌的计时，之后只遍历新个体
+		FFilter Filter = FFilter::Make<FAgent, FLocated>().Exclude<FTimersScheduled, FDying>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
-				FLocated& Located,
-				FDirected& Directed,
-				FAppear& Appear,
-				FAppearing& Appearing,
-				FAnimation& Animation,
-				FSpawnActor& SpawnActor,
-				FFX& FX,
-				FSound& Sound)
-				{
-					// Initial execute
-					if (Appearing.time == 0)
-					{
-						// Spawn Decal Actor
-						if (Appear.bCanSpawnDecal && SpawnActor.AppearDecalClass)
-						{
-							FSpawningActor AppearSpawning;
-							AppearSpawning.SpawnClass = SpawnActor.AppearDecalClass;
-							AppearSpawning.Trans = FTransform(FRotator::ZeroRotator, FLocated{ Located }, FVector::OneVector);
-
-							FSubjectRecord Record;
-							Record.SetTrait(AppearSpawning);
-
-							Mechanism->SpawnSubjectDeferred(Record);
-						}
-					}
-					else if (Appearing.time <= Appear.Delay)
-					{
-						// Wait
-					}
-					else if (Appearing.time > Appear.Delay && Appearing.time <= (Appear.Duration + Appear.Delay))
-					{
-						if (!Appear.bAppearStarted)
-						{
-							Appear.bAppearStarted = true;
-
-							// Dissolve In
-							if (Appear.bCanDissolveIn)
-							{
-								Subject.SetTraitDeferred(FAppearDissolve{});
-							}
+				const FLocated& Located)
+			{
+				const FSubjectHandle Handle{ Subject };
+				double FirstTraceDelay = 0.0;
 
-							// Animation
-							if (Appear.bCanPlayAnim)
-							{
-								Subject.SetTraitDeferred(FAppearAnim{});
-							}
+				FAppearing* Appearing = Subject.GetTraitPtr<FAppearing, EParadigm::Unsafe>();
+				const FAppear* Appear = Subject.GetTraitPtr<FAppear, EParadigm::Unsafe>();
 
-							// Fx
-							if (Appear.bCanSpawnFx && FX.AppearFx.SubType != ESubType::None)
-							{
-								FRotator CombinedRotator = (FQuat(FX.AppearFx.Transform.GetRotation()) * FQuat(Directed.Direction.Rotation())).Rotator();
-								QueueFx(FSubjectHandle{ Subject }, FTransform(CombinedRotator, FX.AppearFx.Transform.GetLocation(), FX.AppearFx.Transform.GetScale3D()), FX.AppearFx.SubType);
-							}
+				if (Appearing && Appear)
+				{
+					FirstTraceDelay = Appear->Delay + Appear->Duration;
+					Appearing->EndTime = SimulationTime + FirstTraceDelay;
 
-							// Sound
-							if (Appear.bCanPlaySound && Sound.AppearSound)
-							{
-								float Probability = Sound.bUseProbability ? RangeMapProbability(AppearingAgentCount, Sound.AppearSoundProbability) : 100.1;
-								QueueSound(Sound.AppearSound, Probability);
-							}
+					// 出生贴花
+					const FSpawnActor* SpawnActor = Subject.GetTraitPtr<FSpawnActor, EParadigm::Unsafe>();
 
-							// Scale In(WIP)
-						}
-					}
-					else
+					if (Appear->bCanSpawnDecal && SpawnActor && SpawnActor->AppearDecalClass)
 					{
-						Subject.RemoveTraitDeferred<FAppearing>();                                                        
-					}
-
-					Appearing.time += DeltaTime;
-
-				}, ThreadsCount, BatchSize);
-
-		Mechanism->ApplyDeferreds();
-	}
-	#pragma endregion
+						FSpawningActor AppearSpawning;
+						AppearSpawning.SpawnClass = SpawnActor->AppearDecalClass;
+						AppearSpawning.Trans = FTransform(FRotator::ZeroRotator, Located.Location, FVector::OneVector);
 
-	// 出生动画
-	#pragma region
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAppearAnim");
+						FSubjectRecord Record;
+						Record.SetTrait(AppearSpawning);
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FAnimation, FAppear, FAppearAnim>();
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+						Mechanism->SpawnSubjectDeferred(Record);
+						StageScope.AddDeferred();
+					}
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FAnimation& Animation,
-				FAppear& Appear,
-				FAppearAnim& AppearAnim)
-			{
-				if (AppearAnim.animTime == 0)
+					ScheduleTimer(Handle, EBattleFrameTimer::AppearStart, Appear->Delay);
+					ScheduleTimer(Handle, EBattleFrameTimer::AppearEnd, FirstTraceDelay);
+				}
+				else if (Appearing)
 				{
-					// 状态机
-					Animation.SubjectState = ESubjectState::Appearing;
+					// 没有出生配置时立即结束出生
+					ScheduleTimer(Handle, EBattleFrameTimer::AppearEnd, 0.0);
 				}
-				else if (AppearAnim.animTime >= Appear.Duration)
+
+				if (FTracing* Tracing = Subject.GetTraitPtr<FTracing, EParadigm::Unsafe>())
 				{
-					Subject.RemoveTraitDeferred<FAppearAnim>();
+					Tracing->NextTraceTime = SimulationTime + FirstTraceDelay;
+					ScheduleTimer(Handle, EBattleFrameTimer::Trace, FirstTraceDelay);
 				}
-				AppearAnim.animTime += DeltaTime;
+
+				Subject.SetTraitDeferred(FTimersScheduled{});
+				StageScope.AddDeferred();
 
 			}, ThreadsCount, BatchSize);
 
@@ -322,112 +707,178 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	}
 	#pragma endregion
 
-	// 出生淡入
+	// 出生总
 	#pragma region
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAppearDissolve");
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAppearMain");
+		FBattleFrameStageScope StageScope(TEXT("AgentAppearMain"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FAppearDissolve, FAnimation,FCurves>();
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		// 出生延迟结束，开始淡入、动画、特效与音效
+		const TArray<FSubjectHandle> AppearStarts = TimerWheel.Consume(EBattleFrameTimer::AppearStart);
+		StageScope.CalculateThreadsCountAndBatchSize(AppearStarts.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FAnimation& Animation,
-				FAppearDissolve& AppearDissolve,
-				FCurves& Curves)
+		OperateTimersConcurrently(AppearStarts, ThreadsCount, BatchSize,
+			[&](FSubjectHandle Subject)
 			{
-				const auto Curve = Curves.DissolveIn.GetRichCurve();
-				const auto EndTime = Curve->GetLastKey().Time;
-				Animation.Dissolve = 1 - Curve->Eval(FMath::Clamp(AppearDissolve.dissolveTime, 0, EndTime));
+				FAppear* Appear = Subject.GetTraitPtr<FAppear, EParadigm::Unsafe>();
+
+				if (!Appear || Appear->bAppearStarted || !Subject.HasTrait<FAppearing>()) return;
 
-				if (AppearDissolve.dissolveTime > EndTime)
+				Appear->bAppearStarted = true;
+
+				// Dissolve In
+				if (Appear->bCanDissolveIn)
 				{
-					Subject.RemoveTraitDeferred<FAppearDissolve>();
+					Subject.SetTraitDeferred(FAppearDissolve{});
+					StageScope.AddDeferred();
 				}
 
-				AppearDissolve.dissolveTime += DeltaTime;
-
-			}, ThreadsCount, BatchSize);
+				// Animation
+				if (Appear->bCanPlayAnim)
+				{
+					if (FAnimation* Animation = Subject.GetTraitPtr<FAnimation, EParadigm::Unsafe>())
+					{
+						Animation->SubjectState = ESubjectState::Appearing;// 状态机
+					}
+
+					Subject.SetTraitDeferred(FAppearAnim{ SimulationTime + Appear->Duration });
+					StageScope.AddDeferred();
+					ScheduleTimer(Subject, EBattleFrameTimer::AppearAnimEnd, Appear->Duration);
+				}
+
+				// Fx
+				const FFX* FX = Subject.GetTraitPtr<FFX, EParadigm::Unsafe>();
+				const FDirected* Directed = Subject.GetTraitPtr<FDirected, EParadigm::Unsafe>();
+
+				if (Appear->bCanSpawnFx && FX && Directed && FX->AppearFx.SubType != ESubType::None)
+				{
+					FRotator CombinedRotator = (FQuat(FX->AppearFx.Transform.GetRotation()) * FQuat(Directed->Direction.Rotation())).Rotator();
+					if (QueueFx(Subject, FTransform(CombinedRotator, FX->AppearFx.Transform.GetLocation(), FX->AppearFx.Transform.GetScale3D()), FX->AppearFx.SubType, EBattleFrameFxCategory::Appear))
+					{
+						StageScope.AddDeferred();
+					}
+				}
+
+				// Sound
+				const FSound* Sound = Subject.GetTraitPtr<FSound, EParadigm::Unsafe>();
+
+				if (Appear->bCanPlaySound && Sound && Sound->AppearSound)
+				{
+					float Probability = Sound->bUseProbability ? RangeMapProbability(AppearingAgentCount, Sound->AppearSoundProbability) : 100.1;
+					QueueSound(Sound->AppearSound, Probability, Subject);
+				}
+
+				// Scale In(WIP)
+			});
+
+		// 出生结束
+		const TArray<FSubjectHandle> AppearEnds = TimerWheel.Consume(EBattleFrameTimer::AppearEnd);
+
+		for (FSubjectHandle Subject : AppearEnds)
+		{
+			if (Subject.IsValid() && Subject.HasTrait<FAppearing>())
+			{
+				Subject.RemoveTraitDeferred<FAppearing>();
+				StageScope.AddDeferred();
+			}
+		}
+
+		// 出生动画结束
+		const TArray<FSubjectHandle> AppearAnimEnds = TimerWheel.Consume(EBattleFrameTimer::AppearAnimEnd);
+
+		for (FSubjectHandle Subject : AppearAnimEnds)
+		{
+			if (Subject.IsValid() && Subject.HasTrait<FAppearAnim>())
+			{
+				Subject.RemoveTraitDeferred<FAppearAnim>();
+				StageScope.AddDeferred();
+			}
+		}
+
+		StageScope.Track(AppearEnds.Num() + AppearAnimEnds.Num(), 1, 1);
 
 		Mechanism->ApplyDeferreds();
 	}
 	#pragma endregion
 
-	//----------------------攻击逻辑-------------------------
-
-	// 是否索敌
+	// 出生淡入
 	#pragma region
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentTrace");
-
-		FFilter Filter = FFilter::Make<FAgent, FTrace, FTracing>();
-		Filter.Exclude<FAppearing, FDying, FAttacking>();
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAppearDissolve");
+		FBattleFrameStageScope StageScope(TEXT("AgentAppearDissolve"));
 
+		FFilter Filter = FFilter::Make<FAgent, FRendering, FAppearDissolve, FAnimation>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
-				FLocated& Located,
-				FTrace& Trace,
-				FTracing& Tracing)
+				FAnimation& Animation,
+				FAppearDissolve& AppearDissolve)
 			{
-				Tracing.TimeLeft -= DeltaTime;
+				// 没有烘焙曲线的个体使用默认曲线
+				const FBakedCurves* BakedCurves = Subject.GetTraitPtr<FBakedCurves, EParadigm::Unsafe>();
+				const FBakedCurve& Curve = CurveRegistry.GetSet(BakedCurves ? BakedCurves->Index : INDEX_NONE).DissolveIn;
+				Animation.Dissolve = 1 - Curve.Eval(AppearDissolve.dissolveTime);
 
-				if (Tracing.TimeLeft <= 0)
+				if (AppearDissolve.dissolveTime > Curve.EndTime)
 				{
-					Tracing.bShouldTrace = true;
-					Tracing.TimeLeft = Trace.CoolDown;
+					Subject.RemoveTraitDeferred<FAppearDissolve>();
+					StageScope.AddDeferred();
 				}
 
+				AppearDissolve.dissolveTime += DeltaTime;
+
 			}, ThreadsCount, BatchSize);
+
+		Mechanism->ApplyDeferreds();
 	}
 	#pragma endregion
 
+	//----------------------攻击逻辑-------------------------
+
 	// 执行索敌
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentTracing");
+		FBattleFrameStageScope StageScope(TEXT("AgentTracing"));
 
-		bool bPlayerIsValid = false;
-		FVector PlayerLocation;
-		FSubjectHandle PlayerHandle;
-		APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(CurrentWorld, 0);
+		// 玩家信息在游戏线程收集
+		const bool bPlayerIsValid = CrowdInputs.bPlayerIsValid;
+		const FVector PlayerLocation = CrowdInputs.PlayerLocation;
+		const FSubjectHandle PlayerHandle = CrowdInputs.PlayerHandle;
 
-		if (IsValid(PlayerPawn))
-		{
-			USubjectiveActorComponent* SubjectiveComponent = PlayerPawn->FindComponentByClass<USubjectiveActorComponent>();
+		// 只处理冷却结束的个体
+		const TArray<FSubjectHandle> Tracers = TimerWheel.Consume(EBattleFrameTimer::Trace);
+		StageScope.CalculateThreadsCountAndBatchSize(Tracers.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-			if (IsValid(SubjectiveComponent))
+		OperateTimersConcurrently(Tracers, ThreadsCount, BatchSize,
+			[&](FSubjectHandle Subject)
 			{
-				PlayerHandle = SubjectiveComponent->GetHandle();
+				FTracing* TracingPtr = Subject.GetTraitPtr<FTracing, EParadigm::Unsafe>();
+				FTrace* TracePtr = Subject.GetTraitPtr<FTrace, EParadigm::Unsafe>();
+				FLocated* LocatedPtr = Subject.GetTraitPtr<FLocated, EParadigm::Unsafe>();
+				FCollider* ColliderPtr = Subject.GetTraitPtr<FCollider, EParadigm::Unsafe>();
+
+				if (!TracingPtr || !TracePtr || !LocatedPtr || !ColliderPtr || Subject.HasTrait<FDying>()) return;
+
+				FTracing& Tracing = *TracingPtr;
+				FTrace& Trace = *TracePtr;
+				FLocated& Located = *LocatedPtr;
+				FCollider& Collider = *ColliderPtr;
 
-				if (PlayerHandle.IsValid())
+				// 安排下一次索敌，出生中的等出生结束，攻击中的跳过本轮
+				double Delay = FMath::Max<double>(Trace.CoolDown, TimerWheel.GetResolution());
+
+				if (const FAppearing* Appearing = Subject.GetTraitPtr<FAppearing, EParadigm::Unsafe>())
 				{
-					if (PlayerHandle.HasTrait<FLocated>() && PlayerHandle.HasTrait<FHealth>() && !PlayerHandle.HasTrait<FDying>())
-					{
-						PlayerLocation = PlayerPawn->GetActorLocation();
-						bPlayerIsValid = true;
-					}
+					Delay = FMath::Max(Appearing->EndTime - SimulationTime, TimerWheel.GetResolution());
 				}
-			}
-		}
-
-		FFilter Filter = FFilter::Make<FAgent, FLocated, FCollider, FTrace, FTracing>();
-		Filter.Exclude<FAppearing, FDying, FAttacking>();
 
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+				Tracing.NextTraceTime = SimulationTime + Delay;
+				ScheduleTimer(Subject, EBattleFrameTimer::Trace, Delay);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FLocated& Located,
-				FTrace& Trace,
-				FTracing& Tracing,
-				FCollider& Collider)
-			{
-				if (!Tracing.bShouldTrace) return;
+				if (Subject.HasTrait<FAppearing>() || Subject.HasTrait<FAttacking>()) return;
 
 				switch (Trace.Mode)
 				{
@@ -453,35 +904,26 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 					{
 						Trace.TraceResult = FSubjectHandle{};
 
-						AActor* CustomTarget = Trace.CustomTarget.LoadSynchronous();//WIP
+						if (Trace.CustomTarget.IsNull()) break;
 
-						if (IsValid(CustomTarget))
+						// 目标在游戏线程解析，第一次引用的目标从下一帧开始生效
+						const FSoftObjectPath CustomTargetPath = Trace.CustomTarget.ToSoftObjectPath();
+
+						if (const FCrowdTarget* CustomTarget = CrowdInputs.CustomTargets.Find(CustomTargetPath))
 						{
-							USubjectiveActorComponent* SubjectiveComponent = CustomTarget->FindComponentByClass<USubjectiveActorComponent>();
+							// Calculate the distance between Location.Location and CustomTargetLocation
+							float Distance = FVector::Dist(Located.Location, CustomTarget->Location);
 
-							if (IsValid(SubjectiveComponent))
+							// Check if the distance is within Trace.Range
+							if (Distance <= Trace.Range)
 							{
-								FSubjectHandle SubjectHandle = SubjectiveComponent->GetHandle();
-
-								if (SubjectHandle.IsValid())
-								{
-									if (SubjectHandle.HasTrait<FLocated>() && SubjectHandle.HasTrait<FHealth>() && !SubjectHandle.HasTrait<FDying>())
-									{
-										// Get the location of the custom target
-										FVector CustomTargetLocation = CustomTarget->GetActorLocation();
-
-										// Calculate the distance between Location.Location and CustomTargetLocation
-										float Distance = FVector::Dist(Located.Location, CustomTargetLocation);
-
-										// Check if the distance is within Trace.Range
-										if (Distance <= Trace.Range)
-										{
-											Trace.TraceResult = SubjectHandle;
-										}
-									}
-								}
+								Trace.TraceResult = CustomTarget->Handle;
 							}
 						}
+						else if (!CustomTargetPaths.Contains(CustomTargetPath))
+						{
+							NewCustomTargetPaths.Add(CustomTargetPath);
+						}
 
 						break;
 					}
@@ -511,7 +953,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						break;
 					}
 				}
-			}, ThreadsCount, BatchSize);
+			});
 	}
 	#pragma endregion
 
@@ -519,12 +961,13 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region 
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAttackMain");
+		FBattleFrameStageScope StageScope(TEXT("AgentAttackMain"));
 
 		FFilter Filter = FFilter::Make<FAgent, FAttack, FRendering, FLocated, FDirected, FTrace>();
 		Filter.Exclude<FAppearing, FDying, FAttacking>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
@@ -563,6 +1006,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						if (DistToTarget <= Attack.Range && DistToTarget <= Trace.Range && DeltaYaw <= AllowedYaw && targetHealth > 0)
 						{
 							Subject.SetTraitDeferred(FAttacking{ 0.f, EAttackState::PreCast });
+							StageScope.AddDeferred();
 						}
 					}
 				}
@@ -576,12 +1020,13 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentAttacking");
+		FBattleFrameStageScope StageScope(TEXT("AgentAttacking"));
 
 		FFilter Filter = FFilter::Make<FAgent, FAttack, FRendering, FLocated, FAnimation, FAttacking, FMove, FMoving, FDirected, FSound, FFX, FTrace, FDebuff, FDamage, FSpawnActor>();
 		Filter.Exclude<FAppearing, FDying>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
@@ -608,25 +1053,30 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 					if (Attack.bCanSpawnFx && FX.AttackFx.SubType != ESubType::None)
 					{
 						FRotator CombinedRotator = (FQuat(FX.AttackFx.Transform.GetRotation().Rotator()) * FQuat(Directed.Direction.Rotation())).Rotator();
-						QueueFx(FSubjectHandle{ Subject }, FTransform(CombinedRotator, FX.AttackFx.Transform.GetLocation(), FX.AttackFx.Transform.GetScale3D()), FX.AttackFx.SubType);
+						if (QueueFx(FSubjectHandle{ Subject }, FTransform(CombinedRotator, FX.AttackFx.Transform.GetLocation(), FX.AttackFx.Transform.GetScale3D()), FX.AttackFx.SubType, EBattleFrameFxCategory::Attack, Trace.TraceResult))
+						{
+							StageScope.AddDeferred();
+						}
 					}
 
 					// Sound
 					if (Attack.bCanPlaySound && Sound.AttackSound)
 					{
 						float Probability = Sound.bUseProbability ? RangeMapProbability(AttackingAgentCount, Sound.AttackSoundProbability) : 100.1;
-						QueueSound(Sound.AttackSound, Probability);
+						QueueSound(Sound.AttackSound, Probability, FSubjectHandle{ Subject });
 					}
 
 					// Deal Damage
 					if (Trace.TraceResult.IsValid() && !Trace.TraceResult.HasTrait<FDying>())
 					{
 						FDmgSphere DmgSphere = { Damage.Damage,Damage.KineticDmg,Damage.FireDmg,Damage.IceDmg,Damage.PercentDmg,Damage.CritProbability,Damage.CritMult };
-						ApplyDamageToSubjects(TArray<FSubjectHandle>{Trace.TraceResult}, TArray<FSubjectHandle>{}, FSubjectHandle{}, Located.Location, DmgSphere, Debuff);
+						QueueDamagePair({ FSubjectHandle{}, Trace.TraceResult, Located.Location, DmgSphere, Debuff });
 					}
 
 					// Die
+					ReleaseRenderInstance(Subject);
 					Subject.DespawnDeferred();
+					StageScope.AddDeferred();
 					//Subject.SetTraitDeferred(FDying{ 0,0,FSubjectHandle{} });
 				}
 				else
@@ -654,6 +1104,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 							DangerWarningRecord.SetTrait(DangerWarningToSpawn);
 
 							Mechanism->SpawnSubjectDeferred(DangerWarningRecord);
+							StageScope.AddDeferred();
 						}
 					}
 
@@ -668,14 +1119,17 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 							if (Attack.bCanSpawnFx && FX.AttackFx.SubType != ESubType::None)
 							{
 								FRotator CombinedRotator = (FQuat(FX.AttackFx.Transform.GetRotation()) * FQuat(Directed.Direction.Rotation())).Rotator();
-								QueueFx(FSubjectHandle{ Subject }, FTransform(CombinedRotator, FX.AttackFx.Transform.GetLocation(), FX.AttackFx.Transform.GetScale3D()), FX.AttackFx.SubType);
+								if (QueueFx(FSubjectHandle{ Subject }, FTransform(CombinedRotator, FX.AttackFx.Transform.GetLocation(), FX.AttackFx.Transform.GetScale3D()), FX.AttackFx.SubType, EBattleFrameFxCategory::Attack, Trace.TraceResult))
+								{
+									StageScope.AddDeferred();
+								}
 							}
 
 							// 音效
 							if (Attack.bCanPlaySound && Sound.AttackSound)
 							{
 								float Probability = Sound.bUseProbability ? RangeMapProbability(AttackingAgentCount, Sound.AttackSoundProbability) : 100.1;
-								QueueSound(Sound.AttackSound, Probability);
+								QueueSound(Sound.AttackSound, Probability, FSubjectHandle{ Subject });
 							}
 
 							// 近战需要满足距离和角度条件才能造成伤害
@@ -697,7 +1151,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 								if (Distance <= Attack.Range && Angle <= Attack.MeleeAngle)
 								{
 									FDmgSphere DmgSphere = { Damage.Damage,Damage.KineticDmg,Damage.FireDmg,Damage.IceDmg,Damage.PercentDmg,Damage.CritProbability,Damage.CritMult };
-									ApplyDamageToSubjects(TArray<FSubjectHandle>{Trace.TraceResult}, TArray<FSubjectHandle>{}, FSubjectHandle{ Subject }, Located.Location, DmgSphere, Debuff);
+									QueueDamagePair({ FSubjectHandle{ Subject }, Trace.TraceResult, Located.Location, DmgSphere, Debuff });
 								}
 							}
 
@@ -718,6 +1172,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 								ProjectileRecord.SetTrait(ProjectileToSpawn);
 
 								Mechanism->SpawnSubjectDeferred(ProjectileRecord);
+								StageScope.AddDeferred();
 							}
 						}
 					}
@@ -733,6 +1188,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 					else if (Attacking.Time >= Attack.DurationPerRound + Attack.CoolDown)
 					{
 						Subject.RemoveTraitDeferred<FAttacking>();// 移除攻击状态
+						StageScope.AddDeferred();
 						Moving.KnockBackForce = FVector::ZeroVector; // 击退力清零
 					}
 
@@ -740,6 +1196,9 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				}
 			}, ThreadsCount, BatchSize);
 
+		// 本阶段的近战与自爆伤害一起结算
+		ApplyQueuedDamagePairs();
+
 		Mechanism->ApplyDeferreds();
 	}
 	#pragma endregion
@@ -750,46 +1209,26 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentHitGlow");
+		FBattleFrameStageScope StageScope(TEXT("AgentHitGlow"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FHitGlow, FAnimation, FCurves>();
+		FFilter Filter = FFilter::Make<FAgent, FRendering, FHitGlow, FAnimation>();
 		Filter.Exclude<FAppearing, FBeingHit>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
 				FAnimation& Animation,
-				FHitGlow& HitGlow,
-				FCurves& Curves)
+				FHitGlow& HitGlow)
 			{
-				// 获取曲线
-				auto Curve = Curves.HitEmission.GetRichCurve();
-
-				// 检查曲线是否有关键帧
-				if (Curve->GetNumKeys() == 0)
-				{
-					// 如果没有关键帧，添加默认关键帧
-					Curve->Reset();
-					FKeyHandle Key1 = Curve->AddKey(0.0f, 0.0f);    // 初始值
-					FKeyHandle Key2 = Curve->AddKey(0.1f, 1.0f);   // 峰值
-					FKeyHandle Key3 = Curve->AddKey(0.5f, 0.0f);   // 结束值
-
-					// 设置自动切线
-					Curve->SetKeyInterpMode(Key1, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key2, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key3, RCIM_Cubic);
-
-					Curve->SetKeyTangentMode(Key1, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key2, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key3, RCTM_Auto);
-				}
-
-				// 获取曲线的最后一个关键帧的时间
-				const auto EndTime = Curve->GetLastKey().Time;
+				// 获取曲线，没有烘焙曲线的个体使用默认曲线
+				const FBakedCurves* BakedCurves = Subject.GetTraitPtr<FBakedCurves, EParadigm::Unsafe>();
+				const FBakedCurve& Curve = CurveRegistry.GetSet(BakedCurves ? BakedCurves->Index : INDEX_NONE).HitEmission;
+				const float EndTime = Curve.EndTime;
 
 				// 受击发光
-				Animation.HitGlow = Curve->Eval(HitGlow.glowTime);
+				Animation.HitGlow = Curve.Eval(HitGlow.glowTime);
 
 				// 更新发光时间
 				if (HitGlow.glowTime < EndTime)
@@ -802,6 +1241,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				{
 					Animation.HitGlow = 0; // 重置发光值
 					Subject->RemoveTraitDeferred<FHitGlow>(); // 延迟删除 Trait
+					StageScope.AddDeferred();
 				}
 
 			}, ThreadsCount, BatchSize);
@@ -814,55 +1254,30 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentSqueezeSquash");
+		FBattleFrameStageScope StageScope(TEXT("AgentSqueezeSquash"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FSqueezeSquash, FScaled, FHit, FCurves>();
+		FFilter Filter = FFilter::Make<FAgent, FRendering, FSqueezeSquash, FScaled, FHit>();
 		Filter.Exclude<FAppearing, FBeingHit>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
 				FScaled& Scaled,
 				FSqueezeSquash& SqueezeSquash,
-				FHit& Hit,
-				FCurves& Curves)
+				FHit& Hit)
 			{
-				// 获取曲线
-				auto Curve = Curves.HitSqueezeSquash.GetRichCurve();
-
-				// 检查曲线是否有关键帧
-				if (Curve->GetNumKeys() == 0)
-				{
-					// 如果没有关键帧，添加默认关键帧
-					Curve->Reset();
-					FKeyHandle Key1 = Curve->AddKey(0.0f, 1.0f);    // 初始值
-					FKeyHandle Key2 = Curve->AddKey(0.1f, 1.75f);   // 峰值
-					FKeyHandle Key3 = Curve->AddKey(0.28f, 0.78f);   // 回弹
-					FKeyHandle Key4 = Curve->AddKey(0.4f, 1.12f);   // 二次回弹
-					FKeyHandle Key5 = Curve->AddKey(0.5f, 1.0f);     // 恢复
-
-					// 设置自动切线
-					Curve->SetKeyInterpMode(Key1, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key2, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key3, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key4, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key5, RCIM_Cubic);
-
-					Curve->SetKeyTangentMode(Key1, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key2, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key3, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key4, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key5, RCTM_Auto);
-				}
-
-				// 获取曲线的最后一个关键帧的时间
-				const auto EndTime = Curve->GetLastKey().Time;
+				// 获取曲线，没有烘焙曲线的个体使用默认曲线
+				const FBakedCurves* BakedCurves = Subject.GetTraitPtr<FBakedCurves, EParadigm::Unsafe>();
+				const FBakedCurve& Curve = CurveRegistry.GetSet(BakedCurves ? BakedCurves->Index : INDEX_NONE).HitSqueezeSquash;
+				const float EndTime = Curve.EndTime;
 
 				// 受击变形
-				Scaled.renderFactors.X = FMath::Lerp(Scaled.Factors.X, Scaled.Factors.X * Curve->Eval(SqueezeSquash.squeezeSquashTime), Hit.SqueezeSquashStr);
-				Scaled.renderFactors.Y = FMath::Lerp(Scaled.Factors.Y, Scaled.Factors.Y * Curve->Eval(SqueezeSquash.squeezeSquashTime), Hit.SqueezeSquashStr);
-				Scaled.renderFactors.Z = FMath::Lerp(Scaled.Factors.Z, Scaled.Factors.Z * (2.f - Curve->Eval(SqueezeSquash.squeezeSquashTime)), Hit.SqueezeSquashStr);
+				const float SqueezeSquashValue = Curve.Eval(SqueezeSquash.squeezeSquashTime);
+				Scaled.renderFactors.X = FMath::Lerp(Scaled.Factors.X, Scaled.Factors.X * SqueezeSquashValue, Hit.SqueezeSquashStr);
+				Scaled.renderFactors.Y = FMath::Lerp(Scaled.Factors.Y, Scaled.Factors.Y * SqueezeSquashValue, Hit.SqueezeSquashStr);
+				Scaled.renderFactors.Z = FMath::Lerp(Scaled.Factors.Z, Scaled.Factors.Z * (2.f - SqueezeSquashValue), Hit.SqueezeSquashStr);
 
 				// 更新形变时间
 				if (SqueezeSquash.squeezeSquashTime < EndTime)
@@ -875,6 +1290,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				{
 					Scaled.renderFactors = Scaled.Factors; // 恢复原始比例
 					Subject->RemoveTraitDeferred<FSqueezeSquash>(); // 延迟删除 Trait
+					StageScope.AddDeferred();
 				}
 
 			}, ThreadsCount, BatchSize);
@@ -887,113 +1303,108 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentBurning");
+		FBattleFrameStageScope StageScope(TEXT("AgentBurning"));
 
-		auto Filter = FFilter::Make<FTemporalDamaging>();
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		// 每段灼烧由计时触发，重复的计时以 NextTickTime 为准
+		const TArray<FSubjectHandle> BurnTicks = TimerWheel.Consume(EBattleFrameTimer::Burn);
+		StageScope.CalculateThreadsCountAndBatchSize(BurnTicks.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject, FTemporalDamaging& Temporal)
+		OperateTimersConcurrently(BurnTicks, ThreadsCount, BatchSize,
+			[&](FSubjectHandle Subject)
 			{
-				// 持续伤害结束或玩家退出，终止执行
-				if (Temporal.RemainingTemporalDamage <= 0)
+				FBurning* Burning = Subject.GetTraitPtr<FBurning, EParadigm::Unsafe>();
+
+				if (!Burning) return;
+
+				Burning->Lock();
+
+				if (Burning->StacksNum == 0 || Burning->NextTickTime > SimulationTime + KINDA_SMALL_NUMBER)
+				{
+					Burning->Unlock();
+					return;
+				}
+
+				const FHealth* TargetHealth = Subject.GetTraitPtr<FHealth, EParadigm::Unsafe>();
+				float TickDamage = 0.f;
+
+				// 每层各结算一段，伤害记在各自的施加者名下
+				for (int32 i = Burning->StacksNum - 1; i >= 0; --i)
 				{
-					// 恢复颜色
-					if (Temporal.TemporalDamageTarget.HasTrait<FAnimation>())
+					FBurnStack& Stack = Burning->Stacks[i];
+
+					if (TargetHealth && TargetHealth->Current > 0)
 					{
-						auto& TargetAnimation = Temporal.TemporalDamageTarget.GetTraitRef<FAnimation, EParadigm::Unsafe>();
-						TargetAnimation.BurnFx = 0;
+						const float ClampedDamage = FMath::Min(Stack.DamagePerTick, TargetHealth->Current);
+						QueueDamage(Subject, Stack.Instigator, ClampedDamage, EBattleFrameDamageFlags::Temporal, EBattleFrameDamageType::Fire);
+						TickDamage += ClampedDamage;
 					}
 
-					Subject.DespawnDeferred();
-					return;
+					// 段数用完的层移除
+					if (--Stack.TicksLeft <= 0)
+					{
+						Burning->Stacks[i] = Burning->Stacks[--Burning->StacksNum];
+					}
 				}
 
-				Temporal.TemporalDamageTimeout -= DeltaTime;
+				const bool bStillBurning = Burning->StacksNum > 0;
 
-				// 倒计时，每0.5秒重置，即每秒造成2段灼烧伤害
-				if (Temporal.TemporalDamageTimeout <= 0)
+				if (bStillBurning)
 				{
-					// 扣除目标生命值
-					if (Temporal.TemporalDamageTarget.HasTrait<FHealth>())
-					{
-						auto& TargetHealth = Temporal.TemporalDamageTarget.GetTraitRef<FHealth, EParadigm::Unsafe>();
+					Burning->NextTickTime = SimulationTime + FBurning::TickInterval;
+					ScheduleTimer(Subject, EBattleFrameTimer::Burn, FBurning::TickInterval);
+				}
 
-						if (TargetHealth.Current > 0)
-						{
-							// 实际伤害值
-							float ClampedDamage = FMath::Min(Temporal.TotalTemporalDamage * 0.25f, TargetHealth.Current);
+				Burning->Unlock();
 
-							// 应用伤害
-							TargetHealth.DamageToTake.Enqueue(ClampedDamage);
+				// 生成伤害数字
+				if (TickDamage > 0 && Subject.HasTrait<FTextPopUp>())
+				{
+					const auto& TextPopUp = Subject.GetTraitRef<FTextPopUp, EParadigm::Unsafe>();
 
-							// 记录伤害施加者
-							TargetHealth.DamageInstigator.Enqueue(Temporal.TemporalDamageInstigator);
+					if (TextPopUp.Enable)
+					{
+						float Style;
 
-							// 生成伤害数字
-							if (Temporal.TemporalDamageTarget.HasTrait<FTextPopUp>())
-							{
-								const auto& TextPopUp = Temporal.TemporalDamageTarget.GetTraitRef<FTextPopUp, EParadigm::Unsafe>();
+						if (TickDamage < TextPopUp.WhiteTextBelowPercent)
+						{
+							Style = 0;
+						}
+						else if (TickDamage < TextPopUp.OrangeTextAbovePercent)
+						{
+							Style = 1;
+						}
+						else
+						{
+							Style = 2;
+						}
 
-								if (TextPopUp.Enable)
-								{
-									float Style;
-
-									if (ClampedDamage < TextPopUp.WhiteTextBelowPercent)
-									{
-										Style = 0;
-									}
-									else if (ClampedDamage < TextPopUp.OrangeTextAbovePercent)
-									{
-										Style = 1;
-									}
-									else
-									{
-										Style = 2;
-									}
-
-									float Radius = 0;
-
-									if (Temporal.TemporalDamageTarget.HasTrait<FCollider>())
-									{
-										Radius = Temporal.TemporalDamageTarget.GetTraitRef<FCollider, EParadigm::Unsafe>().Radius;
-									}
-
-									FVector Location = FVector::ZeroVector;
-
-									if (Temporal.TemporalDamageTarget.HasTrait<FLocated>())
-									{
-										Location = Temporal.TemporalDamageTarget.GetTraitRef<FLocated, EParadigm::Unsafe>().Location;
-									}
-
-									Location + FVector(0, 0, Radius);
-
-									QueueText(Temporal.TemporalDamageTarget, ClampedDamage, Style, TextPopUp.TextScale, Radius * 1.1, Location);
-								}
-							}
+						float Radius = 0;
 
-							// 让目标材质变红
-							if (Temporal.TemporalDamageTarget.HasTrait<FAnimation>())
-							{
-								auto& TargetAnimation = Temporal.TemporalDamageTarget.GetTraitRef<FAnimation, EParadigm::Unsafe>();
-								TargetAnimation.Lock();
-								TargetAnimation.BurnFx = 1;
-								TargetAnimation.Unlock();
-							}
+						if (Subject.HasTrait<FCollider>())
+						{
+							Radius = Subject.GetTraitRef<FCollider, EParadigm::Unsafe>().Radius;
 						}
-					}
 
-					// 4段伤害都释放完毕就删除 dummy subject
-					Temporal.RemainingTemporalDamage -= Temporal.TotalTemporalDamage * 0.25f;
+						FVector Location = FVector::ZeroVector;
 
-					if (Temporal.RemainingTemporalDamage > 0.f)
-					{
-						Temporal.TemporalDamageTimeout = 0.5f;
+						if (Subject.HasTrait<FLocated>())
+						{
+							Location = Subject.GetTraitRef<FLocated, EParadigm::Unsafe>().Location;
+						}
+
+						QueueText(Subject, TickDamage, Style, TextPopUp.TextScale, Radius * 1.1, Location);
 					}
 				}
-			}, ThreadsCount, BatchSize);
 
-			Mechanism->ApplyDeferreds();
+				// 燃烧中材质变红，结束后恢复颜色
+				if (Subject.HasTrait<FAnimation>())
+				{
+					auto& TargetAnimation = Subject.GetTraitRef<FAnimation, EParadigm::Unsafe>();
+					TargetAnimation.Lock();
+					TargetAnimation.BurnFx = bStillBurning ? 1 : 0;
+					TargetAnimation.Unlock();
+				}
+			});
 	}
 	#pragma endregion
 
@@ -1001,29 +1412,76 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("DecideAgentDamage");
+		FBattleFrameStageScope StageScope(TEXT("DecideAgentDamage"));
 
-		FFilter Filter = FFilter::Make<FHealth, FLocated>();// it processes hero and prop type too
-		Filter.Exclude<FAppearing, FDying>();
+		// 合并各线程的伤害事件（含上一帧出生中未结算的），按目标分组，只访问受伤的个体
+		DamageEvents.ConsumeTo(MergedDamageEvents);
+		DamageBatch.Build(MergedDamageEvents);
+		MergedDamageEvents.Reset();
 
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(DamageBatch.Targets.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FHealth& Health,
-				FLocated& Located)
+		const bool bTelemetryEnabled = Telemetry.IsEnabled();
+
+		ParallelFor(TEXT("DecideAgentDamage"), DamageBatch.Targets.Num(), BatchSize,
+			[&](int32 TargetIndex)
 			{
-				while (!Health.DamageToTake.IsEmpty() && !Health.DamageInstigator.IsEmpty())
+				const FSubjectHandle& Subject = DamageBatch.Targets[TargetIndex];
+
+				// 英雄与道具同样结算，死亡中的个体不再结算
+				if (!Subject.IsValid() || Subject.HasTrait<FDying>() || !Subject.HasTrait<FLocated>()) return;
+
+				FHealth* HealthPtr = Subject.GetTraitPtr<FHealth, EParadigm::Unsafe>();
+
+				if (!HealthPtr) return;
+
+				const int32 EventsBegin = DamageBatch.Offsets[TargetIndex];
+				const int32 EventsEnd = DamageBatch.Offsets[TargetIndex + 1];
+
+				// 出生中的个体留到之后结算
+				if (Subject.HasTrait<FAppearing>())
+				{
+					for (int32 i = EventsBegin; i < EventsEnd; ++i)
+					{
+						DamageEvents.Add(DamageBatch.Events[i]);
+					}
+
+					return;
+				}
+
+				FHealth& Health = *HealthPtr;
+
+				// 受击者的信息每个目标只取一次
+				FBattleFrameCombatRecord Record;
+
+				if (bTelemetryEnabled)
+				{
+					Record.Frame = static_cast<uint32>(SimulationFrame);
+					Record.Time = static_cast<float>(SimulationTime);
+
+					if (const FAgent* Agent = Subject.GetTraitPtr<FAgent, EParadigm::Unsafe>())
+					{
+						Record.TargetTeam = Agent->Team;
+					}
+
+					if (const FSubType* SubType = Subject.GetTraitPtr<FSubType, EParadigm::Unsafe>())
+					{
+						Record.TargetSubType = SubType->Index;
+					}
+				}
+
+				for (int32 i = EventsBegin; i < EventsEnd; ++i)
 				{
 					// 如果怪物死了，跳出循环
 					if (Health.Current <= 0) { break; }
 
-					FSubjectHandle Instigator;
-					float damageToTake;
+					if (Health.FirstHitTime < 0.0)
+					{
+						Health.FirstHitTime = SimulationTime;
+					}
 
-					// Queue为Mpsc不需要锁
-					Health.DamageInstigator.Dequeue(Instigator);
-					Health.DamageToTake.Dequeue(damageToTake);
+					const FSubjectHandle& Instigator = DamageBatch.Events[i].Instigator;
+					const float damageToTake = DamageBatch.Events[i].Amount;
 
 					bool bIsValidStats = false;
 					FStatistics* Stats = nullptr;
@@ -1055,6 +1513,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 					else // 是致命伤害
 					{
 						Subject.SetTraitDeferred(FDying{ 0,0,Instigator });	// 标记为死亡
+						StageScope.AddDeferred();
 
 						if (Subject.HasTrait<FMove>())
 						{
@@ -1079,10 +1538,54 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						}
 					}
 
+					// 战斗记录
+					if (bTelemetryEnabled)
+					{
+						Record.Amount = FMath::Min(damageToTake, Health.Current);
+						Record.DamageType = DamageBatch.Events[i].Type;
+						Record.Flags = DamageBatch.Events[i].Flags;
+						Record.bKill = Health.Current - damageToTake <= 0;
+						Record.TimeToKill = Record.bKill ? static_cast<float>(SimulationTime - Health.FirstHitTime) : -1.f;
+						Record.InstigatorTeam = -1;
+						Record.InstigatorSubType = -1;
+
+						if (Instigator.IsValid())
+						{
+							if (const FAgent* Agent = Instigator.GetTraitPtr<FAgent, EParadigm::Unsafe>())
+							{
+								Record.InstigatorTeam = Agent->Team;
+							}
+
+							if (const FSubType* SubType = Instigator.GetTraitPtr<FSubType, EParadigm::Unsafe>())
+							{
+								Record.InstigatorSubType = SubType->Index;
+							}
+						}
+
+						Telemetry.Add(Record);
+					}
+
 					// 扣除血量
 					Health.Current -= FMath::Min(damageToTake, Health.Current);
 				}
-			}, ThreadsCount, BatchSize);
+
+				// 受伤的个体加入稀疏血条
+				if (bSparseHealthBars)
+				{
+					FHealthBar* HealthBar = Subject.GetTraitPtr<FHealthBar, EParadigm::Unsafe>();
+
+					if (HealthBar && HealthBar->bShowHealthBar)
+					{
+						HealthBar->HideTime = SimulationTime + HealthBar->HideDelay;
+
+						if (!HealthBar->bActive)
+						{
+							HealthBar->bActive = true;
+							HealthBarActivations.Add(Subject);
+						}
+					}
+				}
+			}, ThreadsCount <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
 
 		Mechanism->ApplyDeferreds();
 	}
@@ -1092,48 +1595,57 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentHealthBar");
+		FBattleFrameStageScope StageScope(TEXT("AgentHealthBar"));
 
-		static const auto Filter = FFilter::Make<FAgent, FRendering, FHealth, FHealthBar>();
+		if (bSparseHealthBars)
+		{
+			// 只处理最近受伤的个体
+			HealthBarActivations.ConsumeTo(ActiveHealthBars);
 
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+			StageScope.CalculateThreadsCountAndBatchSize(ActiveHealthBars.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FHealth Health,
-				FHealthBar& HealthBar)
-			{
-				if (HealthBar.bShowHealthBar)
+			ParallelFor(TEXT("AgentHealthBar"), ActiveHealthBars.Num(), BatchSize,
+				[&](int32 Index)
 				{
-					HealthBar.TargetRatio = FMath::Clamp(Health.Current / Health.Maximum, 0, 1);
-					HealthBar.CurrentRatio = FMath::FInterpTo(HealthBar.CurrentRatio, HealthBar.TargetRatio, DeltaTime, HealthBar.InterpSpeed);// WIP use niagara instead
+					const FSubjectHandle& Subject = ActiveHealthBars[Index];
 
-					if (HealthBar.HideOnFullHealth)
-					{
-						if (Health.Current == Health.Maximum)
-						{
-							HealthBar.Opacity = 0;
-						}
-						else
-						{
-							HealthBar.Opacity = 1;
-						}
-					}
-					else
-					{
-						HealthBar.Opacity = 1;
-					}
+					if (!Subject.IsValid()) return;
+
+					FHealthBar* HealthBar = Subject.GetTraitPtr<FHealthBar, EParadigm::Unsafe>();
+					const FHealth* Health = Subject.GetTraitPtr<FHealth, EParadigm::Unsafe>();
 
-					if (HealthBar.HideOnEmptyHealth && Health.Current <= 0)
+					if (!HealthBar || !Health) return;
+
+					UpdateHealthBar(*HealthBar, *Health, DeltaTime);
+
+					// 隐藏或延迟结束且插值完成后移出
+					if (HealthBar->Opacity == 0 || (SimulationTime >= HealthBar->HideTime && FMath::IsNearlyEqual(HealthBar->CurrentRatio, HealthBar->TargetRatio, 0.001f)))
 					{
-						HealthBar.Opacity = 0;
+						HealthBar->bActive = false;
 					}
-				}
-				else
+				}, ThreadsCount <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+			ActiveHealthBars.RemoveAllSwap([](const FSubjectHandle& Subject)
 				{
-					HealthBar.Opacity = 0;
-				}
-			}, ThreadsCount, BatchSize);
+					const FHealthBar* HealthBar = Subject.IsValid() ? Subject.GetTraitPtr<FHealthBar, EParadigm::Unsafe>() : nullptr;
+					return !HealthBar || !HealthBar->bActive;
+				});
+		}
+		else
+		{
+			static const auto Filter = FFilter::Make<FAgent, FRendering, FHealth, FHealthBar>();
+
+			auto Chain = Mechanism->EnchainSolid(Filter);
+			StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+			Chain->OperateConcurrently(
+				[&](FSolidSubjectHandle Subject,
+					FHealth Health,
+					FHealthBar& HealthBar)
+				{
+					UpdateHealthBar(HealthBar, Health, DeltaTime);
+				}, ThreadsCount, BatchSize);
+		}
 	}
 	#pragma endregion
 
@@ -1143,12 +1655,56 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentDeathMain");
+		FBattleFrameStageScope StageScope(TEXT("AgentDeathMain"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FDeath, FSound, FLocated, FDying, FDirected, FFX, FTrace, FMove, FMoving, FSpawnActor>();
-		Filter.Exclude<FAppearing>();
+		// 死亡延迟结束，移除个体
+		const TArray<FSubjectHandle> Despawns = TimerWheel.Consume(EBattleFrameTimer::Despawn);
+		StageScope.CalculateThreadsCountAndBatchSize(Despawns.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+		OperateTimersConcurrently(Despawns, ThreadsCount, BatchSize,
+			[&](FSubjectHandle Subject)
+			{
+				const FDying* Dying = Subject.GetTraitPtr<FDying, EParadigm::Unsafe>();
+				const FDeath* Death = Subject.GetTraitPtr<FDeath, EParadigm::Unsafe>();
+				const FLocated* Located = Subject.GetTraitPtr<FLocated, EParadigm::Unsafe>();
+				const FDirected* Directed = Subject.GetTraitPtr<FDirected, EParadigm::Unsafe>();
+				const FFX* FX = Subject.GetTraitPtr<FFX, EParadigm::Unsafe>();
+
+				if (!Dying || !Death || !Located || !Directed || !FX) return;
+
+				FVector InstigatorLocation = Located->Location;
+				FVector Direction = Directed->Direction;
+
+				if (Dying->Instigator.HasTrait<FLocated>() && !Dying->Instigator.HasTrait<FDying>())
+				{
+					InstigatorLocation = Dying->Instigator.GetTrait<FLocated>().Location;
+					Direction = (Located->Location - InstigatorLocation).GetSafeNormal2D();
+				}
+
+				// Fx
+				if (Death->bCanSpawnFx && FX->DeathFx.SubType != ESubType::None)
+				{
+					FRotator CombinedRotator = (FQuat(FX->DeathFx.Transform.GetRotation()) * FQuat(Direction.Rotation())).Rotator();
+					if (QueueFx(Subject, FTransform(CombinedRotator, FX->DeathFx.Transform.GetLocation(), FX->DeathFx.Transform.GetScale3D()), FX->DeathFx.SubType, EBattleFrameFxCategory::Death, Dying->Instigator, false, true))
+					{
+						StageScope.AddDeferred();
+					}
+				}
+
+				// 移除
+				ReleaseRenderInstance(Subject);
+				Subject.DespawnDeferred();
+				StageScope.AddDeferred();
+			});
+
+		Mechanism->ApplyDeferreds();
+
+		// 刚死亡的个体，初始化后安排移除
+		FFilter Filter = FFilter::Make<FAgent, FRendering, FDeath, FSound, FLocated, FDying, FDirected, FFX, FTrace, FMove, FMoving, FSpawnActor, FAnimation>();
+		Filter.Exclude<FAppearing, FDeathStarted>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
@@ -1156,86 +1712,80 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				FSound Sound,
 				FLocated Located,
 				FDying& Dying,
-				FDirected Directed,
-				FFX FX,
-				FTrace& Trace,
-				FMove& Move,
 				FMoving& Moving,
+				FAnimation& Animation,
 				FSpawnActor& SpawnActor)
 			{
-				if (Dying.Time == 0)
-				{
-					Moving.Speed = 0;
-					Dying.Duration = Death.DespawnDelay;
+				Moving.Speed = 0;
+				Dying.Time = 0;
+				Dying.Duration = Death.DespawnDelay;
 
-					// Stop attacking
-					if (Subject.HasTrait<FAttacking>())
-					{
-						Subject.RemoveTraitDeferred<FAttacking>();
-					}
+				Subject.SetTraitDeferred(FDeathStarted{});
+				StageScope.AddDeferred();
+				ScheduleTimer(FSubjectHandle{ Subject }, EBattleFrameTimer::Despawn, Death.DespawnDelay);
 
-					// Drop loot
-					if (Death.NumSpawnLoot > 0 && SpawnActor.DeathSpawnClass)
-					{
-						FSpawningActor LootToSpawn;
-						LootToSpawn.SpawnClass = SpawnActor.DeathSpawnClass;
-						LootToSpawn.Quantity = Death.NumSpawnLoot;
-						LootToSpawn.Trans = FTransform(FRotator::ZeroRotator, FLocated{ Located }, SpawnActor.DeathSpawnScale);
+				// Stop attacking
+				if (Subject.HasTrait<FAttacking>())
+				{
+					Subject.RemoveTraitDeferred<FAttacking>();
+					StageScope.AddDeferred();
+				}
 
-						FSubjectRecord Record;
-						Record.SetTrait(LootToSpawn);
+				// Drop loot
+				if (Death.NumSpawnLoot > 0 && SpawnActor.DeathSpawnClass)
+				{
+					FSpawningActor LootToSpawn;
+					LootToSpawn.SpawnClass = SpawnActor.DeathSpawnClass;
+					LootToSpawn.Quantity = Death.NumSpawnLoot;
+					LootToSpawn.Trans = FTransform(FRotator::ZeroRotator, FLocated{ Located }, SpawnActor.DeathSpawnScale);
 
-						Mechanism->SpawnSubjectDeferred(Record);
-					}
+					FSubjectRecord Record;
+					Record.SetTrait(LootToSpawn);
 
-					// Fade out
-					if (Death.bCanFadeout)
-					{
-						Subject.SetTraitDeferred(FDeathDissolve{});
-					}
-
-					// Anim
-					if (Death.bCanPlayAnim)
-					{
-						Subject.SetTraitDeferred(FDeathAnim{});
-					}
-
-					// Sound
-					if (Sound.DeathSound)
-					{
-						float Probability = Sound.bUseProbability ? RangeMapProbability(DyingAgentCount, Sound.DeathSoundProbability) : 100.1;
-						QueueSound(Sound.DeathSound, Probability);
-					}
+					Mechanism->SpawnSubjectDeferred(Record);
+					StageScope.AddDeferred();
+				}
 
-					// Scale In(WIP)
+				// Fade out
+				if (Death.bCanFadeout)
+				{
+					Subject.SetTraitDeferred(FDeathDissolve{});
+					StageScope.AddDeferred();
 				}
-				else if (Dying.Time > Dying.Duration)
+
+				// Anim
+				if (Death.bCanPlayAnim)
 				{
-					FVector InstigatorLocation = Located.Location;
-					FVector Direction = Directed.Direction;
+					Animation.SubjectState = ESubjectState::Dying;
+					Animation.PreviousSubjectState = ESubjectState::Dirty;
 
-					if (Dying.Instigator.HasTrait<FLocated>() && !Dying.Instigator.HasTrait<FDying>())
-					{
-						InstigatorLocation = Dying.Instigator.GetTrait<FLocated>().Location;
-						Direction = (Located.Location - InstigatorLocation).GetSafeNormal2D();
-					}
-					
-					// Fx
-					if (Death.bCanSpawnFx && FX.DeathFx.SubType != ESubType::None)
-					{
-						FRotator CombinedRotator = (FQuat(FX.DeathFx.Transform.GetRotation()) * FQuat(Direction.Rotation())).Rotator();
-						QueueFx(FSubjectHandle{ Subject }, FTransform(CombinedRotator, FX.DeathFx.Transform.GetLocation(), FX.DeathFx.Transform.GetScale3D()), FX.DeathFx.SubType);
-					}
+					Subject.SetTraitDeferred(FDeathAnim{});
+					StageScope.AddDeferred();
+				}
 
-					// 移除	
-					Subject.DespawnDeferred();
+				// Sound
+				if (Sound.DeathSound)
+				{
+					float Probability = Sound.bUseProbability ? RangeMapProbability(DyingAgentCount, Sound.DeathSoundProbability) : 100.1;
+					QueueSound(Sound.DeathSound, Probability, FSubjectHandle{ Subject });
 				}
 
-				Dying.Time += DeltaTime;
+				// Scale In(WIP)
 
 			}, ThreadsCount, BatchSize);
 
 		Mechanism->ApplyDeferreds();
+
+		// 已死亡的时长，移除由计时轮触发，这里只给外部读取
+		auto DyingChain = Mechanism->EnchainSolid(FFilter::Make<FAgent, FDying, FDeathStarted>());
+		StageScope.CalculateThreadsCountAndBatchSize(DyingChain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+		DyingChain->OperateConcurrently(
+			[&](FDying& Dying)
+			{
+				Dying.Time += DeltaTime;
+
+			}, ThreadsCount, BatchSize);
 	}
 	#pragma endregion
 
@@ -1243,46 +1793,29 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentDeathDissolve");
+		FBattleFrameStageScope StageScope(TEXT("AgentDeathDissolve"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FDeathDissolve, FAnimation, FDying, FDeath, FCurves>();
+		FFilter Filter = FFilter::Make<FAgent, FRendering, FDeathDissolve, FAnimation, FDying, FDeath>();
 		Filter.Exclude<FAppearing>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
 				FAnimation& Animation,
 				FDeathDissolve& DeathDissolve,
-				FDeath& Death,
-				FCurves& Curves)
+				FDeath& Death)
 			{
-				// 获取曲线
-				auto Curve = Curves.DissolveOut.GetRichCurve();
-
-				// 检查曲线是否有关键帧
-				if (Curve->GetNumKeys() == 0)
-				{
-					// 如果没有关键帧，添加默认关键帧
-					Curve->Reset();
-					FKeyHandle Key1 = Curve->AddKey(0.0f, 1.0f); // 初始值
-					FKeyHandle Key2 = Curve->AddKey(1.0f, 0.0f); // 结束值
-
-					// 设置自动切线
-					Curve->SetKeyInterpMode(Key1, RCIM_Cubic);
-					Curve->SetKeyInterpMode(Key2, RCIM_Cubic);
-
-					Curve->SetKeyTangentMode(Key1, RCTM_Auto);
-					Curve->SetKeyTangentMode(Key2, RCTM_Auto);
-				}
-
-				// 获取曲线的最后一个关键帧的时间
-				const auto EndTime = Curve->GetLastKey().Time;
+				// 获取曲线，没有烘焙曲线的个体使用默认曲线
+				const FBakedCurves* BakedCurves = Subject.GetTraitPtr<FBakedCurves, EParadigm::Unsafe>();
+				const FBakedCurve& Curve = CurveRegistry.GetSet(BakedCurves ? BakedCurves->Index : INDEX_NONE).DissolveOut;
+				const float EndTime = Curve.EndTime;
 
 				// 计算溶解效果
 				if (DeathDissolve.dissolveTime >= Death.FadeOutDelay && (DeathDissolve.dissolveTime - Death.FadeOutDelay) < EndTime)
 				{
-					Animation.Dissolve = 1 - Curve->Eval(DeathDissolve.dissolveTime - Death.FadeOutDelay);
+					Animation.Dissolve = 1 - Curve.Eval(DeathDissolve.dissolveTime - Death.FadeOutDelay);
 				}
 
 				// 更新溶解时间
@@ -1292,70 +1825,36 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	}
 	#pragma endregion
 
-	// 死亡动画
-	#pragma region
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentDeathAnim");
-
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FDeathAnim, FAnimation, FDying>();
-		Filter.Exclude<FAppearing>();
-
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
-
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FAnimation& Animation,
-				FDeathAnim& DeathAnim)
-			{
-				if (DeathAnim.animTime == 0)
-				{
-					Animation.SubjectState = ESubjectState::Dying;
-					Animation.PreviousSubjectState = ESubjectState::Dirty;
-				}
-
-				DeathAnim.animTime += DeltaTime;
-
-			}, ThreadsCount, BatchSize);
-	}
-	#pragma endregion
-
 	//-----------------------移动逻辑------------------------
 
 	// 冰冻减速
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentFrozen");
+		FBattleFrameStageScope StageScope(TEXT("AgentFrozen"));
 
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FAnimation, FFreezing>();
-		Filter.Exclude<FAppearing, FDying>();
-
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		// 冰冻到期，被刷新过的以 EndTime 为准
+		const TArray<FSubjectHandle> Thawed = TimerWheel.Consume(EBattleFrameTimer::FreezeEnd);
+		StageScope.CalculateThreadsCountAndBatchSize(Thawed.Num(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FAnimation& Animation,
-				FFreezing& Freezing)
+		OperateTimersConcurrently(Thawed, ThreadsCount, BatchSize,
+			[&](FSubjectHandle Subject)
 			{
-				// 更新计时器
-				if (Freezing.SlowTimeout > 0.f)
-				{
-					Freezing.SlowTimeout -= DeltaTime;
-				}
+				const FFreezing* Freezing = Subject.GetTraitPtr<FFreezing, EParadigm::Unsafe>();
 
-				// 计时器结束
-				if (Freezing.SlowTimeout <= 0.f)
-				{
-					// 设置DP为0，怪物颜色复原
-					Animation.FreezeFx = 0;
-					Animation.PreviousSubjectState = ESubjectState::Dirty; // 强制刷新动画状态机
+				if (!Freezing || Freezing->EndTime > SimulationTime + KINDA_SMALL_NUMBER || Subject.HasTrait<FDying>()) return;
 
-					// 怪物可以解耦
-					Subject.RemoveTraitDeferred<FFreezing>();
+				// 设置DP为0，怪物颜色复原
+				if (FAnimation* Animation = Subject.GetTraitPtr<FAnimation, EParadigm::Unsafe>())
+				{
+					Animation->FreezeFx = 0;
+					Animation->PreviousSubjectState = ESubjectState::Dirty; // 强制刷新动画状态机
 				}
 
-			}, ThreadsCount, BatchSize);
+				// 怪物可以解耦
+				Subject.RemoveTraitDeferred<FFreezing>();
+				StageScope.AddDeferred();
+			});
 
 		Mechanism->ApplyDeferreds();
 	}
@@ -1365,11 +1864,12 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("SpeedLimitOverride");
+		FBattleFrameStageScope StageScope(TEXT("SpeedLimitOverride"));
 
 		FFilter Filter = FFilter::Make<FCollider, FLocated, FRoadBlock>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FCollider Collider,
@@ -1428,13 +1928,14 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentXYMovement");
+		FBattleFrameStageScope StageScope(TEXT("AgentXYMovement"));
 
 		// 初始化过滤器
 		FFilter Filter = FFilter::Make<FAgent, FRendering, FAnimation, FMove, FMoving, FDirected, FLocated, FAttack, FTrace, FNavigation,FAvoidance>();
 		Filter.Exclude<FAppearing>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
@@ -1472,7 +1973,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						DesiredSpeed = 0; // 获取不到目标位置，这是误操作，不移动
 					}
 				}
-				else if (LIKELY(IsValid(Navigation.FlowField))) // 有流场就按流场走
+				else if (LIKELY(Navigation.FlowField && CrowdInputs.FlowFieldLocations.Contains(Navigation.FlowField))) // 有流场就按流场走
 				{
 					bool bInside;
 					FCellStruct Cell;
@@ -1589,7 +2090,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				{
 					const auto& Freezing = Subject.GetTraitRef<FFreezing, EParadigm::Unsafe>();
 
-					if (Freezing.SlowTimeout > 0.0f)
+					if (Freezing.EndTime > SimulationTime)
 					{
 						DesiredSpeed *= (1.0f - Freezing.SlowStr); //冰冻时减速
 					}
@@ -1668,6 +2169,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				else if (bIsDying && Speed < 100.f && !Subject.HasTrait<FStatic>())
 				{
 					Subject.SetTraitDeferred(FStatic{});
+					StageScope.AddDeferred();
 				}
 
 			}, ThreadsCount, BatchSize);
@@ -1678,6 +2180,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RVO2");
+		FBattleFrameStageScope StageScope(TEXT("RVO2"));
 		NeighborGrid->Evaluate();
 	}
 	#pragma endregion
@@ -1686,13 +2189,14 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentZMovement");
+		FBattleFrameStageScope StageScope(TEXT("AgentZMovement"));
 
 		// 初始化过滤器
 		FFilter Filter = FFilter::Make<FAgent, FRendering, FMove, FMoving, FDirected, FLocated, FCollider, FNavigation>();
 		Filter.Exclude<FAppearing>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
@@ -1710,7 +2214,9 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 				// 死亡区域检测
 				if (Located.Location.Z < Move.KillZ)
 				{
+					ReleaseRenderInstance(Subject);
 					Subject.DespawnDeferred();
+					StageScope.AddDeferred();
 					return;
 				}
 
@@ -1719,21 +2225,18 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 
 				//--------------------------- 流场数据准备 ------------------------//
 
-				if (!IsValid(Navigation.FlowField))
+				// 流场在游戏线程收集，已销毁的流场不在其中
+				const FVector* FlowFieldLocation = Navigation.FlowField ? CrowdInputs.FlowFieldLocations.Find(Navigation.FlowField) : nullptr;
+
+				if (!FlowFieldLocation)
 				{
-					if (Navigation.FlowFieldActor)
-					{
-						Navigation.FlowField = Navigation.FlowFieldActor.LoadSynchronous();
-						return;
-					}
-					else
-					{
-						return;
-					}
+					AFlowField* const* Resolved = Navigation.FlowFieldActor.IsNull() ? nullptr : CrowdInputs.FlowFieldsByPath.Find(Navigation.FlowFieldActor.ToSoftObjectPath());
+					Navigation.FlowField = Resolved ? *Resolved : nullptr;
+					return;
 				}
 
 				// 计算流场基准位置
-				const FVector FlowFieldOrigin = Navigation.FlowField->GetActorLocation() - FVector(Navigation.FlowField->flowFieldSize.X / 2, Navigation.FlowField->flowFieldSize.Y / 2, 0);
+				const FVector FlowFieldOrigin = *FlowFieldLocation - FVector(Navigation.FlowField->flowFieldSize.X / 2, Navigation.FlowField->flowFieldSize.Y / 2, 0);
 
 				// 碰撞参数
 				const float CellSize = Navigation.FlowField->cellSize;
@@ -1817,7 +2320,9 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						}
 						else
 						{
+							ReleaseRenderInstance(Subject);
 							Subject.DespawnDeferred();
+							StageScope.AddDeferred();
 						}
 					}
 				}
@@ -1843,87 +2348,41 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	}
 	#pragma endregion
 
-	//--------------------------其它---------------------------
-
-	// 播放音效
-	#pragma region
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("PlaySound");
-
-		for (int32 i = 0; i < NumSoundsPerFrame; ++i)
-		{
-			if (SoundsToPlay.IsEmpty())
-			{
-				break;
-			}
-
-			TSoftObjectPtr<USoundBase> Sound;
-
-			if (!SoundsToPlay.Dequeue(Sound))
-			{
-				break;
-			}
-
-			// 异步加载音效并绑定回调函数以在加载完成后播放音效
-			StreamableManager.RequestAsyncLoad(Sound.ToSoftObjectPath(), FStreamableDelegate::CreateLambda([this, Sound]()
-				{
-					// 播放加载完成的音效
-					UGameplayStatics::PlaySound2D(GetWorld(), Sound.Get(), SoundVolume);
-				}));
-		}
-	}
-	#pragma endregion
-
-	// Spawn Actors
-	#pragma region
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Spawn Actors");
-
-		FFilter Filter = FFilter::Make<FSpawningActor>();
-
-		Mechanism->Operate<FUnsafeChain>(Filter,
-			[&](FSubjectHandle Subject,
-				FSpawningActor& SpawningActor)
-			{
-				if (SpawningActor.Quantity > 0 && SpawningActor.SpawnClass)
-				{
-					FActorSpawnParameters SpawnParams;
-					SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-					for (int32 i = 0; i < SpawningActor.Quantity; ++i)
-					{
-						AActor* Actor = CurrentWorld->SpawnActor<AActor>(SpawningActor.SpawnClass, SpawningActor.Trans, SpawnParams);
-
-						if (Actor != nullptr)
-						{
-							Actor->SetActorScale3D(SpawningActor.Trans.GetScale3D());
-						}
-					}
-				}
-
-				Subject.Despawn();
-			});
-	}
-	#pragma endregion
-
 	//------------------------更新渲染------------------------
 
 	// 动画状态机
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentStateMachine");
-		static const auto Filter = FFilter::Make<FAgent, FAnimation, FRendering, FAppear, FAttack, FDeath>();
+		FBattleFrameStageScope StageScope(TEXT("AgentStateMachine"));
+		static const auto Filter = FFilter::Make<FAgent, FAnimation, FRendering, FAppear, FAttack, FDeath, FLocated>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+		const bool bUseAnimLOD = bAnimationLOD && CrowdInputs.bViewIsValid;
+		const float AnimLODDistanceSquared = FMath::Square(AnimLODDistance);
+		const int32 LODPhaseGroups = FMath::Max(AnimLODPhaseGroups, 1);
+		const float LODPhasePeriod = FMath::Max(AnimLODPhasePeriod, 0.01f);
+		const uint64 LODUpdateInterval = FMath::Max(AnimLODUpdateInterval, 1);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
 				FAnimation& Anim,
 				FAppear& Appear,
 				FAttack& Attack,
-				FDeath& Death)
+				FDeath& Death,
+				const FLocated& Located)
 			{
+				const bool bLOD = bUseAnimLOD && FVector::DistSquared(Located.Location, CrowdInputs.ViewLocation) > AnimLODDistanceSquared;
+				const uint64 Key = bLOD ? FBattleFrameRandom::SubjectKey(FSubjectHandle{ Subject }) : 0;
+
+				// 远处的个体错开帧更新，状态切换最多延迟几帧
+				if (bLOD && (Key + SimulationFrame) % LODUpdateInterval != 0)
+				{
+					return;
+				}
+
 				if (Anim.SubjectState != Anim.PreviousSubjectState && Anim.AnimLerp == 1)
 				{
 					switch (Anim.SubjectState)
@@ -1932,7 +2391,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						{
 							CopyAnimData(Anim);
 							Anim.AnimIndex1 = Anim.IndexOfIdleAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = 0;
 							Anim.AnimPlayRate1 = 1;
@@ -1943,7 +2402,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						{
 							CopyAnimData(Anim);
 							Anim.AnimIndex1 = Anim.IndexOfIdleAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = 0;
 							Anim.AnimPlayRate1 = 0;
@@ -1953,7 +2412,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						case ESubjectState::Appearing:
 						{
 							Anim.AnimIndex1 = Anim.IndexOfAppearAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = Anim.AppearAnimLength;
 							Anim.AnimPlayRate1 = Anim.AppearAnimLength / Appear.Duration;
@@ -1967,7 +2426,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 							CopyAnimData(Anim);
 
 							Anim.AnimIndex1 = Anim.IndexOfIdleAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = 0;
 
@@ -1986,7 +2445,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						{
 							CopyAnimData(Anim);
 							Anim.AnimIndex1 = Anim.IndexOfMoveAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = 0;
 
@@ -2005,7 +2464,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						{
 							CopyAnimData(Anim);
 							Anim.AnimIndex1 = Anim.IndexOfAttackAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = Anim.AttackAnimLength;
 							Anim.AnimPlayRate1 = Anim.AttackAnimLength / Attack.DurationPerRound;
@@ -2016,7 +2475,7 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						{
 							CopyAnimData(Anim);
 							Anim.AnimIndex1 = Anim.IndexOfDeathAnim;
-							Anim.AnimCurrentTime1 = GetGameTimeSinceCreation();
+							Anim.AnimCurrentTime1 = CrowdInputs.GameTime;
 							Anim.AnimOffsetTime1 = 0;
 							Anim.AnimPauseTime1 = Anim.DeathAnimLength;
 							Anim.AnimPlayRate1 = 1;
@@ -2024,31 +2483,166 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 						}
 					}
 					Anim.PreviousSubjectState = Anim.SubjectState;
+
+					if (bLOD)
+					{
+						// 不做混合，只保留目标动画
+						CopyAnimData(Anim);
+
+						// 循环动画对齐到共享相位，出生、攻击与死亡保持原有时间
+						if (Anim.SubjectState != ESubjectState::Appearing && Anim.SubjectState != ESubjectState::Attacking && Anim.SubjectState != ESubjectState::Dying)
+						{
+							Anim.AnimCurrentTime1 = FBattleFrameAnimPhase::SnapToGroup(Anim.AnimCurrentTime1, Key, LODPhaseGroups, LODPhasePeriod);
+							Anim.AnimCurrentTime0 = Anim.AnimCurrentTime1;
+						}
+					}
 				}
-				Anim.AnimLerp = FMath::Clamp(Anim.AnimLerp + DeltaTime * Anim.LerpSpeed, 0, 1);
+
+				// 动画 LOD 下混合直接完成，动画通道不再逐帧变化
+				Anim.AnimLerp = bLOD ? 1.f : FMath::Clamp(Anim.AnimLerp + DeltaTime * Anim.LerpSpeed, 0, 1);
 
 			}, ThreadsCount, BatchSize);
 	}
 	#pragma endregion
+}
+
+void ABattleFrameGameMode::PresentCrowd()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("PresentCrowd");
+
+	//--------------------------其它---------------------------
+
+	// 播放音效
+	#pragma region
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("PlaySound");
+		FBattleFrameStageScope StageScope(TEXT("PlaySound"));
+
+		// 开启预算时只播放本帧评分最高的几个，其余丢弃
+		MergedSoundEvents.Reset();
+		SoundEvents.ConsumeTo(MergedSoundEvents);
+
+		if (MergedSoundEvents.Num() > NumSoundsPerFrame)
+		{
+			MergedSoundEvents.Sort([](const FSoundEvent& A, const FSoundEvent& B)
+			{
+				return A.Priority != B.Priority ? A.Priority > B.Priority : A.Key < B.Key;
+			});
+
+			const int32 DroppedNum = MergedSoundEvents.Num() - FMath::Max(NumSoundsPerFrame, 0);
+			DroppedSoundCount += DroppedNum;
+			SET_DWORD_STAT(STAT_BattleFrameDroppedSounds, DroppedNum);
+
+			MergedSoundEvents.SetNum(FMath::Max(NumSoundsPerFrame, 0), false);
+		}
+		else
+		{
+			SET_DWORD_STAT(STAT_BattleFrameDroppedSounds, 0);
+		}
+
+		for (const FSoundEvent& Event : MergedSoundEvents)
+		{
+			SoundsToPlay.Enqueue(Event.Sound);
+		}
+
+		for (int32 i = 0; i < NumSoundsPerFrame; ++i)
+		{
+			if (SoundsToPlay.IsEmpty())
+			{
+				break;
+			}
+
+			TSoftObjectPtr<USoundBase> Sound;
+
+			if (!SoundsToPlay.Dequeue(Sound))
+			{
+				break;
+			}
+
+			// 异步加载音效并绑定回调函数以在加载完成后播放音效
+			StreamableManager.RequestAsyncLoad(Sound.ToSoftObjectPath(), FStreamableDelegate::CreateLambda([this, Sound]()
+				{
+					// 播放加载完成的音效
+					UGameplayStatics::PlaySound2D(GetWorld(), Sound.Get(), SoundVolume);
+				}));
+		}
+	}
+	#pragma endregion
+
+	// 分发特效事件
+	#pragma region
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("DistributeFxEvents");
+		FBattleFrameStageScope StageScope(TEXT("DistributeFxEvents"));
+
+		UnroutedFxEvents.Reset();
+		const int32 DroppedNum = FxEvents.Distribute(bBudgetFx ? &FxBudget : nullptr, CrowdInputs.CullingView, UnroutedFxEvents);
+
+		// 没有直接接收的渲染器时仍以 Subject 交给渲染器
+		for (const FBattleFrameFxEvent& Event : UnroutedFxEvents)
+		{
+			Mechanism->SpawnSubject(MakeFxRecord(Event.Location, Event.Direction, Event.Scale, Event.SubType));
+		}
+
+		DroppedFxCount += DroppedNum;
+		SET_DWORD_STAT(STAT_BattleFrameDroppedFx, DroppedNum);
+	}
+	#pragma endregion
+
+	// Spawn Actors
+	#pragma region
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Spawn Actors");
+		FBattleFrameStageScope StageScope(TEXT("Spawn Actors"));
+
+		FFilter Filter = FFilter::Make<FSpawningActor>();
+
+		Mechanism->Operate<FUnsafeChain>(Filter,
+			[&](FSubjectHandle Subject,
+				FSpawningActor& SpawningActor)
+			{
+				if (SpawningActor.Quantity > 0 && SpawningActor.SpawnClass)
+				{
+					FActorSpawnParameters SpawnParams;
+					SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+					for (int32 i = 0; i < SpawningActor.Quantity; ++i)
+					{
+						AActor* Actor = CurrentWorld->SpawnActor<AActor>(SpawningActor.SpawnClass, SpawningActor.Trans, SpawnParams);
+
+						if (Actor != nullptr)
+						{
+							Actor->SetActorScale3D(SpawningActor.Trans.GetScale3D());
+						}
+					}
+				}
+
+				Subject.Despawn();
+			});
+	}
+	#pragma endregion
 
 	// 重置渲染数据
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("ClearValidTransforms");
+		FBattleFrameStageScope StageScope(TEXT("ClearValidTransforms"));
 
 		FFilter Filter = FFilter::Make<FRenderBatchData>().Exclude<FDying>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently(
 			[&](FSolidSubjectHandle Subject,
 				FRenderBatchData& Data)
 			{
-				Data.ValidTransforms.Reset();
+				FMemory::Memzero(Data.ValidTransforms.GetData(), Data.ValidTransforms.Num() * sizeof(bool));
 
 				Data.Text_Location_Array.Reset();
 				Data.Text_Value_Style_Scale_Offset_Array.Reset();
+				Data.ActiveHealthBar_Location_Array.Reset();
+				Data.ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array.Reset();
 
 			}, ThreadsCount, BatchSize);
 	}
@@ -2058,508 +2652,871 @@ void ABattleFrameGameMode::Tick(float DeltaTime)
 	#pragma region
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentRender");
+		FBattleFrameStageScope StageScope(TEXT("AgentRender"));
+
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_STR("BuildCullingGrid");
+			// 特效预算也会生成视锥，只在开启剔除时使用网格
+			if (bCullInvisibleAgents)
+			{
+				CullingGrid.Build(CrowdInputs.CullingView, CullingCellSize);
+			}
+			else
+			{
+				CullingGrid.Reset();
+			}
+		}
+
+		std::atomic<int32> CulledNum{ 0 };
 
 		FFilter Filter = FFilter::Make<FAgent, FRendering, FDirected, FScaled, FLocated, FAnimation, FHealth, FHealthBar, FCollider>();
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+		Chain->OperateConcurrently(
+			[&](FSolidSubjectHandle Subject,
+				FRendering& Rendering,
+				FDirected& Directed,
+				FScaled& Scaled,
+				FLocated& Located,
+				FAnimation& Anim,
+				FHealth& Health,
+				FHealthBar& HealthBar,
+				FCollider& Collider)
+			{
+				if (!Rendering.Renderer.IsValid())
+				{
+					// 标记为死亡
+					Subject.SetTraitDeferred(FDying{});
+					StageScope.AddDeferred();
+					return;
+				}
+
+				FRenderBatchData& Data = Rendering.Renderer.GetTraitRef<FRenderBatchData, EParadigm::Unsafe>();
+
+				FQuat Rotation{ FQuat::Identity };
+				Rotation = Directed.Direction.Rotation().Quaternion();
+
+				FVector FinalScale(Data.Scale);
+				FinalScale *= Scaled.renderFactors;
+
+				float Radius = Collider.Radius;
+
+				// 在计算转换时减去Radius
+				FTransform SubjectTransform( Rotation * Data.OffsetRotation.Quaternion(),Located.Location + Data.OffsetLocation - FVector(0, 0, Radius), FinalScale); // 减去Z轴上的Radius					
+
+				int32 InstanceId = Rendering.InstanceId;
+
+				const bool bVisible = CullingGrid.IsVisible(Located.Location);
+
+				// 只写入该实例自己的槽位与改动标记，无需加锁
+				Data.ValidTransforms[InstanceId] = true;
+				Data.WrittenNum.fetch_add(1, std::memory_order_relaxed);
+				Data.Transforms[InstanceId] = SubjectTransform;
+
+				// 视锥外的实例放回池中隐藏，其余数据保持不变，重新可见时只上传变化的部分
+				if (!bVisible)
+				{
+					if (Data.CrowdBuffer.IsValid())
+					{
+						Data.CrowdBuffer->WritePooled(InstanceId, true);
+					}
+					else
+					{
+						Data.Write(ERenderChannel::InsidePool, Data.InsidePool_Array, InstanceId, true);
+					}
+
+					CulledNum.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				// 数据接口只读取打包数据的快照，逐通道的数组不再写入
+				if (Data.CrowdBuffer.IsValid())
+				{
+					FBattleFrameCrowdBuffer& Packed = *Data.CrowdBuffer;
+					Packed.WriteTransform(InstanceId, SubjectTransform.GetLocation(), SubjectTransform.GetRotation(), SubjectTransform.GetScale3D());
+					Packed.WriteAnim(InstanceId, FVector4(Anim.AnimIndex0, Anim.AnimIndex1, Anim.AnimPauseTime0, Anim.AnimPauseTime1), FVector4(Anim.AnimCurrentTime0 + Anim.AnimOffsetTime0, Anim.AnimCurrentTime1 + Anim.AnimOffsetTime1, Anim.AnimPlayRate0, Anim.AnimPlayRate1), Anim.AnimLerp);
+					Packed.WriteMatFx(InstanceId, FVector4(Anim.HitGlow, Anim.FreezeFx, Anim.BurnFx, Anim.Dissolve));
+					Packed.WriteHealthBar(InstanceId, bSparseHealthBars ? FVector::ZeroVector : FVector(HealthBar.Opacity, HealthBar.CurrentRatio, HealthBar.TargetRatio));
+					Packed.WritePooled(InstanceId, false);
+					return;
+				}
+
+				Data.Write(ERenderChannel::InsidePool, Data.InsidePool_Array, InstanceId, false);
+
+				// 只记录有变化的值，同步时按改动上传
+
+				// Transforms
+				if (Data.bQuantized)
+				{
+					Data.Write(ERenderChannel::QuantizedLocationXY, Data.Quantized_LocationXY_Array, InstanceId, FBattleFrameRenderQuantize::EncodeLocationXY(SubjectTransform.GetLocation(), Data.QuantizeOrigin, Data.QuantizeStep));
+					Data.Write(ERenderChannel::QuantizedLocationZYaw, Data.Quantized_LocationZ_Yaw_Array, InstanceId, FBattleFrameRenderQuantize::EncodeLocationZYaw(SubjectTransform.GetLocation(), SubjectTransform.GetRotation(), Data.QuantizeOrigin, Data.QuantizeStep));
+
+					if (!FBattleFrameRenderQuantize::IsInRange(SubjectTransform.GetLocation(), Data.QuantizeOrigin, Data.QuantizeStep))
+					{
+						Data.bQuantizeOutOfRange.store(true, std::memory_order_relaxed);
+					}
+				}
+				else
+				{
+					Data.Write(ERenderChannel::Location, Data.LocationArray, InstanceId, SubjectTransform.GetLocation());
+					Data.Write(ERenderChannel::Orientation, Data.OrientationArray, InstanceId, SubjectTransform.GetRotation());
+				}
+
+				Data.Write(ERenderChannel::Scale, Data.ScaleArray, InstanceId, SubjectTransform.GetScale3D());
+
+				// Dynamic params 0
+				Data.Write(ERenderChannel::AnimIndex, Data.Anim_Index0_Index1_PauseTime0_PauseTime1_Array, InstanceId, FVector4(Anim.AnimIndex0,Anim.AnimIndex1,Anim.AnimPauseTime0,Anim.AnimPauseTime1));
+
+				// Dynamic params 1
+				Data.Write(ERenderChannel::AnimTime, Data.Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array, InstanceId, FVector4(Anim.AnimCurrentTime0 + Anim.AnimOffsetTime0, Anim.AnimCurrentTime1 + Anim.AnimOffsetTime1, Anim.AnimPlayRate0, Anim.AnimPlayRate1));
+
+				// Pariticle color R
+				Data.Write(ERenderChannel::AnimLerp, Data.Anim_Lerp_Array, InstanceId, Anim.AnimLerp);
+
+				// Dynamic params 2 & HealthBar，稀疏血条另行上传，逐实例的保持隐藏
+				const FVector4 MatFx(Anim.HitGlow, Anim.FreezeFx, Anim.BurnFx, Anim.Dissolve);
+				const FVector HealthBarValue = bSparseHealthBars ? FVector::ZeroVector : FVector(HealthBar.Opacity, HealthBar.CurrentRatio, HealthBar.TargetRatio);
+
+				if (Data.bQuantized)
+				{
+					Data.Write(ERenderChannel::QuantizedMatFx, Data.Quantized_HitGlow_Freeze_Burn_Dissolve_Array, InstanceId, FBattleFrameRenderQuantize::EncodeUnorm4(MatFx));
+					Data.Write(ERenderChannel::QuantizedHealthBar, Data.Quantized_HealthBar_Array, InstanceId, FBattleFrameRenderQuantize::EncodeUnorm3(HealthBarValue));
+				}
+				else
+				{
+					Data.Write(ERenderChannel::MatFx, Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array, InstanceId, MatFx);
+					Data.Write(ERenderChannel::HealthBar, Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array, InstanceId, HealthBarValue);
+				}
+
+			}, ThreadsCount, BatchSize);
+
+		SET_DWORD_STAT(STAT_BattleFrameCulledAgents, CulledNum.load(std::memory_order_relaxed));
+	}
+	#pragma endregion
+
+	// 合批受击数字
+	#pragma region
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentPoppingText");
+		FBattleFrameStageScope StageScope(TEXT("AgentPoppingText"));
+
+		// 合并同一目标的伤害，按优先级取本帧预算内的数字
+		const int32 DroppedNum = TextRing.Drain(SimulationTime, TextMergeWindow, TextBudgetPerFrame, DrainedTextEvents);
+
+		for (const FBattleFrameTextEvent& Event : DrainedTextEvents)
+		{
+			if (FRenderBatchData* Data = Event.Renderer.GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>())
+			{
+				Data->Text_Location_Array.Add(Event.Location);
+				Data->Text_Value_Style_Scale_Offset_Array.Add(FVector4(Event.Value, Event.Style, Event.Scale, Event.Offset));
+			}
+		}
+
+		DroppedTextCount += DroppedNum;
+		SET_DWORD_STAT(STAT_BattleFrameDroppedTexts, DroppedNum);
+	}
+	#pragma endregion
+
+	// 合批稀疏血条
+	#pragma region
+	if (bSparseHealthBars)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("AgentActiveHealthBar");
+		FBattleFrameStageScope StageScope(TEXT("AgentActiveHealthBar"));
+
+		for (const FSubjectHandle& Subject : ActiveHealthBars)
+		{
+			if (!Subject.IsValid()) continue;
+
+			const FRendering* Rendering = Subject.GetTraitPtr<FRendering, EParadigm::Unsafe>();
+			const FLocated* Located = Subject.GetTraitPtr<FLocated, EParadigm::Unsafe>();
+			const FHealthBar* HealthBar = Subject.GetTraitPtr<FHealthBar, EParadigm::Unsafe>();
+
+			if (!Rendering || !Located || !HealthBar || !CullingGrid.IsVisible(Located->Location)) continue;
+
+			if (FRenderBatchData* Data = Rendering->Renderer.GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>())
+			{
+				const FCollider* Collider = Subject.GetTraitPtr<FCollider, EParadigm::Unsafe>();
+
+				Data->ActiveHealthBar_Location_Array.Add(Located->Location + FVector(0, 0, Collider ? Collider->Radius : 0.f));
+				Data->ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array.Add(FVector(HealthBar->Opacity, HealthBar->CurrentRatio, HealthBar->TargetRatio));
+			}
+		}
+	}
+	#pragma endregion
+
+	// Write Pooling Info
+	#pragma region
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Write Pooling Info");
+		FBattleFrameStageScope StageScope(TEXT("Write Pooling Info"));
+
+		FFilter Filter = FFilter::Make<FRenderBatchData>().Exclude<FDying>();
+
+		auto Chain = Mechanism->EnchainSolid(Filter);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+		Chain->OperateConcurrently(
+			[&](FSolidSubjectHandle Subject,
+				FRenderBatchData& Data)
+			{
+				// 所有实例写入后再移动原点，此时 ValidTransforms 仍对应本帧的实例
+				if (Data.bQuantized && Data.bQuantizeOutOfRange.exchange(false, std::memory_order_relaxed))
+				{
+					RebaseQuantizeOrigin(Data);
+				}
+
+				// 本帧释放的槽位并入空闲列表，同一槽位可能被释放多次
+				int32 PooledNum = Data.FreeTransforms.Num();
+
+				Data.Lock();
+				Data.ReleasedTransforms.Sort();
+
+				for (int32 i = 0; i < Data.ReleasedTransforms.Num(); ++i)
+				{
+					if (i == 0 || Data.ReleasedTransforms[i] != Data.ReleasedTransforms[i - 1])
+					{
+						Data.FreeTransforms.Add(Data.ReleasedTransforms[i]);
+					}
+				}
+
+				Data.ReleasedTransforms.Reset();
+				Data.Unlock();
+
+				// 有个体未经释放就不再写入（例如在别处被移除），整体重新收集一次
+				if (Data.WrittenNum.exchange(0, std::memory_order_relaxed) != Data.Transforms.Num() - Data.FreeTransforms.Num())
+				{
+					Data.FreeTransforms.Reset();
+					PooledNum = 0;
+
+					for (int32 i = 0; i < Data.Transforms.Num(); ++i)
+					{
+						if (!Data.ValidTransforms[i])
+						{
+							Data.FreeTransforms.Add(i);
+						}
+					}
+				}
+
+				if (bCompactRenderBatches)
+				{
+					CompactRenderBatch(Data, bShrinkRenderBatches);
+				}
+				else
+				{
+					// 之前的空闲槽位已在池中，只隐藏新的
+					for (int32 FreeIndex = PooledNum; FreeIndex < Data.FreeTransforms.Num(); ++FreeIndex)
+					{
+						const int32 i = Data.FreeTransforms[FreeIndex];
+
+						if (Data.CrowdBuffer.IsValid())
+						{
+							Data.CrowdBuffer->WritePooled(i, true);
+						}
+						else
+						{
+							Data.Write(ERenderChannel::InsidePool, Data.InsidePool_Array, i, true);
+						}
+					}
+				}
+
+				// 汇总本帧各实例的改动
+				Data.CollectDirty();
+
+			}, ThreadsCount, BatchSize);
+	}
+	#pragma endregion
+
+	// 同步至Niagara
+	#pragma region
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("SendDataToNiagara");
+		FBattleFrameStageScope StageScope(TEXT("SendDataToNiagara"));
+
+		FFilter Filter = FFilter::Make<FRenderBatchData>().Exclude<FDying>();
+
+		using FArrayLibrary = UNiagaraDataInterfaceArrayFunctionLibrary;
+		int64 UploadedBytes = 0;
+
+		Mechanism->Operate<FUnsafeChain>(Filter,
+			[&](FSubjectHandle Subject,
+				FRenderBatchData& Data)
+			{
+				// 发布打包数据的快照，数据接口在 Niagara 更新时取走
+				if (Data.CrowdBuffer.IsValid())
+				{
+					Data.CrowdBuffer->Commit();
+					UploadedBytes += Data.CrowdBuffer->GetData().Num() * sizeof(FVector4f);
+				}
+				else
+				{
+					if (Data.bQuantizeChanged)
+					{
+						Data.SpawnedNiagaraSystem->SetVariableVec3(TEXT("Quantize_Origin"), Data.QuantizeOrigin);
+						Data.SpawnedNiagaraSystem->SetVariableBool(TEXT("Quantize_Enabled"), Data.bQuantized);
+						Data.bQuantizeChanged = false;
+					}
+
+					// ------------------Transform---------------------------------
+
+					if (Data.bQuantized)
+					{
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::QuantizedLocationXY, FName("Quantized_LocationXY_Array"), Data.Quantized_LocationXY_Array, &FArrayLibrary::SetNiagaraArrayInt32);
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::QuantizedLocationZYaw, FName("Quantized_LocationZ_Yaw_Array"), Data.Quantized_LocationZ_Yaw_Array, &FArrayLibrary::SetNiagaraArrayInt32);
+					}
+					else
+					{
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::Location, FName("LocationArray"), Data.LocationArray, &FArrayLibrary::SetNiagaraArrayVector);
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::Orientation, FName("OrientationArray"), Data.OrientationArray, &FArrayLibrary::SetNiagaraArrayQuat);
+					}
+
+					UploadedBytes += UploadRenderChannel(Data, ERenderChannel::Scale, FName("ScaleArray"), Data.ScaleArray, &FArrayLibrary::SetNiagaraArrayVector);
+
+					// -----------------VAT Auto Play------------------------------
+
+					UploadedBytes += UploadRenderChannel(Data, ERenderChannel::AnimIndex, FName("Anim_Index0_Index1_PauseTime0_PauseTime1_Array"), Data.Anim_Index0_Index1_PauseTime0_PauseTime1_Array, &FArrayLibrary::SetNiagaraArrayVector4);
+					UploadedBytes += UploadRenderChannel(Data, ERenderChannel::AnimTime, FName("Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array"), Data.Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array, &FArrayLibrary::SetNiagaraArrayVector4);
+					UploadedBytes += UploadRenderChannel(Data, ERenderChannel::AnimLerp, FName("Anim_Lerp_Array"), Data.Anim_Lerp_Array, &FArrayLibrary::SetNiagaraArrayFloat);
+
+					// ------------------Material FX & HealthBar------------------
+
+					if (Data.bQuantized)
+					{
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::QuantizedMatFx, FName("Quantized_HitGlow_Freeze_Burn_Dissolve_Array"), Data.Quantized_HitGlow_Freeze_Burn_Dissolve_Array, &FArrayLibrary::SetNiagaraArrayInt32);
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::QuantizedHealthBar, FName("Quantized_HealthBar_Array"), Data.Quantized_HealthBar_Array, &FArrayLibrary::SetNiagaraArrayInt32);
+					}
+					else
+					{
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::MatFx, FName("Mat_HitGlow_Freeze_Burn_Dissolve_Array"), Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array, &FArrayLibrary::SetNiagaraArrayVector4);
+						UploadedBytes += UploadRenderChannel(Data, ERenderChannel::HealthBar, FName("HealthBar_Opacity_CurrentRatio_TargetRatio_Array"), Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array, &FArrayLibrary::SetNiagaraArrayVector);
+					}
+
+					// ------------------Others------------------------------------
+
+					UploadedBytes += UploadRenderChannel(Data, ERenderChannel::InsidePool, FName("InsidePool_Array"), Data.InsidePool_Array, &FArrayLibrary::SetNiagaraArrayBool);
+				}
+
+				// 当前模式不上传的通道也要清空改动
+				for (FRenderChannelState& Channel : Data.Channels)
+				{
+					Channel.bDirty = false;
+				}
+
+				// ------------------Pop Text----------------------------------
+
+				// 每帧重建，连续两帧为空时跳过
+				if (Data.Text_Location_Array.Num() > 0 || Data.TextUploadedNum != 0)
+				{
+					FArrayLibrary::SetNiagaraArrayVector(
+						Data.SpawnedNiagaraSystem,
+						FName("Text_Location_Array"),
+						Data.Text_Location_Array
+					);
+
+					FArrayLibrary::SetNiagaraArrayVector4(
+						Data.SpawnedNiagaraSystem,
+						FName("Text_Value_Style_Scale_Offset_Array"),
+						Data.Text_Value_Style_Scale_Offset_Array
+					);
+
+					Data.TextUploadedNum = Data.Text_Location_Array.Num();
+					UploadedBytes += Data.Text_Location_Array.Num() * GetNiagaraElementSize<FVector>() + Data.Text_Value_Style_Scale_Offset_Array.Num() * GetNiagaraElementSize<FVector4>();
+				}
+
+				// ------------------Active HealthBar--------------------------
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FRendering& Rendering,
-				FDirected& Directed,
-				FScaled& Scaled,
-				FLocated& Located,
-				FAnimation& Anim,
-				FHealth& Health,
-				FHealthBar& HealthBar,
-				FCollider& Collider)
-			{
-				if (!Rendering.Renderer.IsValid())
+				if (Data.ActiveHealthBar_Location_Array.Num() > 0 || Data.ActiveHealthBarUploadedNum != 0)
 				{
-					// 标记为死亡
-					Subject.SetTraitDeferred(FDying{});
-					return;
+					FArrayLibrary::SetNiagaraArrayVector(
+						Data.SpawnedNiagaraSystem,
+						FName("ActiveHealthBar_Location_Array"),
+						Data.ActiveHealthBar_Location_Array
+					);
+
+					FArrayLibrary::SetNiagaraArrayVector(
+						Data.SpawnedNiagaraSystem,
+						FName("ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array"),
+						Data.ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array
+					);
+
+					Data.ActiveHealthBarUploadedNum = Data.ActiveHealthBar_Location_Array.Num();
+					UploadedBytes += Data.ActiveHealthBar_Location_Array.Num() * GetNiagaraElementSize<FVector>() * 2;
 				}
 
-				FRenderBatchData& Data = Rendering.Renderer.GetTraitRef<FRenderBatchData, EParadigm::Unsafe>();
+			});
 
-				FQuat Rotation{ FQuat::Identity };
-				Rotation = Directed.Direction.Rotation().Quaternion();
+		SET_DWORD_STAT(STAT_BattleFrameNiagaraUploadBytes, UploadedBytes);
+		TRACE_COUNTER_SET(BattleFrame_NiagaraUploadBytes, UploadedBytes);
+	}
+	#pragma endregion
+}
 
-				FVector FinalScale(Data.Scale);
-				FinalScale *= Scaled.renderFactors;
+void ABattleFrameGameMode::WriteCrowdSnapshot()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("WriteCrowdSnapshot");
+	FBattleFrameStageScope StageScope(TEXT("WriteCrowdSnapshot"));
 
-				float Radius = Collider.Radius;
+	FBattleFrameCrowdSnapshot& Snapshot = CrowdSnapshots[FrontSnapshot ^ 1];
+	Snapshot.SimulationTime = SimulationTime;
+	Snapshot.Agents.Reset();
 
-				// 在计算转换时减去Radius
-				FTransform SubjectTransform( Rotation * Data.OffsetRotation.Quaternion(),Located.Location + Data.OffsetLocation - FVector(0, 0, Radius), FinalScale); // 减去Z轴上的Radius					
+	if (!bWriteCrowdSnapshot) return;
 
-				int32 InstanceId = Rendering.InstanceId;
+	FFilter Filter = FFilter::Make<FAgent, FLocated, FHealth>().Exclude<FDying>();
 
-				Data.Lock();
+	auto Chain = Mechanism->EnchainSolid(Filter);
+	const int32 MaxNum = Chain->IterableNum();
+	StageScope.CalculateThreadsCountAndBatchSize(MaxNum, MaxThreadsAllowed, ThreadsCount, BatchSize);
 
-				Data.ValidTransforms[InstanceId] = true;
-				Data.Transforms[InstanceId] = SubjectTransform;
+	// IterableNum 是上限，按实际写入数量收缩
+	Snapshot.Agents.SetNum(MaxNum, false);
+	std::atomic<int32> AgentsNum = 0;
 
-				// Transforms
-				Data.LocationArray[InstanceId] = SubjectTransform.GetLocation();
-				Data.OrientationArray[InstanceId] = SubjectTransform.GetRotation();
-				Data.ScaleArray[InstanceId] = SubjectTransform.GetScale3D();
+	Chain->OperateConcurrently(
+		[&](FSolidSubjectHandle Subject,
+			FLocated& Located,
+			FHealth& Health)
+		{
+			const int32 Index = AgentsNum.fetch_add(1, std::memory_order_relaxed);
 
-				// Dynamic params 0
-				Data.Anim_Index0_Index1_PauseTime0_PauseTime1_Array[InstanceId] = FVector4(Anim.AnimIndex0,Anim.AnimIndex1,Anim.AnimPauseTime0,Anim.AnimPauseTime1);
+			if (Index >= MaxNum) return;
 
-				// Dynamic params 1
-				Data.Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array[InstanceId] = FVector4(Anim.AnimCurrentTime0 + Anim.AnimOffsetTime0, Anim.AnimCurrentTime1 + Anim.AnimOffsetTime1, Anim.AnimPlayRate0, Anim.AnimPlayRate1);
+			FBattleFrameAgentSnapshot& Agent = Snapshot.Agents[Index];
+			Agent.Subject = FSubjectHandle{ Subject };
+			Agent.Location = Located.Location;
+			Agent.Health = Health.Current;
+			Agent.MaxHealth = Health.Maximum;
 
-				// Pariticle color R
-				Data.Anim_Lerp_Array[InstanceId] = Anim.AnimLerp;
+		}, ThreadsCount, BatchSize);
 
-				// Dynamic params 2
-				Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array[InstanceId] = FVector4(Anim.HitGlow, Anim.FreezeFx, Anim.BurnFx, Anim.Dissolve);
+	Snapshot.Agents.SetNum(FMath::Min(AgentsNum.load(std::memory_order_relaxed), MaxNum), false);
+}
 
-				// HealthBar
-				Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array[InstanceId] = FVector(HealthBar.Opacity, HealthBar.CurrentRatio, HealthBar.TargetRatio);
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-				Data.Unlock();
+FResult ABattleFrameGameMode::ApplyDamageToSubjects(const TArray<FSubjectHandle>& Subjects, const TArray<FSubjectHandle>& IgnoreSubjects, FSubjectHandle DmgInstigator, FVector HitFromLocation, const FDmgSphere& DmgSphere, const FDebuff& Debuff)
+{
+	FResult Result;
+	ApplyDamageBatch(Subjects, IgnoreSubjects, DmgInstigator, HitFromLocation, DmgSphere, Debuff, Result);
+	return Result;
+}
 
-			}, ThreadsCount, BatchSize);
-	}
-	#pragma endregion
+void ABattleFrameGameMode::ApplyDamageBatch(TArrayView<const FSubjectHandle> Subjects, TArrayView<const FSubjectHandle> IgnoreSubjects, const FSubjectHandle& DmgInstigator, const FVector& HitFromLocation, const FDmgSphere& DmgSphere, const FDebuff& Debuff, FResult& OutResult)
+{
+	//TRACE_CPUPROFILER_EVENT_SCOPE_STR("ApplyDamageBatch");
 
-	#pragma region
-	{
-		FFilter Filter = FFilter::Make<FAgent, FRendering, FPoppingText>();
+	WaitForCrowdSimulation();
 
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+	// 忽略列表与已处理的目标放进同一个集合，查找为常数时间
+	TSet<FSubjectHandle, DefaultKeyFuncs<FSubjectHandle>, TInlineSetAllocator<64>> VisitedHandles;
+	VisitedHandles.Reserve(Subjects.Num() + IgnoreSubjects.Num());
+	VisitedHandles.Append(IgnoreSubjects);
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FRendering Rendering,
-				FPoppingText PoppingText)
-			{
-				FRenderBatchData& Data = Rendering.Renderer.GetTraitRef<FRenderBatchData, EParadigm::Unsafe>();
+	OutResult.DamagedSubjects.Reserve(OutResult.DamagedSubjects.Num() + Subjects.Num());
+	OutResult.IsCritical.Reserve(OutResult.IsCritical.Num() + Subjects.Num());
+	OutResult.IsKill.Reserve(OutResult.IsKill.Num() + Subjects.Num());
+	OutResult.DmgDealt.Reserve(OutResult.DmgDealt.Num() + Subjects.Num());
 
-				TArray<FVector> LocationArray = PoppingText.TextLocationArray;
-				TArray<FVector4> CombinedArray = PoppingText.Text_Value_Style_Scale_Offset_Array;
+	for (const FSubjectHandle& Overlapper : Subjects)
+	{
+		bool bAlreadyVisited = false;
+		VisitedHandles.Add(Overlapper, &bAlreadyVisited);
 
-				Data.Lock();
-				Data.Text_Location_Array.Append(LocationArray);
-				Data.Text_Value_Style_Scale_Offset_Array.Append(CombinedArray);
-				Data.Unlock();
+		if (bAlreadyVisited) continue;
 
-				Subject.RemoveTraitDeferred<FPoppingText>();
+		bool bIsCrit = false;
+		bool bIsKill = false;
+		float DmgDealt = 0.f;
 
-			}, ThreadsCount, BatchSize);
+		const uint32 HitIndex = NextHitIndex(Overlapper, DmgInstigator, HitFromLocation, DmgSphere);
 
-		Mechanism->ApplyDeferreds();
+		if (ApplyDamageToSubject(Overlapper, DmgInstigator, HitFromLocation, DmgSphere, Debuff, HitIndex, bIsCrit, bIsKill, DmgDealt))
+		{
+			OutResult.DamagedSubjects.Add(Overlapper);
+			OutResult.IsCritical.Add(bIsCrit);
+			OutResult.IsKill.Add(bIsKill);
+			OutResult.DmgDealt.Add(DmgDealt);
+		}
 	}
-	#pragma endregion
+}
 
-	// Write Pooling Info
-	#pragma region
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Write Pooling Info");
+void ABattleFrameGameMode::ApplyDamagePairs(TArrayView<const FBattleFrameDamagePair> Pairs, FResult* OutResult)
+{
+	//TRACE_CPUPROFILER_EVENT_SCOPE_STR("ApplyDamagePairs");
 
-		FFilter Filter = FFilter::Make<FRenderBatchData>().Exclude<FDying>();
+	WaitForCrowdSimulation();
 
-		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+	const int32 PairsNum = Pairs.Num();
 
-		Chain->OperateConcurrently(
-			[&](FSolidSubjectHandle Subject,
-				FRenderBatchData& Data)
-			{
-				// 重置和隐藏限制数组成员
-				Data.FreeTransforms.Reset();
+	if (PairsNum == 0) return;
 
-				for (int32 i = Data.ValidTransforms.IndexOf(false);
-					i < Data.Transforms.Num();
-					i = Data.ValidTransforms.IndexOf(false, i + 1))
-				{
-					Data.FreeTransforms.Add(i);
-					Data.InsidePool_Array[i] = true;
-				}
+	// 每个请求写自己的槽位，最后按请求顺序压缩
+	TArray<bool> Applied;
+	TArray<bool> IsCritical;
+	TArray<bool> IsKill;
+	TArray<float> DmgDealt;
 
-			}, ThreadsCount, BatchSize);
+	if (OutResult)
+	{
+		Applied.SetNumZeroed(PairsNum);
+		IsCritical.SetNumZeroed(PairsNum);
+		IsKill.SetNumZeroed(PairsNum);
+		DmgDealt.SetNumZeroed(PairsNum);
 	}
-	#pragma endregion
 
-	// 同步至Niagara
-	#pragma region
+	// 命中序号在并行前按请求顺序分配
+	TArray<uint32> HitIndexes;
+	HitIndexes.SetNumUninitialized(PairsNum);
+
+	for (int32 i = 0; i < PairsNum; ++i)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("SendDataToNiagara");
+		HitIndexes[i] = NextHitIndex(Pairs[i].Target, Pairs[i].Instigator, Pairs[i].HitFromLocation, Pairs[i].DmgSphere);
+	}
 
-		FFilter Filter = FFilter::Make<FRenderBatchData>().Exclude<FDying>();
+	// 工作线程上的延迟操作计入调用方的阶段
+	FBattleFrameStageScope* StageScope = FBattleFrameStageScope::GetCurrent();
 
-		Mechanism->Operate<FUnsafeChain>(Filter,
-			[&](FSubjectHandle Subject,
-				FRenderBatchData& Data)
+	ParallelFor(TEXT("ApplyDamagePairs"), PairsNum, 16,
+		[&](int32 Index)
+		{
+			FBattleFrameStageScope::FWorkerBinding Binding(StageScope);
+			const FBattleFrameDamagePair& Pair = Pairs[Index];
+
+			bool bIsCrit = false;
+			bool bIsKill = false;
+			float Dealt = 0.f;
+
+			const bool bApplied = ApplyDamageToSubject(Pair.Target, Pair.Instigator, Pair.HitFromLocation, Pair.DmgSphere, Pair.Debuff, HitIndexes[Index], bIsCrit, bIsKill, Dealt);
+
+			if (OutResult)
 			{
-				// ------------------Transform---------------------------------
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(
-					Data.SpawnedNiagaraSystem,
-					FName("LocationArray"),
-					Data.LocationArray
-				);
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayQuat(
-					Data.SpawnedNiagaraSystem,
-					FName("OrientationArray"),
-					Data.OrientationArray
-				);
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(
-					Data.SpawnedNiagaraSystem,
-					FName("ScaleArray"),
-					Data.ScaleArray
-				);
-
-				// -----------------VAT Auto Play------------------------------
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector4(
-					Data.SpawnedNiagaraSystem,
-					FName("Anim_Index0_Index1_PauseTime0_PauseTime1_Array"),
-					Data.Anim_Index0_Index1_PauseTime0_PauseTime1_Array
-				);
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector4(
-					Data.SpawnedNiagaraSystem,
-					FName("Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array"),
-					Data.Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array
-				);
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayFloat(
-					Data.SpawnedNiagaraSystem,
-					FName("Anim_Lerp_Array"),
-					Data.Anim_Lerp_Array
-				);
-
-				// ------------------Material FX---------------------------
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector4(
-					Data.SpawnedNiagaraSystem,
-					FName("Mat_HitGlow_Freeze_Burn_Dissolve_Array"),
-					Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array
-				);
-
-				// ------------------HealthBar---------------------------------
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(
-					Data.SpawnedNiagaraSystem,
-					FName("HealthBar_Opacity_CurrentRatio_TargetRatio_Array"),
-					Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array
-				);
+				Applied[Index] = bApplied;
+				IsCritical[Index] = bIsCrit;
+				IsKill[Index] = bIsKill;
+				DmgDealt[Index] = Dealt;
+			}
+		});
 
-				// ------------------Pop Text----------------------------------
+	if (!OutResult) return;
 
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(
-					Data.SpawnedNiagaraSystem,
-					FName("Text_Location_Array"),
-					Data.Text_Location_Array
-				);
-
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector4(
-					Data.SpawnedNiagaraSystem,
-					FName("Text_Value_Style_Scale_Offset_Array"),
-					Data.Text_Value_Style_Scale_Offset_Array
-				);
-				
-				// ------------------Others------------------------------------
+	for (int32 i = 0; i < PairsNum; ++i)
+	{
+		if (!Applied[i]) continue;
 
-				UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayBool(
-					Data.SpawnedNiagaraSystem,
-					FName("InsidePool_Array"),
-					Data.InsidePool_Array
-				);
-			});
+		OutResult->DamagedSubjects.Add(Pairs[i].Target);
+		OutResult->IsCritical.Add(IsCritical[i]);
+		OutResult->IsKill.Add(IsKill[i]);
+		OutResult->DmgDealt.Add(DmgDealt[i]);
 	}
-	#pragma endregion
+}
 
+void ABattleFrameGameMode::ApplyQueuedDamagePairs()
+{
+	DamagePairs.ConsumeTo(QueuedDamagePairs);
+	ApplyDamagePairs(QueuedDamagePairs);
+	QueuedDamagePairs.Reset();
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32 ABattleFrameGameMode::NextHitIndex(const FSubjectHandle& Overlapper, const FSubjectHandle& DmgInstigator, const FVector& HitFromLocation, const FDmgSphere& DmgSphere)
+{
+	// 完全相同的命中在本帧内依次编号，序号只与同类命中的先后有关
+	return HitIndices.FindOrAdd(FBattleFrameRandom::HitKey(DmgInstigator, Overlapper, HitFromLocation, HashDmgSphere(DmgSphere), 0))++;
+}
 
-FResult ABattleFrameGameMode::ApplyDamageToSubjects(const TArray<FSubjectHandle> Subjects, const TArray<FSubjectHandle> IgnoreSubjects, FSubjectHandle DmgInstigator, FVector HitFromLocation, const FDmgSphere DmgSphere, const FDebuff Debuff)
+bool ABattleFrameGameMode::ApplyDamageToSubject(const FSubjectHandle& Overlapper, const FSubjectHandle& DmgInstigator, const FVector& HitFromLocation, const FDmgSphere& DmgSphere, const FDebuff& Debuff, uint32 HitIndex, bool& bOutCritical, bool& bOutKill, float& OutDmgDealt)
 {
-	//TRACE_CPUPROFILER_EVENT_SCOPE_STR("ApplyDamageToSubjects");
+	if (!Overlapper.HasTrait<FHealth>()) return false;
 
-	// Record for deferred spawning of TemporalDamager
-	FTemporalDamaging TemporalDamaging;
+	bool bHasLocated = Overlapper.HasTrait<FLocated>();
 
-	// 添加一个数组来存储唯一的敌人句柄
-	TSet<FSubjectHandle> UniqueHandles;
+	//-------------伤害和抗性------------
 
-	FResult Result;
+	float NormalDmgMult = 1;
+	float KineticDmgMult = 1;
+	float KineticDebuffMult = 1;
+	float FireDmgMult = 1;
+	float FireDebuffMult = 1;
+	float IceDmgMult = 1;
+	float IceDebuffMult = 1;
+	float PercentDmgMult = 1;
 
-	for (const auto& Overlapper : Subjects)
+	// 抗性 如果有的话
+	if (Overlapper.HasTrait<FDefence>())
 	{
-		if (IgnoreSubjects.Contains(Overlapper)) continue;
+		const auto& Defence = Overlapper.GetTraitRef<FDefence, EParadigm::Unsafe>();
+
+		NormalDmgMult = 1 - Defence.NormalDmgImmune;
+		KineticDmgMult = 1 - Defence.KineticDmgImmune;
+		KineticDebuffMult = 1 - Defence.KineticDebuffImmune;
+		FireDmgMult = 1 - Defence.FireDmgImmune;
+		FireDebuffMult = 1 - Defence.FireDebuffImmune;
+		IceDmgMult = 1 - Defence.IceDmgImmune;
+		IceDebuffMult = 1 - Defence.IceDebuffImmune;
+		PercentDmgMult = 1.f - Defence.PercentDmgImmune;
+	}
 
-		int32 previousNum = UniqueHandles.Num();
-		UniqueHandles.Add(Overlapper);
+	float NormalDamage = DmgSphere.Damage * NormalDmgMult;
+	float KineticDamage = DmgSphere.KineticDmg * KineticDmgMult;
+	float FireDamage = DmgSphere.FireDmg * FireDmgMult;
+	float IceDamage = DmgSphere.IceDmg * IceDmgMult;
 
-		if (UniqueHandles.Num() == previousNum) continue;
+	// 总基础伤害
+	float BaseDamage = NormalDamage + KineticDamage + FireDamage + IceDamage;
 
-		if (Overlapper.HasTrait<FHealth>())
-		{
-			bool bHasLocated = Overlapper.HasTrait<FLocated>();
+	// 百分比伤害
+	auto& Health = Overlapper.GetTraitRef<FHealth, EParadigm::Unsafe>();
+	float PercentageDamage = Health.Maximum * DmgSphere.PercentDmg * PercentDmgMult;
 
-			//-------------伤害和抗性------------
+	// 总伤害
+	float CombinedDamage = BaseDamage + PercentageDamage;
 
-			float NormalDmgMult = 1;
-			float KineticDmgMult = 1;
-			float KineticDebuffMult = 1;
-			float FireDmgMult = 1;
-			float FireDebuffMult = 1;
-			float IceDmgMult = 1;
-			float IceDebuffMult = 1;
-			float PercentDmgMult = 1;
+	// 考虑暴击后伤害
+	// 暴击键只取决于命中本身与其在本帧同类命中中的序号，与线程调度无关
+	auto [bIsCrit, PostCritDamage] = ProcessCritDamage(CombinedDamage, DmgSphere.CritMult, DmgSphere.CritProbability, FBattleFrameRandom::HitKey(DmgInstigator, Overlapper, HitFromLocation, HashDmgSphere(DmgSphere), HitIndex));
 
-			// 抗性 如果有的话
-			if (Overlapper.HasTrait<FDefence>())
-			{
-				const auto& Defence = Overlapper.GetTraitRef<FDefence, EParadigm::Unsafe>();
-
-				NormalDmgMult = 1 - Defence.NormalDmgImmune;
-				KineticDmgMult = 1 - Defence.KineticDmgImmune;
-				KineticDebuffMult = 1 - Defence.KineticDebuffImmune;
-				FireDmgMult = 1 - Defence.FireDmgImmune;
-				FireDebuffMult = 1 - Defence.FireDebuffImmune;
-				IceDmgMult = 1 - Defence.IceDmgImmune;
-				IceDebuffMult = 1 - Defence.IceDebuffImmune;
-				PercentDmgMult = 1.f - Defence.PercentDmgImmune;
-			}
+	// 限制伤害以不大于剩余血量
+	float ClampedDamage = FMath::Min(PostCritDamage, Health.Current);
 
-			float NormalDamage = DmgSphere.Damage * NormalDmgMult;
-			float KineticDamage = DmgSphere.KineticDmg * KineticDmgMult;
-			float FireDamage = DmgSphere.FireDmg * FireDmgMult;
-			float IceDamage = DmgSphere.IceDmg * IceDmgMult;
+	bOutCritical = bIsCrit;
+	bOutKill = Health.Current == ClampedDamage;
+	OutDmgDealt = ClampedDamage;
 
-			// 总基础伤害
-			float BaseDamage = NormalDamage + KineticDamage + FireDamage + IceDamage;
+	// 占比最大的伤害类型
+	EBattleFrameDamageType DamageType = EBattleFrameDamageType::Normal;
+	float DominantDamage = NormalDamage;
 
-			// 百分比伤害
-			auto& Health = Overlapper.GetTraitRef<FHealth, EParadigm::Unsafe>();
-			float PercentageDamage = Health.Maximum * DmgSphere.PercentDmg * PercentDmgMult;
+	const TPair<EBattleFrameDamageType, float> DamageParts[] =
+	{
+		{ EBattleFrameDamageType::Kinetic, KineticDamage },
+		{ EBattleFrameDamageType::Fire, FireDamage },
+		{ EBattleFrameDamageType::Ice, IceDamage },
+		{ EBattleFrameDamageType::Percent, PercentageDamage }
+	};
 
-			// 总伤害
-			float CombinedDamage = BaseDamage + PercentageDamage;
+	for (const auto& Part : DamageParts)
+	{
+		if (Part.Value > DominantDamage)
+		{
+			DamageType = Part.Key;
+			DominantDamage = Part.Value;
+		}
+	}
 
-			// 考虑暴击后伤害
-			auto [bIsCrit, PostCritDamage] = ProcessCritDamage(CombinedDamage, DmgSphere.CritMult, DmgSphere.CritProbability);
+	// 应用伤害并记录施加者
+	QueueDamage(Overlapper, DmgInstigator.IsValid() ? DmgInstigator : FSubjectHandle(), ClampedDamage, bIsCrit ? EBattleFrameDamageFlags::Critical : EBattleFrameDamageFlags::None, DamageType);
 
-			// 限制伤害以不大于剩余血量
-			float ClampedDamage = FMath::Min(PostCritDamage, Health.Current);
+	// ------------生成文字--------------
 
-			Result.DamagedSubjects.Add(Overlapper);
-			Result.IsCritical.Add(bIsCrit);
-			Result.IsKill.Add(Health.Current == ClampedDamage);
-			Result.DmgDealt.Add(ClampedDamage);
+	if (Overlapper.HasTrait<FTextPopUp>() && bHasLocated)
+	{
+		const auto TextPopUp = Overlapper.GetTrait<FTextPopUp>();
 
-			// 应用伤害
-			Health.DamageToTake.Enqueue(ClampedDamage);
+		if (TextPopUp.Enable)
+		{
+			float Style = 0;
+			float Radius = 0.f;
+			FVector Location = Overlapper.GetTrait<FLocated>().Location;
 
-			// 记录伤害施加者
-			if (DmgInstigator.IsValid())
+			if (!bIsCrit)
 			{
-				Health.DamageInstigator.Enqueue(DmgInstigator);
+				if (PostCritDamage < TextPopUp.WhiteTextBelowPercent)
+				{
+					Style = 0;
+				}
+				else if (PostCritDamage < TextPopUp.OrangeTextAbovePercent)
+				{
+					Style = 1;
+				}
+				else
+				{
+					Style = 2;
+				}
 			}
 			else
 			{
-				Health.DamageInstigator.Enqueue(FSubjectHandle());
+				Style = 3;
 			}
 
-			// ------------生成文字--------------
-
-			if (Overlapper.HasTrait<FTextPopUp>() && bHasLocated)
+			if (Overlapper.HasTrait<FCollider>())
 			{
-				const auto TextPopUp = Overlapper.GetTrait<FTextPopUp>();
+				Radius = Overlapper.GetTrait<FCollider>().Radius;
+			}
 
-				if (TextPopUp.Enable)
-				{
-					float Style = 0;
-					float Radius = 0.f;
-					FVector Location = Overlapper.GetTrait<FLocated>().Location;
+			Location += FVector(0, 0, Radius);
 
-					if (!bIsCrit)
-					{
-						if (PostCritDamage < TextPopUp.WhiteTextBelowPercent)
-						{
-							Style = 0;
-						}
-						else if (PostCritDamage < TextPopUp.OrangeTextAbovePercent)
-						{
-							Style = 1;
-						}
-						else
-						{
-							Style = 2;
-						}
-					}
-					else
-					{
-						Style = 3;
-					}
+			QueueText(Overlapper, PostCritDamage, Style, TextPopUp.TextScale, Radius * 1.1, Location, bOutKill);
+		}
+	}
 
-					if (Overlapper.HasTrait<FCollider>())
-					{
-						Radius = Overlapper.GetTrait<FCollider>().Radius;
-					}
+	//--------------Debuff--------------
 
-					Location += FVector(0, 0, Radius);
+	FVector HitDirection = FVector::ZeroVector;
 
-					QueueText(Overlapper, PostCritDamage, Style, TextPopUp.TextScale, Radius * 1.1, Location);
-				}
-			}
+	if (bHasLocated)
+	{
+		HitDirection = (Overlapper.GetTrait<FLocated>().Location - HitFromLocation).GetSafeNormal2D();
+	}
 
-			//--------------Debuff--------------
+	// 击退
+	if (Debuff.bCanKnockback)
+	{
+		if (Overlapper.HasTrait<FMove>() && Overlapper.HasTrait<FMoving>())
+		{
+			auto& Moving = Overlapper.GetTraitRef<FMoving, EParadigm::Unsafe>();
+			const auto& Move = Overlapper.GetTraitRef<FMove, EParadigm::Unsafe>();
+			FVector KnockbackForce = Debuff.KnockbackSpeed * HitDirection * KineticDebuffMult;
+			FVector CombinedForce = Moving.KnockBackForce + KnockbackForce;
+			FVector CombinedDirection = CombinedForce.GetSafeNormal2D();
+			float CombinedSize = FMath::Clamp(CombinedForce.Size2D(), 0, Move.MaxImpulse);
+
+			Moving.Lock();
+			Moving.KnockBackForce = CombinedDirection * CombinedSize; // 累加击退力
+			Moving.Unlock();
+
+			if (Moving.KnockBackForce.Size2D() > 100.f)
+			{
+				Moving.bKnockedBack = true;
+			}
+		}
+	}
 
-			FVector HitDirection = FVector::ZeroVector;
+	// 冰冻
+	if (Debuff.bCanSlow)
+	{
+		if (Overlapper.HasTrait<FFreezing>())
+		{
+			auto& CurrentFreezing = Overlapper.GetTraitRef<FFreezing, EParadigm::Unsafe>();
 
-			if (bHasLocated)
+			// 延长冰冻，旧的计时到期时会被忽略
+			if (SimulationTime + Debuff.SlowTime > CurrentFreezing.EndTime)
 			{
-				HitDirection = (Overlapper.GetTrait<FLocated>().Location - HitFromLocation).GetSafeNormal2D();
+				CurrentFreezing.SlowTimeout = Debuff.SlowTime;
+				CurrentFreezing.EndTime = SimulationTime + Debuff.SlowTime;
+				ScheduleTimer(Overlapper, EBattleFrameTimer::FreezeEnd, Debuff.SlowTime);
 			}
+		}
+		else
+		{
+			FFreezing NewFreezing;
+			NewFreezing.SlowTimeout = Debuff.SlowTime * IceDebuffMult;
+			NewFreezing.SlowStr = Debuff.SlowStr * IceDebuffMult;
+			NewFreezing.EndTime = SimulationTime + NewFreezing.SlowTimeout;
 
-			// 击退
-			if (Debuff.bCanKnockback)
+			if (NewFreezing.SlowTimeout > 0 && NewFreezing.SlowStr > 0)
 			{
-				if (Overlapper.HasTrait<FMove>() && Overlapper.HasTrait<FMoving>())
+				if (Overlapper.HasTrait<FAnimation>())
 				{
-					auto& Moving = Overlapper.GetTraitRef<FMoving, EParadigm::Unsafe>();
-					const auto& Move = Overlapper.GetTraitRef<FMove, EParadigm::Unsafe>();
-					FVector KnockbackForce = Debuff.KnockbackSpeed * HitDirection * KineticDebuffMult;
-					FVector CombinedForce = Moving.KnockBackForce + KnockbackForce;
-					FVector CombinedDirection = CombinedForce.GetSafeNormal2D();
-					float CombinedSize = FMath::Clamp(CombinedForce.Size2D(), 0, Move.MaxImpulse);
-
-					Moving.Lock();
-					Moving.KnockBackForce = CombinedDirection * CombinedSize; // 累加击退力
-					Moving.Unlock();
-
-					if (Moving.KnockBackForce.Size2D() > 100.f)
-					{
-						Moving.bKnockedBack = true;
-					}
+					auto& Animation = Overlapper.GetTraitRef<FAnimation, EParadigm::Unsafe>();
+					Animation.PreviousSubjectState = ESubjectState::Dirty; // 强制刷新动画状态机
+					Animation.FreezeFx = 1;
 				}
+				Overlapper.SetTraitDeferred(NewFreezing);
+				FBattleFrameStageScope::CountDeferred();
+				ScheduleTimer(Overlapper, EBattleFrameTimer::FreezeEnd, NewFreezing.SlowTimeout);
 			}
+		}
+	}
+
+	// 灼烧
+	if (Debuff.bCanTemporalDmg)
+	{
+		const float TotalTemporalDamage = BaseDamage * Debuff.TemporalDmgPercent * FireDebuffMult;
 
-			// 冰冻
-			if (Debuff.bCanSlow)
+		if (TotalTemporalDamage > 0)
+		{
+			FBurnStack Stack;
+			Stack.Instigator = DmgInstigator.IsValid() ? DmgInstigator : FSubjectHandle();
+			Stack.DamagePerTick = TotalTemporalDamage / FBurning::TicksPerApplication;
+			Stack.TicksLeft = FBurning::TicksPerApplication;
+
+			if (FBurning* Burning = Overlapper.GetTraitPtr<FBurning, EParadigm::Unsafe>())
 			{
-				if (Overlapper.HasTrait<FFreezing>())
-				{
-					auto& CurrentFreezing = Overlapper.GetTraitRef<FFreezing, EParadigm::Unsafe>();
+				Burning->Lock();
 
-					if (Debuff.SlowTime > CurrentFreezing.SlowTimeout)
-					{
-						CurrentFreezing.SlowTimeout = Debuff.SlowTime;
-					}
-				}
-				else
+				// 由空变为燃烧中才开始计时，之后由灼烧阶段续期
+				if (Burning->AddStack(Stack, Debuff.TemporalDmgStacking))
 				{
-					FFreezing NewFreezing;
-					NewFreezing.SlowTimeout = Debuff.SlowTime * IceDebuffMult;
-					NewFreezing.SlowStr = Debuff.SlowStr * IceDebuffMult;
-
-					if (NewFreezing.SlowTimeout > 0 && NewFreezing.SlowStr > 0)
-					{
-						if (Overlapper.HasTrait<FAnimation>())
-						{
-							auto& Animation = Overlapper.GetTraitRef<FAnimation, EParadigm::Unsafe>();
-							Animation.PreviousSubjectState = ESubjectState::Dirty; // 强制刷新动画状态机
-							Animation.FreezeFx = 1;
-						}
-						Overlapper.SetTraitDeferred(NewFreezing);
-					}
+					Burning->NextTickTime = SimulationTime + FBurning::TickInterval;
+					ScheduleTimer(Overlapper, EBattleFrameTimer::Burn, FBurning::TickInterval);
 				}
-			}
 
-			// 灼烧
-			if (Debuff.bCanTemporalDmg)
+				Burning->Unlock();
+			}
+			else
 			{
-				TemporalDamaging.TotalTemporalDamage = BaseDamage * Debuff.TemporalDmgPercent * FireDebuffMult;
+				// 没有灼烧组件的个体延迟添加，同一帧内的多次命中以最后一次为准
+				FBurning NewBurning;
+				NewBurning.AddStack(Stack, Debuff.TemporalDmgStacking);
+				NewBurning.NextTickTime = SimulationTime + FBurning::TickInterval;
+				Overlapper.SetTraitDeferred(NewBurning);
+				FBattleFrameStageScope::CountDeferred();
+				ScheduleTimer(Overlapper, EBattleFrameTimer::Burn, FBurning::TickInterval);
+			}
+		}
+	}
 
-				if (TemporalDamaging.TotalTemporalDamage > 0)
-				{
-					TemporalDamaging.RemainingTemporalDamage = TemporalDamaging.TotalTemporalDamage;
+	//-----------其它效果------------
 
-					if (DmgInstigator.IsValid())
-					{
-						TemporalDamaging.TemporalDamageInstigator = DmgInstigator;
-					}
-					else
-					{
-						TemporalDamaging.TemporalDamageInstigator = FSubjectHandle();
-					}
+	if (Overlapper.HasTrait<FHit>())
+	{
+		const auto& Hit = Overlapper.GetTraitRef<FHit, EParadigm::Unsafe>();
 
-					TemporalDamaging.TemporalDamageTarget = Overlapper;
+		// 闪白
+		if (Hit.bCanGlow)
+		{
+			Overlapper.SetTraitDeferred(FHitGlow{});
+			FBattleFrameStageScope::CountDeferred();
+		}
 
-					Mechanism->SpawnSubject(TemporalDamaging);
-				}
-			}
+		// 形变
+		if (Hit.SqueezeSquashStr != 0.f)
+		{
+			Overlapper.SetTraitDeferred(FSqueezeSquash{});
+			FBattleFrameStageScope::CountDeferred();
+		}
 
-			//-----------其它效果------------
+		// Fx
+		if (Overlapper.HasTrait<FFX>())
+		{
+			const auto& FX = Overlapper.GetTraitRef<FFX, EParadigm::Unsafe>();
 
-			if (Overlapper.HasTrait<FHit>())
+			if (Hit.bCanSpawnFx && FX.HitFx.SubType != ESubType::None)
 			{
-				const auto& Hit = Overlapper.GetTraitRef<FHit, EParadigm::Unsafe>();
-
-				// 闪白
-				if (Hit.bCanGlow)
-				{
-					Overlapper.SetTraitDeferred(FHitGlow{});
-				}
-
-				// 形变
-				if (Hit.SqueezeSquashStr != 0.f)
-				{
-					Overlapper.SetTraitDeferred(FSqueezeSquash{});
-				}
-
-				// Fx
-				if (Overlapper.HasTrait<FFX>())
+				FRotator CombinedRotator = (FQuat(FX.HitFx.Transform.GetRotation()) * FQuat(HitDirection.Rotation())).Rotator();
+				if (QueueFx(FSubjectHandle{ Overlapper }, FTransform(CombinedRotator, FX.HitFx.Transform.GetLocation(), FX.HitFx.Transform.GetScale3D()), FX.HitFx.SubType, EBattleFrameFxCategory::Hit, DmgInstigator, bIsCrit, bOutKill))
 				{
-					const auto& FX = Overlapper.GetTraitRef<FFX, EParadigm::Unsafe>();
-
-					if (Hit.bCanSpawnFx && FX.HitFx.SubType != ESubType::None)
-					{
-						FRotator CombinedRotator = (FQuat(FX.HitFx.Transform.GetRotation()) * FQuat(HitDirection.Rotation())).Rotator();
-						QueueFx(FSubjectHandle{ Overlapper }, FTransform(CombinedRotator, FX.HitFx.Transform.GetLocation(), FX.HitFx.Transform.GetScale3D()), FX.HitFx.SubType);
-					}
+					FBattleFrameStageScope::CountDeferred();
 				}
+			}
+		}
 
-				// Sound
-				if (Overlapper.HasTrait<FSound>())
-				{
-					const auto& Sound = Overlapper.GetTraitRef<FSound, EParadigm::Unsafe>();
+		// Sound
+		if (Overlapper.HasTrait<FSound>())
+		{
+			const auto& Sound = Overlapper.GetTraitRef<FSound, EParadigm::Unsafe>();
 
-					if (Hit.bCanPlaySound && Sound.HitSound)
-					{
-						float Probability = Sound.bUseProbability ? RangeMapProbability(BeingHitAgentCount, Sound.HitSoundProbability) : 100.1;
-						QueueSound(Sound.HitSound, Probability);
-					}
-				}
+			if (Hit.bCanPlaySound && Sound.HitSound)
+			{
+				float Probability = Sound.bUseProbability ? RangeMapProbability(BeingHitAgentCount, Sound.HitSoundProbability) : 100.1;
+				QueueSound(Sound.HitSound, Probability, Overlapper);
 			}
 		}
 	}
 
-	return Result;
+	return true;
 }
 
 // 计算实际伤害，并返回一个pair，第一个元素是是否暴击，第二个元素是实际伤害
-FORCEINLINE std::pair<bool, float> ABattleFrameGameMode::ProcessCritDamage(float BaseDamage, float damageMult, float Probability)
+FORCEINLINE std::pair<bool, float> ABattleFrameGameMode::ProcessCritDamage(float BaseDamage, float damageMult, float Probability, uint64 RandomKey)
 {
 	//TRACE_CPUPROFILER_EVENT_SCOPE_STR("ProcessCrit");
 	float ActualDamage = BaseDamage;
 	bool IsCritical = false;  // 是否暴击
 
-	// 生成一个[0, 1]范围内的随机数
-	float CritChance = FMath::FRand();
+	// 生成一个[0, 1)范围内的随机数，由种子、帧、攻击者与目标决定
+	float CritChance = RandomFloat(RandomKey, EBattleFrameRandomPurpose::Crit);
 
 	// 判断是否触发暴击
 	if (CritChance < Probability)
@@ -2586,45 +3543,55 @@ FORCEINLINE float ABattleFrameGameMode::RangeMapProbability(int32 SubjectQuantit
 }
 
 // 根据概率大小生成音效播放Subject
-FORCEINLINE void ABattleFrameGameMode::QueueSound(TSoftObjectPtr<USoundBase> Sound, float Probability)
+FORCEINLINE void ABattleFrameGameMode::QueueSound(TSoftObjectPtr<USoundBase> Sound, float Probability, const FSubjectHandle& Subject)
 {
 	//TRACE_CPUPROFILER_EVENT_SCOPE_STR("QueueSound");
 
-	float RandomValue = FMath::FRand();
+	float RandomValue = RandomFloat(FBattleFrameRandom::SubjectKey(Subject), EBattleFrameRandomPurpose::Sound);
 
 	if (RandomValue <= Probability)
 	{
-		SoundsToPlay.Enqueue(Sound);
+		if (bBudgetFx)
+		{
+			const FLocated* Located = Subject.GetTraitPtr<FLocated, EParadigm::Unsafe>();
+			const float Priority = Located ? ScoreFx(Located->Location, Subject, FSubjectHandle(), false, false) : 0.f;
+
+			SoundEvents.Add({ Sound, Priority, FBattleFrameRandom::Hash(static_cast<uint32>(RandomSeed), SimulationFrame, FBattleFrameRandom::SubjectKey(Subject), EBattleFrameRandomPurpose::FxBudget) });
+		}
+		else
+		{
+			SoundsToPlay.Enqueue(Sound);
+		}
 	}
 }
 
 // 把受击数字添加到播放序列
-FORCEINLINE void ABattleFrameGameMode::QueueText(FSubjectHandle Subject, float Value, float Style, float Scale, float Radius, FVector Location)
+FORCEINLINE void ABattleFrameGameMode::QueueText(FSubjectHandle Subject, float Value, float Style, float Scale, float Radius, FVector Location, bool bKill)
 {
 	//TRACE_CPUPROFILER_EVENT_SCOPE_STR("QueueText");
 
-	if (Subject.HasTrait<FPoppingText>())
-	{
-		auto& PoppingText = Subject.GetTraitRef<FPoppingText, EParadigm::Unsafe>();
+	// BeginPlay 之前或关闭时不记录
+	if (!TextRing.IsEnabled()) return;
 
-		PoppingText.Lock();
-		PoppingText.TextLocationArray.Add(Location);
-		PoppingText.Text_Value_Style_Scale_Offset_Array.Add(FVector4(Value, Style, Scale, Radius));
-		//UE_LOG(LogTemp, Warning, TEXT("OldTrait"));
-		PoppingText.Unlock();
-	}
-	else
-	{
-		FPoppingText NewPoppingText;
-		NewPoppingText.TextLocationArray.Add(Location);
-		NewPoppingText.Text_Value_Style_Scale_Offset_Array.Add(FVector4(Value, Style, Scale, Radius));
-		//UE_LOG(LogTemp, Warning, TEXT("NewTrait"));
+	FBattleFrameTextEvent Event;
+	Event.Target = Subject;
+	Event.Location = Location;
+	Event.Value = Value;
+	Event.Style = Style;
+	Event.Scale = Scale;
+	Event.Offset = Radius;
+	Event.Time = SimulationTime;
+	Event.Priority = bKill ? EBattleFrameTextPriority::Kill : (Style >= 3 ? EBattleFrameTextPriority::Critical : EBattleFrameTextPriority::Normal);
 
-		Subject.SetTraitDeferred(NewPoppingText);
+	if (const FRendering* Rendering = Subject.GetTraitPtr<FRendering, EParadigm::Unsafe>())
+	{
+		Event.Renderer = Rendering->Renderer;
 	}
+
+	TextRing.Add(Event);
 }
 
-FORCEINLINE void ABattleFrameGameMode::QueueFx(FSubjectHandle Subject, FTransform Transfrom, ESubType SubType)
+FORCEINLINE bool ABattleFrameGameMode::QueueFx(FSubjectHandle Subject, FTransform Transfrom, ESubType SubType, EBattleFrameFxCategory Category, const FSubjectHandle& Other, bool bCritical, bool bKill)
 {
 	// 将偏移向量转换到Subject的本地坐标系
 	FLocated Located = Subject.GetTrait<FLocated>();
@@ -2635,16 +3602,37 @@ FORCEINLINE void ABattleFrameGameMode::QueueFx(FSubjectHandle Subject, FTransfor
 	FDirected FxDirected = { Transfrom.GetRotation().GetForwardVector()};
 	FScaled FxScaled = { Transfrom.GetScale3D() };
 
-	FSubjectRecord FxRecord;
-	FxRecord.SetTrait(FSpawningFx{});  // Set the SpawningFx trait
-	FxRecord.SetTrait(FxLocated);
-	FxRecord.SetTrait(FxDirected);
-	FxRecord.SetTrait(FxScaled);
+	// 有渲染器直接接收的类型不生成 Subject，开启预算时全部先排队筛选
+	if (bBudgetFx || FxEvents.IsRegistered(SubType))
+	{
+		FBattleFrameFxEvent Event;
+		Event.Location = FxLocated.Location;
+		Event.Direction = FxDirected.Direction;
+		Event.Scale = FxScaled.Factors;
+		Event.SubType = SubType;
+		Event.Category = Category;
+
+		if (bBudgetFx)
+		{
+			Event.Priority = ScoreFx(Event.Location, Subject, Other, bCritical, bKill);
+			Event.Key = FBattleFrameRandom::Hash(static_cast<uint32>(RandomSeed), SimulationFrame, FBattleFrameRandom::SubjectKey(Subject) ^ (static_cast<uint64>(Category) << 56), EBattleFrameRandomPurpose::FxBudget);
+		}
+
+		FxEvents.Add(Event);
+		return false;
+	}
+
+	GetMechanism()->SpawnSubjectDeferred(MakeFxRecord(FxLocated.Location, FxDirected.Direction, FxScaled.Factors, SubType));
+	return true;
+}
 
-	// Use the function to set the appropriate FSubTypeX based on attackFxSubType
-	UBattleFrameFunctionLibraryRT::SetSubTypeTraitByEnum(SubType, FxRecord);
+// 特效与音效的预算评分，越近、暴击、击杀或与玩家有关的越高
+float ABattleFrameGameMode::ScoreFx(const FVector& Location, const FSubjectHandle& Subject, const FSubjectHandle& Other, bool bCritical, bool bKill) const
+{
+	const float Distance = CrowdInputs.bViewIsValid ? FVector::Dist(Location, CrowdInputs.ViewLocation) : FxBudget.FalloffDistance;
+	const bool bPlayer = CrowdInputs.bPlayerIsValid && (Subject == CrowdInputs.PlayerHandle || Other == CrowdInputs.PlayerHandle);
 
-	GetMechanism()->SpawnSubjectDeferred(FxRecord);
+	return FxBudget.Score(Distance, bCritical, bKill, bPlayer);
 }
 
 FORCEINLINE void ABattleFrameGameMode::CopyAnimData(FAnimation& Animation)
@@ -2656,4 +3644,41 @@ FORCEINLINE void ABattleFrameGameMode::CopyAnimData(FAnimation& Animation)
 	Animation.AnimOffsetTime0 = Animation.AnimOffsetTime1;
 	Animation.AnimPauseTime0 = Animation.AnimPauseTime1;
 	Animation.AnimPlayRate0 = Animation.AnimPlayRate1;
-}
\ No newline at end of file
+}
+
+void ABattleFrameGameMode::CompactRenderBatch(FRenderBatchData& Data, bool bAllowShrinking)
+{
+	// 空位升序，从前往后填空位，从后往前取存活实例
+	Data.FreeTransforms.Sort();
+	const TArray<int32>& Holes = Data.FreeTransforms;
+	const int32 LiveNum = Data.Transforms.Num() - Holes.Num();
+
+	int32 Front = 0;
+	int32 Back = Holes.Num() - 1;
+	int32 Last = Data.Transforms.Num() - 1;
+
+	while (Front <= Back)
+	{
+		// 末尾的空位直接截掉
+		if (Last == Holes[Back])
+		{
+			--Back;
+			--Last;
+			continue;
+		}
+
+		Data.MoveInstance(Last, Holes[Front]);
+
+		// 个体在本帧已写入渲染数据，句柄有效
+		if (FRendering* Rendering = Data.InstanceSubjects[Holes[Front]].GetTraitPtr<FRendering, EParadigm::Unsafe>())
+		{
+			Rendering->InstanceId = Holes[Front];
+		}
+
+		++Front;
+		--Last;
+	}
+
+	Data.TruncateInstances(LiveNum, bAllowShrinking);
+	Data.FreeTransforms.Reset();
+}
@@ -0,0 +1,229 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameStageTuner.h"
+
+FBattleFrameStageTuner& FBattleFrameStageTuner::Get()
+{
+	static FBattleFrameStageTuner Tuner;
+	return Tuner;
+}
+
+void FBattleFrameStageTuner::Decide(const FName Stage, int32 IterableNum, int32 MaxThreadsAllowed, int32& Candidate, int32& ThreadsCount, int32& BatchSize)
+{
+	FStage& StageData = Stages.FindOrAdd(Stage);
+	const int32 MaxThreads = FMath::Clamp(FPlatformMisc::NumberOfWorkerThreadsToSpawn(), 1, FMath::Max(MaxThreadsAllowed, 1));
+
+	// 预设优先
+	if (StageData.bPreset)
+	{
+		Candidate = INDEX_NONE;
+		ThreadsCount = FMath::Clamp(StageData.Preset.ThreadsCount, 1, MaxThreads);
+		BatchSize = StageData.Preset.BatchSize > 0 ? StageData.Preset.BatchSize : FMath::Clamp(FMath::DivideAndRoundUp(IterableNum, ThreadsCount), 1, 10000);
+
+		StageData.LastThreadsCount = ThreadsCount;
+		StageData.LastBatchSize = BatchSize;
+		return;
+	}
+
+	if (StageData.MaxThreads != MaxThreads)
+	{
+		BuildCandidates(StageData, MaxThreads);
+	}
+
+	// 同一阶段内的多次遍历沿用第一次的选择
+	if (!StageData.Candidates.IsValidIndex(Candidate))
+	{
+		const double SerialCostPerItemUs = EstimateCostPerItemUs(StageData, StageData.Best);
+
+		if (SerialCostPerItemUs > 0.0 && IterableNum * SerialCostPerItemUs < MinParallelWorkUs)
+		{
+			Candidate = 0;
+		}
+		else
+		{
+			Candidate = PickCandidate(StageData);
+		}
+	}
+
+	ThreadsCount = StageData.Candidates[Candidate].ThreadsCount;
+	BatchSize = FMath::DivideAndRoundUp(FMath::Max(IterableNum, 1), ThreadsCount);
+
+	// 批次太小时合并，多出来的线程自然闲置
+	const double CostPerItemUs = EstimateCostPerItemUs(StageData, Candidate);
+
+	if (CostPerItemUs > 0.0)
+	{
+		BatchSize = FMath::Max(BatchSize, FMath::CeilToInt32(MinBatchWorkUs / CostPerItemUs));
+	}
+
+	BatchSize = FMath::Clamp(BatchSize, 1, 10000);
+	ThreadsCount = FMath::Clamp(FMath::DivideAndRoundUp(FMath::Max(IterableNum, 1), BatchSize), 1, ThreadsCount);
+
+	StageData.LastThreadsCount = ThreadsCount;
+	StageData.LastBatchSize = BatchSize;
+}
+
+void FBattleFrameStageTuner::Report(const FName Stage, int32 Candidate, int32 IterableNum, double TimeMs)
+{
+	if (IterableNum <= 0) return;
+
+	FStage* StageData = Stages.Find(Stage);
+
+	if (!StageData || StageData->bPreset || !StageData->Candidates.IsValidIndex(Candidate)) return;
+
+	FCandidate& Sample = StageData->Candidates[Candidate];
+	const double CostPerItemUs = TimeMs * 1000.0 / IterableNum;
+
+	Sample.CostPerItemUs = Sample.Samples == 0 ? CostPerItemUs : FMath::Lerp(Sample.CostPerItemUs, CostPerItemUs, 0.2);
+	Sample.Samples++;
+
+	StageData->FramesSinceProbe++;
+
+	// 采样足够的候选才能取代当前的选择，避免单帧的抖动
+	for (int32 i = 0; i < StageData->Candidates.Num(); ++i)
+	{
+		const FCandidate& Other = StageData->Candidates[i];
+		const FCandidate& Best = StageData->Candidates[StageData->Best];
+
+		if (Other.Samples >= MinSamples && (Best.Samples < MinSamples || Other.CostPerItemUs < Best.CostPerItemUs))
+		{
+			StageData->Best = i;
+		}
+	}
+}
+
+float FBattleFrameStageTuner::GetCostPerItemUs(const FName Stage) const
+{
+	const FStage* StageData = Stages.Find(Stage);
+
+	if (!StageData || !StageData->Candidates.IsValidIndex(StageData->Best)) return 0.f;
+
+	return StageData->Candidates[StageData->Best].CostPerItemUs;
+}
+
+void FBattleFrameStageTuner::SetPresets(const TArray<FBattleFrameStageTuning>& Presets)
+{
+	for (TPair<FName, FStage>& Pair : Stages)
+	{
+		Pair.Value.bPreset = false;
+	}
+
+	for (const FBattleFrameStageTuning& Preset : Presets)
+	{
+		if (Preset.Stage.IsNone()) continue;
+
+		FStage& StageData = Stages.FindOrAdd(Preset.Stage);
+		StageData.bPreset = true;
+		StageData.Preset = Preset;
+	}
+}
+
+TArray<FBattleFrameStageTuning> FBattleFrameStageTuner::CapturePresets() const
+{
+	TArray<FBattleFrameStageTuning> Presets;
+
+	for (const TPair<FName, FStage>& Pair : Stages)
+	{
+		if (Pair.Value.LastThreadsCount <= 0) continue;
+
+		FBattleFrameStageTuning& Preset = Presets.AddDefaulted_GetRef();
+		Preset.Stage = Pair.Key;
+		Preset.ThreadsCount = Pair.Value.LastThreadsCount;
+		Preset.BatchSize = Pair.Value.LastBatchSize;
+	}
+
+	return Presets;
+}
+
+void FBattleFrameStageTuner::Reset()
+{
+	Stages.Reset();
+}
+
+void FBattleFrameStageTuner::BuildCandidates(FStage& StageData, int32 MaxThreads) const
+{
+	StageData.Candidates.Reset();
+	StageData.MaxThreads = MaxThreads;
+	StageData.Probing = INDEX_NONE;
+	StageData.FramesSinceProbe = 0;
+
+	for (int32 Threads = 1; Threads < MaxThreads; Threads *= 2)
+	{
+		StageData.Candidates.Add({ Threads });
+	}
+
+	StageData.Candidates.Add({ MaxThreads });
+
+	// 从默认算法的线程数（全部工作线程）开始
+	StageData.Best = StageData.Candidates.Num() - 1;
+}
+
+int32 FBattleFrameStageTuner::PickCandidate(FStage& StageData) const
+{
+	// 当前选择先采样足够
+	if (StageData.Candidates[StageData.Best].Samples < MinSamples)
+	{
+		return StageData.Best;
+	}
+
+	// 正在试探的相邻候选采样足够后结束试探
+	if (StageData.Candidates.IsValidIndex(StageData.Probing) && StageData.Probing != StageData.Best)
+	{
+		if (StageData.Candidates[StageData.Probing].Samples < MinSamples)
+		{
+			return StageData.Probing;
+		}
+	}
+
+	StageData.Probing = INDEX_NONE;
+
+	// 没有测过的相邻候选立即试探，其余每隔一段时间轮流试探两侧
+	const int32 Below = StageData.Best - 1;
+	const int32 Above = StageData.Best + 1;
+	int32 Neighbour = INDEX_NONE;
+
+	if (StageData.Candidates.IsValidIndex(Below) && StageData.Candidates[Below].Samples == 0)
+	{
+		Neighbour = Below;
+	}
+	else if (StageData.Candidates.IsValidIndex(Above) && StageData.Candidates[Above].Samples == 0)
+	{
+		Neighbour = Above;
+	}
+	else if (StageData.FramesSinceProbe >= ReprobeInterval)
+	{
+		StageData.bProbeUp = !StageData.bProbeUp;
+		Neighbour = StageData.Best + (StageData.bProbeUp ? 1 : -1);
+
+		if (!StageData.Candidates.IsValidIndex(Neighbour))
+		{
+			Neighbour = StageData.Best + (StageData.bProbeUp ? -1 : 1);
+		}
+	}
+
+	if (!StageData.Candidates.IsValidIndex(Neighbour))
+	{
+		return StageData.Best;
+	}
+
+	StageData.FramesSinceProbe = 0;
+	StageData.Probing = Neighbour;
+
+	return Neighbour;
+}
+
+double FBattleFrameStageTuner::EstimateCostPerItemUs(const FStage& StageData, int32 Candidate) const
+{
+	// 单线程的每元素耗时最接近真实工作量，没有时用多线程的墙钟时间折算
+	const FCandidate& Serial = StageData.Candidates[0];
+
+	if (Serial.Samples > 0) return Serial.CostPerItemUs;
+
+	const FCandidate& Current = StageData.Candidates[Candidate];
+
+	return Current.Samples > 0 ? Current.CostPerItemUs * Current.ThreadsCount : 0.0;
+}
@@ -0,0 +1,329 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameStats.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "BattleFrameFunctionLibraryRT.h"
+#include "BattleFrameStageTuner.h"
+
+DEFINE_STAT(STAT_BattleFramePipeline);
+DEFINE_STAT(STAT_BattleFrameIterated);
+DEFINE_STAT(STAT_BattleFrameDeferredOps);
+DEFINE_STAT(STAT_BattleFrameNiagaraUploadBytes);
+DEFINE_STAT(STAT_BattleFrameCulledAgents);
+DEFINE_STAT(STAT_BattleFrameDroppedTexts);
+DEFINE_STAT(STAT_BattleFrameDroppedFx);
+DEFINE_STAT(STAT_BattleFrameDroppedSounds);
+
+CSV_DEFINE_CATEGORY(BattleFrame, true);
+
+namespace
+{
+	// 每个线程各自的阶段栈顶，异步模拟与游戏线程可以同时打开阶段
+	thread_local FBattleFrameStageScope* CurrentStageScope = nullptr;
+
+	// 本线程尚未合并到阶段的延迟操作数
+	thread_local int32 PendingDeferred = 0;
+
+	void FlushPendingDeferred()
+	{
+		if (CurrentStageScope && PendingDeferred > 0)
+		{
+			CurrentStageScope->AddDeferred(PendingDeferred);
+		}
+
+		PendingDeferred = 0;
+	}
+}
+
+
+//--------------------------------------------Collector----------------------------------------------------------------
+
+FBattleFrameStatsCollector& FBattleFrameStatsCollector::Get()
+{
+	static FBattleFrameStatsCollector Collector;
+	return Collector;
+}
+
+void FBattleFrameStatsCollector::BeginFrame(int64 Frame)
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	CurrentFrame.Frame = Frame;
+	CurrentFrame.TotalTimeMs = 0.f;
+	CurrentFrame.Stages.Reset();
+
+	FrameStartCycles = FPlatformTime::Cycles64();
+	bFrameOpen = true;
+}
+
+void FBattleFrameStatsCollector::EndFrame()
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	if (!bFrameOpen) return;
+
+	bFrameOpen = false;
+	CurrentFrame.TotalTimeMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - FrameStartCycles);
+
+	LastFrame = CurrentFrame;
+
+	// 环形缓存历史帧
+	if (MaxHistoryFrames <= 0)
+	{
+		History.Reset();
+		HistoryHead = 0;
+	}
+	else if (History.Num() < MaxHistoryFrames)
+	{
+		History.Add(CurrentFrame);
+	}
+	else
+	{
+		HistoryHead %= History.Num();
+		History[HistoryHead] = CurrentFrame;
+		HistoryHead = (HistoryHead + 1) % History.Num();
+	}
+
+#if CSV_PROFILER
+	FCsvProfiler::RecordCustomStat(FName(TEXT("PipelineTotal")), CSV_CATEGORY_INDEX(BattleFrame), CurrentFrame.TotalTimeMs, ECsvCustomStatOp::Set);
+#endif
+}
+
+int32 FBattleFrameStatsCollector::BeginStage(const FName Stage)
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	if (!bFrameOpen) return INDEX_NONE;
+
+	FBattleFrameStageStats& StageStats = CurrentFrame.Stages.AddDefaulted_GetRef();
+	StageStats.Stage = Stage;
+
+	return CurrentFrame.Stages.Num() - 1;
+}
+
+void FBattleFrameStatsCollector::EndStage(int32 Index, const FBattleFrameStageStats& StageStats)
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	if (!CurrentFrame.Stages.IsValidIndex(Index)) return;
+
+	CurrentFrame.Stages[Index] = StageStats;
+
+	INC_DWORD_STAT_BY(STAT_BattleFrameIterated, StageStats.IterableNum);
+	INC_DWORD_STAT_BY(STAT_BattleFrameDeferredOps, StageStats.DeferredOps);
+
+#if CSV_PROFILER
+	FCsvProfiler::RecordCustomStat(StageStats.Stage, CSV_CATEGORY_INDEX(BattleFrame), StageStats.TimeMs, ECsvCustomStatOp::Accumulate);
+#endif
+}
+
+FBattleFrameFrameStats FBattleFrameStatsCollector::GetLastFrame() const
+{
+	FScopeLock ScopeLock(&Mutex);
+	return LastFrame;
+}
+
+TArray<FBattleFrameFrameStats> FBattleFrameStatsCollector::GetHistory() const
+{
+	FScopeLock ScopeLock(&Mutex);
+	return History;
+}
+
+bool FBattleFrameStatsCollector::ExportToCSV(const FString& FilePath) const
+{
+	FScopeLock ScopeLock(&Mutex);
+
+	FString Path = FilePath;
+
+	if (Path.IsEmpty())
+	{
+		Path = FPaths::ProfilingDir() / TEXT("BattleFrame") / FString::Printf(TEXT("StageStats-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	FString Csv = TEXT("Frame,Stage,TimeMs,IterableNum,ThreadsCount,BatchSize,DeferredOps,AutoTuned,CostPerItemUs\n");
+
+	// 从最旧的帧开始写
+	for (int32 i = 0; i < History.Num(); ++i)
+	{
+		const FBattleFrameFrameStats& FrameStats = History[(HistoryHead + i) % History.Num()];
+
+		Csv += FString::Printf(TEXT("%lld,Total,%.4f,,,,,,\n"), FrameStats.Frame, FrameStats.TotalTimeMs);
+
+		for (const FBattleFrameStageStats& StageStats : FrameStats.Stages)
+		{
+			Csv += FString::Printf(TEXT("%lld,%s,%.4f,%d,%d,%d,%d,%d,%.4f\n"),
+				FrameStats.Frame,
+				*StageStats.Stage.ToString(),
+				StageStats.TimeMs,
+				StageStats.IterableNum,
+				StageStats.ThreadsCount,
+				StageStats.BatchSize,
+				StageStats.DeferredOps,
+				StageStats.bAutoTuned ? 1 : 0,
+				StageStats.CostPerItemUs);
+		}
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Path);
+}
+
+#if STATS
+TStatId FBattleFrameStatsCollector::GetStatId(const FName Stage)
+{
+	FScopeLock ScopeLock(&StatIdsLock);
+
+	if (const TStatId* StatId = StatIds.Find(Stage))
+	{
+		return *StatId;
+	}
+
+	const TStatId StatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_BattleFrame>(Stage);
+	StatIds.Add(Stage, StatId);
+
+	return StatId;
+}
+#endif
+
+
+//--------------------------------------------Scopes-------------------------------------------------------------------
+
+FBattleFrameStageScope::FBattleFrameStageScope(const FName InStage)
+	: Stage(InStage)
+{
+	FBattleFrameStatsCollector& Collector = FBattleFrameStatsCollector::Get();
+
+	// 调优器同样需要阶段耗时，只要有一方启用就计时
+	bRecording = Collector.bEnabled;
+
+	if (!bRecording && !FBattleFrameStageTuner::Get().bEnabled) return;
+
+	StartCycles = FPlatformTime::Cycles64();
+
+	if (!bRecording) return;
+
+	Index = Collector.BeginStage(Stage);
+
+#if STATS
+	CycleCounter.Start(Collector.GetStatId(Stage));
+#endif
+
+	FlushPendingDeferred();
+	Previous = CurrentStageScope;
+	CurrentStageScope = this;
+}
+
+FBattleFrameStageScope::~FBattleFrameStageScope()
+{
+	if (StartCycles == 0) return;
+
+	const double TimeMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	FBattleFrameStageTuner& Tuner = FBattleFrameStageTuner::Get();
+
+	if (TunedCandidate != INDEX_NONE)
+	{
+		Tuner.Report(Stage, TunedCandidate, IterableNum, TimeMs);
+	}
+
+	if (!bRecording) return;
+
+	FlushPendingDeferred();
+	CurrentStageScope = Previous;
+
+#if STATS
+	CycleCounter.Stop();
+#endif
+
+	FBattleFrameStageStats StageStats;
+	StageStats.Stage = Stage;
+	StageStats.TimeMs = TimeMs;
+	StageStats.IterableNum = IterableNum;
+	StageStats.ThreadsCount = ThreadsCount;
+	StageStats.BatchSize = BatchSize;
+	StageStats.DeferredOps = DeferredOps.load(std::memory_order_relaxed);
+	StageStats.bAutoTuned = bAutoTuned;
+	StageStats.CostPerItemUs = bAutoTuned ? Tuner.GetCostPerItemUs(Stage) : 0.f;
+
+	FBattleFrameStatsCollector::Get().EndStage(Index, StageStats);
+}
+
+void FBattleFrameStageScope::CountDeferred(int32 Num)
+{
+	if (CurrentStageScope)
+	{
+		PendingDeferred += Num;
+	}
+}
+
+FBattleFrameStageScope* FBattleFrameStageScope::GetCurrent()
+{
+	return CurrentStageScope;
+}
+
+FBattleFrameStageScope::FWorkerBinding::FWorkerBinding(FBattleFrameStageScope* Scope)
+{
+	FlushPendingDeferred();
+	Previous = CurrentStageScope;
+	CurrentStageScope = Scope;
+}
+
+FBattleFrameStageScope::FWorkerBinding::~FWorkerBinding()
+{
+	FlushPendingDeferred();
+	CurrentStageScope = Previous;
+}
+
+void FBattleFrameStageScope::CalculateThreadsCountAndBatchSize(int32 InIterableNum, int32& MaxThreadsAllowed, int32& OutThreadsCount, int32& OutBatchSize)
+{
+	FBattleFrameStageTuner& Tuner = FBattleFrameStageTuner::Get();
+
+	if (Tuner.bEnabled && StartCycles != 0)
+	{
+		Tuner.Decide(Stage, InIterableNum, MaxThreadsAllowed, TunedCandidate, OutThreadsCount, OutBatchSize);
+		bAutoTuned = true;
+	}
+	else
+	{
+		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(InIterableNum, MaxThreadsAllowed, OutThreadsCount, OutBatchSize);
+	}
+
+	Track(InIterableNum, OutThreadsCount, OutBatchSize);
+}
+
+void FBattleFrameStageScope::Track(int32 InIterableNum, int32 InThreadsCount, int32 InBatchSize)
+{
+	// 一个阶段可能包含多次遍历，累加数量，取最大线程数
+	IterableNum += InIterableNum;
+	ThreadsCount = FMath::Max(ThreadsCount, InThreadsCount);
+	BatchSize = FMath::Max(BatchSize, InBatchSize);
+}
+
+FBattleFrameFrameScope::FBattleFrameFrameScope(int64 Frame, bool bEnabled)
+#if STATS
+	: CycleCounter(GET_STATID(STAT_BattleFramePipeline))
+#endif
+{
+	FBattleFrameStatsCollector& Collector = FBattleFrameStatsCollector::Get();
+	Collector.bEnabled = bEnabled;
+	bWasEnabled = bEnabled;
+
+	if (bEnabled)
+	{
+		Collector.BeginFrame(Frame);
+	}
+}
+
+FBattleFrameFrameScope::~FBattleFrameFrameScope()
+{
+	if (bWasEnabled)
+	{
+		FBattleFrameStatsCollector::Get().EndFrame();
+	}
+}
@@ -0,0 +1,131 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameTelemetry.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+void FBattleFrameTelemetry::Reset(int32 Capacity)
+{
+	Head.store(0, std::memory_order_relaxed);
+
+	if (Capacity <= 0)
+	{
+		Records.Empty();
+		Mask = 0;
+		return;
+	}
+
+	const uint32 Size = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(Capacity));
+	Records.SetNumZeroed(Size);
+	Mask = Size - 1;
+}
+
+int32 FBattleFrameTelemetry::Num() const
+{
+	return static_cast<int32>(FMath::Min<uint64>(Head.load(std::memory_order_acquire), Records.Num()));
+}
+
+FBattleFrameTelemetryAggregate FBattleFrameTelemetry::Aggregate(double SinceTime) const
+{
+	FBattleFrameTelemetryAggregate Result;
+	Result.DamageTakenByTeam.SetNumZeroed(MaxTeams);
+	Result.DamageDealtByTeam.SetNumZeroed(MaxTeams);
+	Result.DamageByType.SetNumZeroed(static_cast<int32>(EBattleFrameDamageType::Num));
+
+	TArray<float> TimesToKill;
+
+	ForEachRecord([&](const FBattleFrameCombatRecord& Record)
+	{
+		if (Record.Time < SinceTime) return;
+
+		Result.RecordsNum++;
+		Result.TotalDamage += Record.Amount;
+		Result.DamageByType[static_cast<int32>(Record.DamageType)] += Record.Amount;
+		Result.DamageTakenBySubType.FindOrAdd(Record.TargetSubType) += Record.Amount;
+
+		if (EnumHasAnyFlags(Record.Flags, EBattleFrameDamageFlags::Critical))
+		{
+			Result.CriticalDamage += Record.Amount;
+		}
+
+		if (EnumHasAnyFlags(Record.Flags, EBattleFrameDamageFlags::Temporal))
+		{
+			Result.TemporalDamage += Record.Amount;
+		}
+
+		if (Record.TargetTeam >= 0 && Record.TargetTeam < MaxTeams)
+		{
+			Result.DamageTakenByTeam[Record.TargetTeam] += Record.Amount;
+		}
+
+		if (Record.InstigatorTeam >= 0 && Record.InstigatorTeam < MaxTeams)
+		{
+			Result.DamageDealtByTeam[Record.InstigatorTeam] += Record.Amount;
+		}
+
+		if (Record.bKill)
+		{
+			Result.Kills++;
+			Result.KillsByInstigatorSubType.FindOrAdd(Record.InstigatorSubType)++;
+
+			if (Record.TimeToKill >= 0.f)
+			{
+				TimesToKill.Add(Record.TimeToKill);
+			}
+		}
+	});
+
+	if (TimesToKill.Num() > 0)
+	{
+		TimesToKill.Sort();
+
+		float Sum = 0.f;
+
+		for (const float Time : TimesToKill)
+		{
+			Sum += Time;
+		}
+
+		Result.TimeToKillMean = Sum / TimesToKill.Num();
+		Result.TimeToKillMedian = TimesToKill[TimesToKill.Num() / 2];
+		Result.TimeToKillP90 = TimesToKill[FMath::Min(TimesToKill.Num() - 1, TimesToKill.Num() * 9 / 10)];
+		Result.TimeToKillMax = TimesToKill.Last();
+	}
+
+	return Result;
+}
+
+bool FBattleFrameTelemetry::ExportToCSV(const FString& FilePath) const
+{
+	FString Path = FilePath;
+
+	if (Path.IsEmpty())
+	{
+		Path = FPaths::ProfilingDir() / TEXT("BattleFrame") / FString::Printf(TEXT("Telemetry-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	FString Csv = TEXT("Frame,Time,Kind,Amount,DamageType,Critical,Temporal,TargetTeam,TargetSubType,InstigatorTeam,InstigatorSubType,TimeToKill\n");
+
+	ForEachRecord([&](const FBattleFrameCombatRecord& Record)
+	{
+		Csv += FString::Printf(TEXT("%u,%.4f,%s,%.4f,%d,%d,%d,%d,%d,%d,%d,%.4f\n"),
+			Record.Frame,
+			Record.Time,
+			Record.bKill ? TEXT("Kill") : TEXT("Damage"),
+			Record.Amount,
+			static_cast<int32>(Record.DamageType),
+			EnumHasAnyFlags(Record.Flags, EBattleFrameDamageFlags::Critical) ? 1 : 0,
+			EnumHasAnyFlags(Record.Flags, EBattleFrameDamageFlags::Temporal) ? 1 : 0,
+			Record.TargetTeam,
+			Record.TargetSubType,
+			Record.InstigatorTeam,
+			Record.InstigatorSubType,
+			Record.TimeToKill);
+	});
+
+	return FFileHelper::SaveStringToFile(Csv, *Path);
+}
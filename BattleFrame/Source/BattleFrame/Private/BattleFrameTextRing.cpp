@@ -0,0 +1,115 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameTextRing.h"
+
+void FBattleFrameTextRing::Reset(int32 Capacity)
+{
+	Head.store(0, std::memory_order_relaxed);
+	Tail.store(0, std::memory_order_relaxed);
+	Pending.Reset();
+	PendingIndices.Reset();
+
+	if (Capacity <= 0)
+	{
+		Events.Empty();
+		Sequences.Reset();
+		Mask = 0;
+		return;
+	}
+
+	const uint32 Size = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(Capacity));
+	Events.SetNum(Size);
+	Sequences = MakeUnique<std::atomic<uint64>[]>(Size);
+	Mask = Size - 1;
+}
+
+int32 FBattleFrameTextRing::Drain(double Time, float MergeWindow, int32 Budget, TArray<FBattleFrameTextEvent>& Out)
+{
+	Out.Reset();
+
+	if (!IsEnabled())
+	{
+		return 0;
+	}
+
+	const uint64 Begin = Tail.load(std::memory_order_relaxed);
+	const uint64 End = Head.load(std::memory_order_acquire);
+	const uint64 Count = FMath::Min<uint64>(End - Begin, Events.Num());
+
+	// 环满后被丢弃的事件
+	int32 DroppedNum = static_cast<int32>(End - Begin - Count);
+
+	for (uint64 i = Begin; i < Begin + Count; ++i)
+	{
+		// 没有发布的槽位不读取
+		if (Sequences[i & Mask].load(std::memory_order_acquire) != i + 1)
+		{
+			++DroppedNum;
+			continue;
+		}
+
+		const FBattleFrameTextEvent& Event = Events[i & Mask];
+
+		if (MergeWindow > 0.f)
+		{
+			// 同一目标在窗口内的伤害累加为一个数字
+			if (const int32* Found = PendingIndices.Find(Event.Target))
+			{
+				FBattleFrameTextEvent& Merged = Pending[*Found];
+				Merged.Renderer = Event.Renderer;
+				Merged.Location = Event.Location;
+				Merged.Value += Event.Value;
+				Merged.Style = FMath::Max(Merged.Style, Event.Style);
+				Merged.Scale = FMath::Max(Merged.Scale, Event.Scale);
+				Merged.Offset = FMath::Max(Merged.Offset, Event.Offset);
+				Merged.Priority = FMath::Max(Merged.Priority, Event.Priority);
+				continue;
+			}
+
+			PendingIndices.Add(Event.Target, Pending.Num());
+		}
+
+		Pending.Add(Event);
+	}
+
+	Tail.store(End, std::memory_order_relaxed);
+
+	// 窗口结束或目标已被击杀的数字可以显示，其余留到之后
+	PendingIndices.Reset();
+	int32 KeptNum = 0;
+
+	for (int32 i = 0; i < Pending.Num(); ++i)
+	{
+		const FBattleFrameTextEvent& Event = Pending[i];
+
+		if (Event.Priority == EBattleFrameTextPriority::Kill || Time - Event.Time >= MergeWindow)
+		{
+			Out.Add(Event);
+		}
+		else
+		{
+			PendingIndices.Add(Event.Target, KeptNum);
+			Pending[KeptNum++] = Event;
+		}
+	}
+
+	Pending.SetNum(KeptNum, false);
+
+	if (Budget > 0 && Out.Num() > Budget)
+	{
+		// 击杀与暴击优先，同级时数值大的优先
+		Out.StableSort([](const FBattleFrameTextEvent& A, const FBattleFrameTextEvent& B)
+		{
+			return A.Priority != B.Priority ? A.Priority > B.Priority : A.Value > B.Value;
+		});
+
+		DroppedNum += Out.Num() - Budget;
+		Out.SetNum(Budget, false);
+	}
+
+	return DroppedNum;
+}
@@ -0,0 +1,152 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameTimerWheel.h"
+
+FBattleFrameTimerWheel::FBattleFrameTimerWheel(double InResolution)
+	: Resolution(FMath::Max(InResolution, 0.001))
+{
+}
+
+void FBattleFrameTimerWheel::Reset(double Now)
+{
+	Lock();
+
+	for (int32 Level = 0; Level < LevelsNum; ++Level)
+	{
+		for (TArray<FEntry>& Slot : Wheels[Level])
+		{
+			Slot.Reset();
+		}
+	}
+
+	for (TArray<FSubjectHandle>& List : Due)
+	{
+		List.Reset();
+	}
+
+	Overflow.Reset();
+	EntriesNum = 0;
+	CurrentTick = FMath::FloorToInt64(Now / Resolution);
+
+	Unlock();
+}
+
+void FBattleFrameTimerWheel::Schedule(const FSubjectHandle& Subject, EBattleFrameTimer Timer, double DueTime)
+{
+	// 向上取整，保证不会提前触发
+	FEntry Entry{ Subject, FMath::CeilToInt64(DueTime / Resolution), Timer };
+
+	Lock();
+	Insert(MoveTemp(Entry));
+	Unlock();
+}
+
+void FBattleFrameTimerWheel::Advance(double Now)
+{
+	const int64 TargetTick = FMath::FloorToInt64(Now / Resolution);
+
+	Lock();
+
+	while (CurrentTick < TargetTick)
+	{
+		CurrentTick++;
+
+		// 低位归零时从上一层搬下来，先搬高层
+		if ((CurrentTick & (SlotsNum - 1)) == 0)
+		{
+			if (((CurrentTick >> SlotBits) & (SlotsNum - 1)) == 0)
+			{
+				if (((CurrentTick >> (SlotBits * 2)) & (SlotsNum - 1)) == 0)
+				{
+					TArray<FEntry> Pending = MoveTemp(Overflow);
+					Overflow.Reset();
+					EntriesNum -= Pending.Num();
+
+					for (FEntry& Entry : Pending)
+					{
+						Insert(MoveTemp(Entry));
+					}
+				}
+
+				Cascade(2);
+			}
+
+			Cascade(1);
+		}
+
+		TArray<FEntry>& Slot = Wheels[0][CurrentTick & (SlotsNum - 1)];
+
+		for (FEntry& Entry : Slot)
+		{
+			Due[static_cast<uint8>(Entry.Timer)].Add(MoveTemp(Entry.Subject));
+		}
+
+		EntriesNum -= Slot.Num();
+		Slot.Reset();
+	}
+
+	Unlock();
+}
+
+TArray<FSubjectHandle> FBattleFrameTimerWheel::Consume(EBattleFrameTimer Timer)
+{
+	Lock();
+	TArray<FSubjectHandle> Result = MoveTemp(Due[static_cast<uint8>(Timer)]);
+	Due[static_cast<uint8>(Timer)].Reset();
+	Unlock();
+
+	return Result;
+}
+
+int32 FBattleFrameTimerWheel::Num() const
+{
+	Lock();
+	const int32 Result = EntriesNum;
+	Unlock();
+
+	return Result;
+}
+
+void FBattleFrameTimerWheel::Insert(FEntry&& Entry)
+{
+	const int64 Delta = Entry.Tick - CurrentTick;
+
+	// 已经到期的直接进入待处理列表
+	if (Delta <= 0)
+	{
+		Due[static_cast<uint8>(Entry.Timer)].Add(MoveTemp(Entry.Subject));
+		return;
+	}
+
+	EntriesNum++;
+
+	for (int32 Level = 0; Level < LevelsNum; ++Level)
+	{
+		if (Delta < (int64(1) << (SlotBits * (Level + 1))))
+		{
+			const int32 Slot = (Entry.Tick >> (SlotBits * Level)) & (SlotsNum - 1);
+			Wheels[Level][Slot].Add(MoveTemp(Entry));
+			return;
+		}
+	}
+
+	Overflow.Add(MoveTemp(Entry));
+}
+
+void FBattleFrameTimerWheel::Cascade(int32 Level)
+{
+	TArray<FEntry>& Slot = Wheels[Level][(CurrentTick >> (SlotBits * Level)) & (SlotsNum - 1)];
+	TArray<FEntry> Pending = MoveTemp(Slot);
+	Slot.Reset();
+
+	EntriesNum -= Pending.Num();
+
+	for (FEntry& Entry : Pending)
+	{
+		Insert(MoveTemp(Entry));
+	}
+}
@@ -33,7 +33,20 @@
 #include "Math/Vector2D.h"
 #include "Definitions.h"
 #include "BattleFrameFunctionLibraryRT.h"
+#include "BattleFrameStats.h"
+#include "BattleFrameGameMode.h"
 
+namespace
+{
+	// 异步模拟运行时游戏线程上的查询先等待其结束，模拟内部调用时直接返回
+	FORCEINLINE void WaitForCrowdSimulation()
+	{
+		if (ABattleFrameGameMode* GameMode = ABattleFrameGameMode::GetInstance())
+		{
+			GameMode->WaitForCrowdSimulation();
+		}
+	}
+}
 
 UNeighborGridComponent::UNeighborGridComponent()
 {
@@ -66,6 +79,8 @@ void UNeighborGridComponent::SphereTraceForSubjects(const FVector& Origin, float
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("SphereTraceForSubjects");
 
+	WaitForCrowdSimulation();
+
 	TSet<FSubjectHandle> OverlappingSubjects;
 
 	const FVector Range(Radius);
@@ -133,6 +148,8 @@ void UNeighborGridComponent::SphereSweepForSubjects(const FVector& Start, const
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("SphereSweepForSubjects");
 
+	WaitForCrowdSimulation();
+
 	TSet<FSubjectHandle> HitSubjects;
 	TArray<FIntVector> GridCells = GetGridCellsForCapsule(Start, End, Radius);
 	TSet<int32> VisitedCells;
@@ -198,6 +215,8 @@ void UNeighborGridComponent::SphereExpandForSubjects(const FVector& Origin, floa
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("SphereExpandForSubjects");
 
+	WaitForCrowdSimulation();
+
 	TSet<FSubjectHandle> OverlappingSubjects;
 	float ClosestDistanceSqr = FLT_MAX;
 	FSubjectHandle ClosestSubject;
@@ -278,8 +297,12 @@ void UNeighborGridComponent::Update()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("RVO2 Update");
 
+	WaitForCrowdSimulation();
+
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("ResetCells");
+		FBattleFrameStageScope StageScope(TEXT("ResetCells"));
+		StageScope.Track(Cells.Num(), FPlatformMisc::NumberOfWorkerThreadsToSpawn(), 1);
 
 		ParallelFor(Cells.Num(), [&](int32 Index) //To do : only process occupied cells not all cells
 		{
@@ -295,10 +318,11 @@ void UNeighborGridComponent::Update()
 
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RegisterNeighborGrid");
+		FBattleFrameStageScope StageScope(TEXT("RegisterNeighborGrid"));
 
 		FFilter Filter = FFilter::Make<FLocated, FTrace>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FLocated& Located, FTrace& Trace)
 		{
@@ -315,11 +339,12 @@ void UNeighborGridComponent::Update()
 	}
 
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RegisterNeighborGrid");
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RegisterRoadBlockGrid");
+		FBattleFrameStageScope StageScope(TEXT("RegisterRoadBlockGrid"));
 
 		FFilter Filter = FFilter::Make<FLocated, FRoadBlock>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FLocated& Located, FRoadBlock& RoadBlock)
 		{
@@ -337,10 +362,11 @@ void UNeighborGridComponent::Update()
 
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RegisterSubjectSingle");
+		FBattleFrameStageScope StageScope(TEXT("RegisterSubjectSingle"));
 
 		FFilter Filter = FFilter::Make<FLocated, FCollider, FAvoiding>().Exclude<FRegisterMultiple>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FSolidSubjectHandle Subject, FLocated& Located, FCollider& Collider, FAvoiding& Avoiding)
 		{
@@ -363,10 +389,11 @@ void UNeighborGridComponent::Update()
 
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RegisterSubjectMultiple");
+		FBattleFrameStageScope StageScope(TEXT("RegisterSubjectMultiple"));
 
 		FFilter Filter = FFilter::Make<FLocated, FCollider, FAvoiding, FRegisterMultiple>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FSolidSubjectHandle Subject, FLocated& Located, FCollider& Collider, FAvoiding& Avoiding)
 		{
@@ -407,10 +434,11 @@ void UNeighborGridComponent::Update()
 
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("RegisterObstacles");
+		FBattleFrameStageScope StageScope(TEXT("RegisterObstacles"));
 
 		FFilter Filter = FFilter::Make<FLocated, FRVOObstacle, FAvoiding>();
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FSolidSubjectHandle Subject, FRVOObstacle& RVOObstacle, FAvoiding& Avoiding)
 		{
@@ -470,6 +498,8 @@ void UNeighborGridComponent::Decouple()// Tried my best. It takes 10ms to proces
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("RVO2 Decouple");
 
+	WaitForCrowdSimulation();
+
 	const float DeltaTime = GetWorld()->GetDeltaSeconds();
 	const FFilter ObstacleFilter = FFilter::Make<FLocated, FRVOObstacle, FAvoiding>();
 	const FFingerprint ObstacleFilterFingerprint = ObstacleFilter.GetFingerprint();
@@ -480,9 +510,10 @@ void UNeighborGridComponent::Decouple()// Tried my best. It takes 10ms to proces
 	// write Avoid trait
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("write Avoidance trait");
+		FBattleFrameStageScope StageScope(TEXT("write Avoidance trait"));
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FSolidSubjectHandle Subject, FLocated& Located, FCollider& Collider, FMove& Move, FMoving& Moving, FAvoidance& Avoidance, FAvoiding& Avoiding)
 		{
@@ -556,9 +587,10 @@ void UNeighborGridComponent::Decouple()// Tried my best. It takes 10ms to proces
 	// do decouple
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_STR("do decouple");
+		FBattleFrameStageScope StageScope(TEXT("do decouple"));
 
 		auto Chain = Mechanism->EnchainSolid(Filter);
-		UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize(Chain->IterableNum(),MaxThreadsAllowed, ThreadsCount, BatchSize);
+		StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
 
 		Chain->OperateConcurrently([&](FSolidSubjectHandle Subject, FLocated& Located, FCollider& Collider, FMove& Move, FMoving& Moving, FAvoidance& Avoidance)
 		{
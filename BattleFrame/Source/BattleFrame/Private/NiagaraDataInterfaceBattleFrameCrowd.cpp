@@ -0,0 +1,349 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "NiagaraDataInterfaceBattleFrameCrowd.h"
+#include "BattleFrameCrowdBuffer.h"
+#include "NiagaraCompileHashVisitor.h"
+#include "NiagaraComponent.h"
+#include "NiagaraRenderer.h"
+#include "NiagaraShaderParametersBuilder.h"
+#include "NiagaraSystemInstance.h"
+#include "RenderingThread.h"
+#include "RenderResource.h"
+
+#define LOCTEXT_NAMESPACE "NiagaraDataInterfaceBattleFrameCrowd"
+
+namespace NDIBattleFrameCrowd
+{
+	// HLSL 改动时递增
+	static constexpr int32 HLSLVersion = 1;
+
+	static const FName GetInstanceCountName(TEXT("GetInstanceCount"));
+	static const FName GetTransformName(TEXT("GetTransform"));
+	static const FName GetAnimationName(TEXT("GetAnimation"));
+	static const FName GetMaterialFxName(TEXT("GetMaterialFx"));
+	static const FName GetHealthBarName(TEXT("GetHealthBar"));
+	static const FName IsPooledName(TEXT("IsPooled"));
+
+	// 游戏线程上每个系统实例的数据
+	struct FInstanceData
+	{
+		TWeakObjectPtr<UObject> Component;
+		TSharedPtr<FBattleFrameCrowdBuffer> Buffer;
+		uint64 CopiedVersion = 0;
+	};
+
+	// 传给渲染线程的快照，没有变化时为空
+	struct FDataToRenderThread
+	{
+		FBattleFrameCrowdBuffer::FSnapshot Packed;
+	};
+
+	// 渲染线程上每个系统实例的数据
+	struct FInstanceData_RT
+	{
+		FReadBuffer Buffer;
+		int32 CapacityElements = 0;
+		int32 InstanceCount = 0;
+	};
+
+	struct FProxy : public FNiagaraDataInterfaceProxy
+	{
+		virtual int32 PerInstanceDataPassedToRenderThreadSize() const override
+		{
+			return sizeof(FDataToRenderThread);
+		}
+
+		virtual void ConsumePerInstanceDataFromGameThread(void* PerInstanceData, const FNiagaraSystemInstanceID& Instance) override
+		{
+			FDataToRenderThread* DataFromGameThread = static_cast<FDataToRenderThread*>(PerInstanceData);
+			FInstanceData_RT& InstanceData = InstanceData_RT.FindOrAdd(Instance);
+
+			if (DataFromGameThread->Packed.IsValid())
+			{
+				const int32 ElementsNum = DataFromGameThread->Packed->Num();
+				InstanceData.InstanceCount = ElementsNum / FBattleFrameCrowdBuffer::Stride;
+
+				if (ElementsNum > 0)
+				{
+					FRHICommandListImmediate& RHICmdList = FRHICommandListExecutor::GetImmediateCommandList();
+
+					// 容量不足时按 1.5 倍扩容
+					if (ElementsNum > InstanceData.CapacityElements)
+					{
+						InstanceData.Buffer.Release();
+						InstanceData.CapacityElements = FMath::Max(ElementsNum, InstanceData.CapacityElements * 3 / 2);
+						InstanceData.Buffer.Initialize(RHICmdList, TEXT("BattleFrameCrowd"), sizeof(FVector4f), InstanceData.CapacityElements, PF_A32B32G32R32F, BUF_Dynamic);
+					}
+
+					const uint32 Bytes = ElementsNum * sizeof(FVector4f);
+					void* Dest = RHICmdList.LockBuffer(InstanceData.Buffer.Buffer, 0, Bytes, RLM_WriteOnly);
+					FMemory::Memcpy(Dest, DataFromGameThread->Packed->GetData(), Bytes);
+					RHICmdList.UnlockBuffer(InstanceData.Buffer.Buffer);
+				}
+			}
+
+			DataFromGameThread->~FDataToRenderThread();
+		}
+
+		TMap<FNiagaraSystemInstanceID, FInstanceData_RT> InstanceData_RT;
+	};
+}
+
+UNiagaraDataInterfaceBattleFrameCrowd::UNiagaraDataInterfaceBattleFrameCrowd(FObjectInitializer const& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Proxy.Reset(new NDIBattleFrameCrowd::FProxy());
+}
+
+void UNiagaraDataInterfaceBattleFrameCrowd::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		ENiagaraTypeRegistryFlags Flags = ENiagaraTypeRegistryFlags::AllowAnyVariable | ENiagaraTypeRegistryFlags::AllowParameter;
+		FNiagaraTypeRegistry::Register(FNiagaraTypeDefinition(GetClass()), Flags);
+	}
+}
+
+int32 UNiagaraDataInterfaceBattleFrameCrowd::PerInstanceDataSize() const
+{
+	return sizeof(NDIBattleFrameCrowd::FInstanceData);
+}
+
+bool UNiagaraDataInterfaceBattleFrameCrowd::InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	NDIBattleFrameCrowd::FInstanceData* InstanceData = new (PerInstanceData) NDIBattleFrameCrowd::FInstanceData();
+	InstanceData->Component = SystemInstance->GetAttachComponent();
+	return true;
+}
+
+void UNiagaraDataInterfaceBattleFrameCrowd::DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	static_cast<NDIBattleFrameCrowd::FInstanceData*>(PerInstanceData)->~FInstanceData();
+
+	ENQUEUE_RENDER_COMMAND(FNDIBattleFrameCrowdRemoveInstance)(
+		[RT_Proxy = GetProxyAs<NDIBattleFrameCrowd::FProxy>(), InstanceID = SystemInstance->GetId()](FRHICommandListImmediate&)
+		{
+			RT_Proxy->InstanceData_RT.Remove(InstanceID);
+		});
+}
+
+bool UNiagaraDataInterfaceBattleFrameCrowd::PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds)
+{
+	NDIBattleFrameCrowd::FInstanceData* InstanceData = static_cast<NDIBattleFrameCrowd::FInstanceData*>(PerInstanceData);
+
+	// 渲染器可能晚于系统激活才注册
+	if (!InstanceData->Buffer.IsValid())
+	{
+		InstanceData->Buffer = FBattleFrameCrowdBufferRegistry::Get().Find(InstanceData->Component.Get());
+	}
+
+	return false;
+}
+
+void UNiagaraDataInterfaceBattleFrameCrowd::ProvidePerInstanceDataForRenderThread(void* DataForRenderThread, void* PerInstanceData, const FNiagaraSystemInstanceID& SystemInstance)
+{
+	NDIBattleFrameCrowd::FInstanceData* InstanceData = static_cast<NDIBattleFrameCrowd::FInstanceData*>(PerInstanceData);
+	NDIBattleFrameCrowd::FDataToRenderThread* DataToRenderThread = new (DataForRenderThread) NDIBattleFrameCrowd::FDataToRenderThread();
+
+	if (InstanceData->Buffer.IsValid())
+	{
+		// 只取已发布的快照，模拟线程可能正在写入下一帧
+		DataToRenderThread->Packed = InstanceData->Buffer->GetPublished(InstanceData->CopiedVersion);
+	}
+}
+
+#if WITH_EDITORONLY_DATA
+void UNiagaraDataInterfaceBattleFrameCrowd::GetFunctionsInternal(TArray<FNiagaraFunctionSignature>& OutFunctions) const
+{
+	FNiagaraFunctionSignature DefaultSig;
+	DefaultSig.Inputs.Emplace(FNiagaraTypeDefinition(GetClass()), TEXT("Crowd"));
+	DefaultSig.bMemberFunction = true;
+	DefaultSig.bRequiresContext = false;
+	DefaultSig.bSupportsCPU = false;
+	DefaultSig.bSupportsGPU = true;
+
+	{
+		FNiagaraFunctionSignature& Sig = OutFunctions.Add_GetRef(DefaultSig);
+		Sig.Name = NDIBattleFrameCrowd::GetInstanceCountName;
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Count"));
+	}
+
+	FNiagaraFunctionSignature IndexedSig = DefaultSig;
+	IndexedSig.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index"));
+
+	{
+		FNiagaraFunctionSignature& Sig = OutFunctions.Add_GetRef(IndexedSig);
+		Sig.Name = NDIBattleFrameCrowd::GetTransformName;
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetPositionDef(), TEXT("Location"));
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetQuatDef(), TEXT("Orientation"));
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Scale"));
+	}
+
+	{
+		FNiagaraFunctionSignature& Sig = OutFunctions.Add_GetRef(IndexedSig);
+		Sig.Name = NDIBattleFrameCrowd::GetAnimationName;
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetVec4Def(), TEXT("Index0_Index1_PauseTime0_PauseTime1"));
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetVec4Def(), TEXT("TimeStamp0_TimeStamp1_PlayRate0_PlayRate1"));
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetFloatDef(), TEXT("Lerp"));
+	}
+
+	{
+		FNiagaraFunctionSignature& Sig = OutFunctions.Add_GetRef(IndexedSig);
+		Sig.Name = NDIBattleFrameCrowd::GetMaterialFxName;
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetVec4Def(), TEXT("HitGlow_Freeze_Burn_Dissolve"));
+	}
+
+	{
+		FNiagaraFunctionSignature& Sig = OutFunctions.Add_GetRef(IndexedSig);
+		Sig.Name = NDIBattleFrameCrowd::GetHealthBarName;
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Opacity_CurrentRatio_TargetRatio"));
+	}
+
+	{
+		FNiagaraFunctionSignature& Sig = OutFunctions.Add_GetRef(IndexedSig);
+		Sig.Name = NDIBattleFrameCrowd::IsPooledName;
+		Sig.Outputs.Emplace(FNiagaraTypeDefinition::GetBoolDef(), TEXT("Pooled"));
+	}
+}
+
+bool UNiagaraDataInterfaceBattleFrameCrowd::AppendCompileHash(FNiagaraCompileHashVisitor* InVisitor) const
+{
+	bool bSuccess = Super::AppendCompileHash(InVisitor);
+	bSuccess &= InVisitor->UpdatePOD(TEXT("NDIBattleFrameCrowdHLSLVersion"), NDIBattleFrameCrowd::HLSLVersion);
+	bSuccess &= InVisitor->UpdateShaderParameters<FShaderParameters>();
+	return bSuccess;
+}
+
+void UNiagaraDataInterfaceBattleFrameCrowd::GetParameterDefinitionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, FString& OutHLSL)
+{
+	const TMap<FString, FStringFormatArg> TemplateArgs =
+	{
+		{ TEXT("ParameterName"), ParamInfo.DataInterfaceHLSLSymbol },
+	};
+
+	OutHLSL += FString::Format(TEXT(
+		"int {ParameterName}_InstanceCount;\n"
+		"Buffer<float4> {ParameterName}_InstanceData;\n"
+	), TemplateArgs);
+}
+
+bool UNiagaraDataInterfaceBattleFrameCrowd::GetFunctionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, const FNiagaraDataInterfaceGeneratedFunction& FunctionInfo, int FunctionInstanceIndex, FString& OutHLSL)
+{
+	// 与 FBattleFrameCrowdBuffer 的布局一致
+	const TMap<FString, FStringFormatArg> TemplateArgs =
+	{
+		{ TEXT("FunctionName"), FunctionInfo.InstanceName },
+		{ TEXT("ParameterName"), ParamInfo.DataInterfaceHLSLSymbol },
+		{ TEXT("Stride"), FBattleFrameCrowdBuffer::Stride },
+	};
+
+	if (FunctionInfo.DefinitionName == NDIBattleFrameCrowd::GetInstanceCountName)
+	{
+		OutHLSL += FString::Format(TEXT(
+			"void {FunctionName}(out int Count)\n"
+			"{\n"
+			"	Count = {ParameterName}_InstanceCount;\n"
+			"}\n"
+		), TemplateArgs);
+		return true;
+	}
+
+	if (FunctionInfo.DefinitionName == NDIBattleFrameCrowd::GetTransformName)
+	{
+		OutHLSL += FString::Format(TEXT(
+			"void {FunctionName}(int Index, out float3 Location, out float4 Orientation, out float3 Scale)\n"
+			"{\n"
+			"	int Base = clamp(Index, 0, max({ParameterName}_InstanceCount - 1, 0)) * {Stride};\n"
+			"	Location = {ParameterName}_InstanceData[Base + 0].xyz;\n"
+			"	Orientation = {ParameterName}_InstanceData[Base + 1];\n"
+			"	Scale = {ParameterName}_InstanceData[Base + 2].xyz;\n"
+			"}\n"
+		), TemplateArgs);
+		return true;
+	}
+
+	if (FunctionInfo.DefinitionName == NDIBattleFrameCrowd::GetAnimationName)
+	{
+		OutHLSL += FString::Format(TEXT(
+			"void {FunctionName}(int Index, out float4 IndexPause, out float4 TimeRate, out float Lerp)\n"
+			"{\n"
+			"	int Base = clamp(Index, 0, max({ParameterName}_InstanceCount - 1, 0)) * {Stride};\n"
+			"	Lerp = {ParameterName}_InstanceData[Base + 0].w;\n"
+			"	IndexPause = {ParameterName}_InstanceData[Base + 3];\n"
+			"	TimeRate = {ParameterName}_InstanceData[Base + 4];\n"
+			"}\n"
+		), TemplateArgs);
+		return true;
+	}
+
+	if (FunctionInfo.DefinitionName == NDIBattleFrameCrowd::GetMaterialFxName)
+	{
+		OutHLSL += FString::Format(TEXT(
+			"void {FunctionName}(int Index, out float4 MatFx)\n"
+			"{\n"
+			"	int Base = clamp(Index, 0, max({ParameterName}_InstanceCount - 1, 0)) * {Stride};\n"
+			"	MatFx = {ParameterName}_InstanceData[Base + 5];\n"
+			"}\n"
+		), TemplateArgs);
+		return true;
+	}
+
+	if (FunctionInfo.DefinitionName == NDIBattleFrameCrowd::GetHealthBarName)
+	{
+		OutHLSL += FString::Format(TEXT(
+			"void {FunctionName}(int Index, out float3 HealthBar)\n"
+			"{\n"
+			"	int Base = clamp(Index, 0, max({ParameterName}_InstanceCount - 1, 0)) * {Stride};\n"
+			"	HealthBar = {ParameterName}_InstanceData[Base + 6].xyz;\n"
+			"}\n"
+		), TemplateArgs);
+		return true;
+	}
+
+	if (FunctionInfo.DefinitionName == NDIBattleFrameCrowd::IsPooledName)
+	{
+		// 超出范围的实例视为在池中
+		OutHLSL += FString::Format(TEXT(
+			"void {FunctionName}(int Index, out bool Pooled)\n"
+			"{\n"
+			"	Pooled = Index < 0 || Index >= {ParameterName}_InstanceCount || {ParameterName}_InstanceData[Index * {Stride} + 2].w > 0.5f;\n"
+			"}\n"
+		), TemplateArgs);
+		return true;
+	}
+
+	return false;
+}
+#endif
+
+void UNiagaraDataInterfaceBattleFrameCrowd::BuildShaderParameters(FNiagaraShaderParametersBuilder& ShaderParametersBuilder) const
+{
+	ShaderParametersBuilder.AddNestedStruct<FShaderParameters>();
+}
+
+void UNiagaraDataInterfaceBattleFrameCrowd::SetShaderParameters(const FNiagaraDataInterfaceSetShaderParametersContext& Context) const
+{
+	NDIBattleFrameCrowd::FProxy& DIProxy = Context.GetProxy<NDIBattleFrameCrowd::FProxy>();
+	const NDIBattleFrameCrowd::FInstanceData_RT* InstanceData = DIProxy.InstanceData_RT.Find(Context.GetSystemInstanceID());
+
+	FShaderParameters* Parameters = Context.GetParameterNestedStruct<FShaderParameters>();
+
+	if (InstanceData && InstanceData->InstanceCount > 0 && InstanceData->Buffer.SRV.IsValid())
+	{
+		Parameters->InstanceCount = InstanceData->InstanceCount;
+		Parameters->InstanceData = InstanceData->Buffer.SRV;
+	}
+	else
+	{
+		Parameters->InstanceCount = 0;
+		Parameters->InstanceData = FNiagaraRenderer::GetDummyFloat4Buffer();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
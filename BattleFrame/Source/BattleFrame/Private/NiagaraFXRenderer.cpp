@@ -11,6 +11,8 @@
 #include "Traits/SpawningFx.h"
 #include "Traits/Located.h"
 #include "NiagaraDataInterfaceArrayFunctionLibrary.h"
+#include "BattleFrameGameMode.h"
+#include "BattleFrameFunctionLibraryRT.h"
 
 
 ANiagaraFXRenderer::ANiagaraFXRenderer()
@@ -24,6 +26,21 @@ void ANiagaraFXRenderer::BeginPlay()
 {
     Super::BeginPlay();
 
+    SlotPool.Reset(SlotReuse == EFxSlotReuse::LowestIndex);
+
+    // 异步模拟时在模拟完成后再读写集群数据
+    if (ABattleFrameGameMode* GameMode = GetWorld()->GetAuthGameMode<ABattleFrameGameMode>())
+    {
+        GameMode->AddCrowdTickPrerequisite(PrimaryActorTick);
+
+        // 原地特效不再由 QueueFx 生成 Subject，事件直接交给这里
+        if (Mode == EFxMode::InPlace && (!TraitType || TraitType == FSpawningFx::StaticStruct()))
+        {
+            FxEventType = UBattleFrameFunctionLibraryRT::GetSubTypeEnumByStruct(SubType);
+            GameMode->GetFxEvents().Register(FxEventType);
+        }
+    }
+
     if (NiagaraAsset)
     {
         FVector MyLocation = GetActorLocation(); // Get the current Actor's location
@@ -42,6 +59,21 @@ void ANiagaraFXRenderer::BeginPlay()
     }
 }
 
+void ANiagaraFXRenderer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (FxEventType != ESubType::None)
+    {
+        if (ABattleFrameGameMode* GameMode = GetWorld()->GetAuthGameMode<ABattleFrameGameMode>())
+        {
+            GameMode->GetFxEvents().Unregister(FxEventType);
+        }
+
+        FxEventType = ESubType::None;
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void ANiagaraFXRenderer::Tick(float DeltaTime)
 {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("NiagaraFxRendererTick");
@@ -75,6 +107,22 @@ void ANiagaraFXRenderer::Tick(float DeltaTime)
                     Subject.Despawn();
                 });
 
+            if (FxEventType != ESubType::None)
+            {
+                if (ABattleFrameGameMode* GameMode = GetWorld()->GetAuthGameMode<ABattleFrameGameMode>())
+                {
+                    FxEventArray.Reset();
+                    GameMode->GetFxEvents().Consume(FxEventType, FxEventArray);
+
+                    for (const FBattleFrameFxEvent& Event : FxEventArray)
+                    {
+                        NewLocationArray.Add(Event.Location);
+                        NewDirectionArray.Add(Event.Direction);
+                        NewScaleArray.Add(Event.Scale);
+                    }
+                }
+            }
+
             if (SpawnedNiagaraSystem)
             {
                 UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(
@@ -100,10 +148,18 @@ void ANiagaraFXRenderer::Tick(float DeltaTime)
 
         case EFxMode::Attached:
         {
+            PoolTime += DeltaTime;
+            ++PoolFrame;
+
+            // 冷却结束的槽位可以复用
+            SlotPool.Update(PoolTime, SlotCooldown);
+
             FFilter Filter2 = FFilter::Make<FLocated, FDirected, FScaled>().Exclude<FRendering>();
             Filter2 += TraitType;
             Filter2 += SubType;
 
+            EvictedSubjects.Reset();
+
             Mechanism->Operate<FUnsafeChain>(
                 Filter2,
                 [&](FSubjectHandle Subject,
@@ -111,64 +167,64 @@ void ANiagaraFXRenderer::Tick(float DeltaTime)
                     const FDirected& Directed,
                     const FScaled& Scaled)
                 {
+                    bool bNew = false;
+                    bool bEvicted = false;
+                    const int32 NewInstanceId = SlotPool.Allocate(MaxPoolSize, bNew, bEvicted);
+
+                    if (NewInstanceId == INDEX_NONE) return;
+
                     FQuat Rotation{ FQuat::Identity };
                     Rotation = Directed.Direction.Rotation().Quaternion();
                     FVector Scale = Scaled.Factors;
 
                     FTransform SubjectTransform(Rotation, Located.Location, Scale);
 
-                    int32 NewInstanceId;
-                    FRendering Rendering;
-
-                    if (FreeTransforms.Num())
-                    {
-                        // Pick an index which is no longer in cooldown
-                        while (FreeTransforms.Num() && CoolDowns[FreeTransforms.Top()] > 0)
-                        {
-                            FreeTransforms.Pop();
-                        }
-
-                        if (FreeTransforms.Num())
-                        {
-                            NewInstanceId = FreeTransforms.Pop(); // Reuse an existing instance ID
-                            Transforms[NewInstanceId] = SubjectTransform; // Update the corresponding transform
-
-                            LocationArray[NewInstanceId] = SubjectTransform.GetLocation();
-                            OrientationArray[NewInstanceId] = SubjectTransform.GetRotation();
-                            ScaleArray[NewInstanceId] = SubjectTransform.GetScale3D();
-                        }
-                        else
-                        {
-                            Transforms.Add(SubjectTransform);
-                            NewInstanceId = Transforms.Num() - 1;
-
-                            LocationArray.Add(SubjectTransform.GetLocation());
-                            OrientationArray.Add(SubjectTransform.GetRotation());
-                            ScaleArray.Add(SubjectTransform.GetScale3D());
-
-                            CoolDowns.Add(0.0f);
-                            LocationEventArray.Add(true);
-                        }
-                    }
-                    else
+                    if (bNew)
                     {
                         Transforms.Add(SubjectTransform);
-                        NewInstanceId = Transforms.Num() - 1;
-
                         LocationArray.Add(SubjectTransform.GetLocation());
                         OrientationArray.Add(SubjectTransform.GetRotation());
                         ScaleArray.Add(SubjectTransform.GetScale3D());
-
-                        CoolDowns.Add(0.0f);
                         LocationEventArray.Add(true);
+                        SlotSubjects.Add(Subject);
+                        SlotFrames.Add(PoolFrame);
+                        ActiveSlotIndices.Add(INDEX_NONE);
+                    }
+                    else
+                    {
+                        // 挤掉的特效在遍历结束后移除
+                        if (bEvicted)
+                        {
+                            EvictedSubjects.Add(SlotSubjects[NewInstanceId]);
+                        }
+
+                        Transforms[NewInstanceId] = SubjectTransform;
+                        LocationArray[NewInstanceId] = SubjectTransform.GetLocation();
+                        OrientationArray[NewInstanceId] = SubjectTransform.GetRotation();
+                        ScaleArray[NewInstanceId] = SubjectTransform.GetScale3D();
+                        LocationEventArray[NewInstanceId] = true;
+                        SlotSubjects[NewInstanceId] = Subject;
+                        SlotFrames[NewInstanceId] = PoolFrame;
                     }
 
+                    if (ActiveSlotIndices[NewInstanceId] == INDEX_NONE)
+                    {
+                        ActiveSlotIndices[NewInstanceId] = ActiveSlots.Add(NewInstanceId);
+                    }
+
+                    FRendering Rendering;
                     Rendering.InstanceId = NewInstanceId;
 
                     Subject.SetTrait(Rendering);
                 });
 
-            ValidTransforms.Reset();
+            for (FSubjectHandle Evicted : EvictedSubjects)
+            {
+                if (Evicted.IsValid())
+                {
+                    Evicted.Despawn();
+                }
+            }
 
             FFilter Filter3 = FFilter::Make<FLocated, FDirected, FScaled, FRendering>();
             Filter3 += TraitType;
@@ -182,15 +238,17 @@ void ANiagaraFXRenderer::Tick(float DeltaTime)
                     const FScaled& Scaled,
                     FRendering& Rendering)
                 {
+                    int32 InstanceId = Rendering.InstanceId;
+
+                    if (!SlotSubjects.IsValidIndex(InstanceId) || SlotSubjects[InstanceId] != Subject) return;
+
                     FQuat Rotation{ FQuat::Identity };
                     Rotation = Directed.Direction.Rotation().Quaternion();
                     FVector Scale = Scaled.Factors;
 
                     FTransform SubjectTransform(Rotation, Located.Location, Scale);
 
-                    int32 InstanceId = Rendering.InstanceId;
-
-                    ValidTransforms[InstanceId] = true;
+                    SlotFrames[InstanceId] = PoolFrame;
                     Transforms[InstanceId] = SubjectTransform;
 
                     // Update arrays
@@ -199,34 +257,30 @@ void ANiagaraFXRenderer::Tick(float DeltaTime)
                     ScaleArray[InstanceId] = SubjectTransform.GetScale3D();
                 });
 
-            FreeTransforms.Reset();
-
-            for (int32 i = ValidTransforms.IndexOf(false);
-                i < Transforms.Num();
-                i = ValidTransforms.IndexOf(false, i + 1))
+            // 本帧没有被更新的槽位释放并隐藏，冷却后再复用
+            for (int32 i = ActiveSlots.Num() - 1; i >= 0; --i)
             {
-                FreeTransforms.Add(i);
+                const int32 Slot = ActiveSlots[i];
 
-                // Set the cooldown timer to 2 seconds for the released transforms.
-                CoolDowns[i] = 2.0f;
+                if (SlotFrames[Slot] == PoolFrame) continue;
 
-                LocationEventArray[i] = false;
+                SlotPool.Release(Slot, PoolTime);
+                SlotSubjects[Slot] = FSubjectHandle();
 
-                Transforms[i].SetScale3D(FVector::ZeroVector);
-                ScaleArray[i] = FVector::ZeroVector;
+                LocationEventArray[Slot] = false;
 
-                Transforms[i].SetLocation(FVector(0, 0, 100000));
-                LocationArray[i] = FVector(0, 0, 100000);
-            }
+                Transforms[Slot].SetScale3D(FVector::ZeroVector);
+                ScaleArray[Slot] = FVector::ZeroVector;
 
-            // Update CoolDowns array and LocationEvent array every frame by subtracting DeltaTime.
-            for (int32 i = 0; i < CoolDowns.Num(); ++i)
-            {
-                CoolDowns[i] -= DeltaTime;
+                Transforms[Slot].SetLocation(FVector(0, 0, 100000));
+                LocationArray[Slot] = FVector(0, 0, 100000);
+
+                ActiveSlotIndices[Slot] = INDEX_NONE;
+                ActiveSlots.RemoveAtSwap(i, 1, false);
 
-                if (CoolDowns[i] <= 0.0f)
+                if (i < ActiveSlots.Num())
                 {
-                    LocationEventArray[i] = true;
+                    ActiveSlotIndices[ActiveSlots[i]] = i;
                 }
             }
 
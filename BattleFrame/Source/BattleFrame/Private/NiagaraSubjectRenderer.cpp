@@ -21,6 +21,22 @@ ANiagaraSubjectRenderer::ANiagaraSubjectRenderer()
 void ANiagaraSubjectRenderer::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// 异步模拟时在模拟完成后再注册
+	if (ABattleFrameGameMode* GameMode = GetWorld()->GetAuthGameMode<ABattleFrameGameMode>())
+	{
+		GameMode->AddCrowdTickPrerequisite(PrimaryActorTick);
+	}
+}
+
+void ANiagaraSubjectRenderer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (UNiagaraComponent* System : SpawnedNiagaraSystems)
+	{
+		FBattleFrameCrowdBufferRegistry::Get().Unregister(System);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -40,6 +56,12 @@ void ANiagaraSubjectRenderer::Tick(float DeltaTime)
 		}
 		else
 		{
+			if (bPartitionByTiles)
+			{
+				MigrateTiles();
+				RetireIdleBatches(DeltaTime);
+			}
+
 			Register();
 		}
 	}
@@ -50,147 +72,444 @@ void ANiagaraSubjectRenderer::ActivateRenderer()
 	AMechanism* Mechanism = UMachine::ObtainMechanism(GetWorld());
 	if (Mechanism == nullptr) { return; }
 
-	for (int i = 0; i < NumRenderBatch; ++i)
+	// 按格子划分时批次在个体进入格子时才创建
+	if (!bPartitionByTiles)
 	{
-		FSubjectHandle RendererHandle = Mechanism->SpawnSubject(FRenderBatchData{});
-		SpawnedRendererSubjects.Add(RendererHandle);
-		
-		FRenderBatchData* Data = RendererHandle.GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
+		for (int i = 0; i < NumRenderBatch; ++i)
+		{
+			SpawnRenderBatch(GetActorLocation() + FVector(i * 250.f, 0, 0));
+		}
+	}
+
+	isActive = true;
+}
+
+int32 ANiagaraSubjectRenderer::SpawnRenderBatch(const FVector& Location)
+{
+	AMechanism* Mechanism = UMachine::ObtainMechanism(GetWorld());
+	check(Mechanism);
 
-		Data->Scale = Scale;
-		Data->OffsetLocation = OffsetLocation;
-		Data->OffsetRotation = OffsetRotation;
+	FSubjectHandle RendererHandle = Mechanism->SpawnSubject(FRenderBatchData{});
 
-		auto System = UNiagaraFunctionLibrary::SpawnSystemAtLocation(
-			GetWorld(),
-			NiagaraSystemAsset,
-			GetActorLocation() + FVector(i * 250.f, 0, 0),
-			FRotator::ZeroRotator, // rotation
-			FVector(1), // scale
-			false, // auto destroy
-			true, // auto activate
-			ENCPoolMethod::None,
-			true);
+	FRenderBatchData* Data = RendererHandle.GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
 
-		System->SetVariableStaticMesh(TEXT("StaticMesh"), StaticMesh);
+	Data->Scale = Scale;
+	Data->OffsetLocation = OffsetLocation;
+	Data->OffsetRotation = OffsetRotation;
 
-		Data->SpawnedNiagaraSystem = System;
-		SpawnedNiagaraSystems.Add(System);		
+	auto System = UNiagaraFunctionLibrary::SpawnSystemAtLocation(
+		GetWorld(),
+		NiagaraSystemAsset,
+		Location,
+		FRotator::ZeroRotator, // rotation
+		FVector(1), // scale
+		false, // auto destroy
+		true, // auto activate
+		ENCPoolMethod::None,
+		true);
+
+	System->SetVariableStaticMesh(TEXT("StaticMesh"), StaticMesh);
+
+	Data->SpawnedNiagaraSystem = System;
+	SpawnedNiagaraSystems.Add(System);
+
+	if (bUseCrowdDataInterface)
+	{
+		Data->CrowdBuffer = MakeShared<FBattleFrameCrowdBuffer>();
+		FBattleFrameCrowdBufferRegistry::Get().Register(System, Data->CrowdBuffer);
 	}
+	else if (bQuantizeRenderData)
+	{
+		Data->bQuantized = true;
+		Data->QuantizeOrigin = Location;
+		Data->QuantizeStep = FMath::Max(QuantizedLocationStep, 0.01f);
 
-	isActive = true;
+		System->SetVariableVec3(TEXT("Quantize_Origin"), Data->QuantizeOrigin);
+		System->SetVariableFloat(TEXT("Quantize_Step"), Data->QuantizeStep);
+		System->SetVariableBool(TEXT("Quantize_Enabled"), true);
+	}
+
+	BatchIdleTimes.Add(0.f);
+	return SpawnedRendererSubjects.Add(RendererHandle);
+}
+
+void ANiagaraSubjectRenderer::MigrateTiles()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("RenderMigrateTiles");
+
+	AMechanism* Mechanism = UMachine::ObtainMechanism(GetWorld());
+	if (Mechanism == nullptr || SpawnedRendererSubjects.Num() == 0) return;
+
+	FBattleFrameStageScope StageScope(TEXT("RenderMigrateTiles"));
+
+	FFilter Filter = FFilter::Make<FAgent, FRendering, FLocated>();
+	UBattleFrameFunctionLibraryRT::IncludeSubTypeTraitByIndex(SubType.Index, Filter);
+
+	auto Chain = Mechanism->EnchainSolid(Filter);
+	StageScope.CalculateThreadsCountAndBatchSize(Chain->IterableNum(), MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+	const double Margin = TileSize * TileMigrationMargin;
+
+	Chain->OperateConcurrently(
+		[&](FSolidSubjectHandle Subject,
+			const FRendering& Rendering,
+			const FLocated& Located)
+		{
+			FRenderBatchData* Data = Rendering.Renderer.GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
+
+			if (Data == nullptr || !Data->bTiled) return;
+
+			const double MinX = Data->Tile.X * TileSize - Margin;
+			const double MinY = Data->Tile.Y * TileSize - Margin;
+			const double MaxX = (Data->Tile.X + 1) * TileSize + Margin;
+			const double MaxY = (Data->Tile.Y + 1) * TileSize + Margin;
+
+			if (Located.Location.X < MinX || Located.Location.X > MaxX || Located.Location.Y < MinY || Located.Location.Y > MaxY)
+			{
+				// 旧槽位立即放回池中，避免在重新分配前残留一帧；槽位只属于该个体，无需加锁
+				const int32 InstanceId = Rendering.InstanceId;
+
+				if (Data->CrowdBuffer.IsValid())
+				{
+					Data->CrowdBuffer->WritePooled(InstanceId, true);
+				}
+				else
+				{
+					Data->Write(ERenderChannel::InsidePool, Data->InsidePool_Array, InstanceId, true);
+				}
+
+				Data->ReleaseInstance(InstanceId);
+				Subject.RemoveTraitDeferred<FRendering>();
+				StageScope.AddDeferred();
+			}
+
+		}, ThreadsCount, BatchSize);
+
+	Mechanism->ApplyDeferreds();
+}
+
+void ANiagaraSubjectRenderer::RetireIdleBatches(float DeltaTime)
+{
+	bool bRetired = false;
+
+	for (int32 Batch = SpawnedRendererSubjects.Num() - 1; Batch >= 0; --Batch)
+	{
+		const FRenderBatchData* Data = SpawnedRendererSubjects[Batch].GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
+
+		if (Data == nullptr) continue;
+
+		// 没有任何实例时才回收，此时不会有个体引用该批次
+		const bool bIdle = Data->FreeTransforms.Num() == Data->Transforms.Num();
+		BatchIdleTimes[Batch] = bIdle ? BatchIdleTimes[Batch] + DeltaTime : 0.f;
+
+		if (!bIdle || BatchIdleTimes[Batch] < IdleBatchRetireDelay) continue;
+
+		UNiagaraComponent* System = Data->SpawnedNiagaraSystem;
+
+		if (IsValid(System))
+		{
+			FBattleFrameCrowdBufferRegistry::Get().Unregister(System);
+			SpawnedNiagaraSystems.Remove(System);
+			System->DestroyComponent();
+		}
+
+		SpawnedRendererSubjects[Batch].Despawn();
+		SpawnedRendererSubjects.RemoveAt(Batch);
+		BatchIdleTimes.RemoveAt(Batch);
+		bRetired = true;
+	}
+
+	if (bRetired)
+	{
+		TileBatches.Reset();
+
+		for (int32 Batch = 0; Batch < SpawnedRendererSubjects.Num(); ++Batch)
+		{
+			if (const FRenderBatchData* Data = SpawnedRendererSubjects[Batch].GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>())
+			{
+				TileBatches.Add(Data->Tile, Batch);
+			}
+		}
+	}
 }
 
 void ANiagaraSubjectRenderer::Register()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("RenderRegister");
 
-	if (isActive)
-	{
-		AMechanism* Mechanism = UMachine::ObtainMechanism(GetWorld());
-		if (Mechanism == nullptr) return;
+	if (!isActive) return;
+
+	AMechanism* Mechanism = UMachine::ObtainMechanism(GetWorld());
+	if (Mechanism == nullptr) return;
 
-		FFilter Filter = FFilter::Make<FLocated, FDirected, FScaled, FAnimation, FHealthBar, FAnimation>().Exclude<FRendering>();
-        Filter.Include<FAgent>();
-		UBattleFrameFunctionLibraryRT::IncludeSubTypeTraitByIndex(SubType.Index, Filter);
+	FBattleFrameStageScope StageScope(TEXT("RenderRegister"));
 
+	FFilter Filter = FFilter::Make<FLocated, FDirected, FScaled, FAnimation, FHealthBar>().Exclude<FRendering>();
+	Filter.Include<FAgent>();
+	UBattleFrameFunctionLibraryRT::IncludeSubTypeTraitByIndex(SubType.Index, Filter);
+
+	// 按格子划分时先统计各格子的新个体，缺少的批次在遍历结束后创建
+	TMap<FIntPoint, int32> TileCounts;
+
+	if (bPartitionByTiles)
+	{
 		Mechanism->Operate<FUnsafeChain>(Filter,
 			[&](FSubjectHandle Subject,
-				const FLocated& Located,
-				const FDirected& Directed,
-				const FScaled& Scaled,
-				FHealthBar HealthBar,
-				FAnimation Anim)
+				const FLocated& Located)
+			{
+				TileCounts.FindOrAdd(GetTile(Located.Location))++;
+			});
+
+		for (const TPair<FIntPoint, int32>& TileCount : TileCounts)
+		{
+			if (!TileBatches.Contains(TileCount.Key))
 			{
-				FQuat Rotation{ FQuat::Identity };
-				Rotation = Directed.Direction.Rotation().Quaternion();
+				const FVector TileCenter((TileCount.Key.X + 0.5) * TileSize, (TileCount.Key.Y + 0.5) * TileSize, GetActorLocation().Z);
+				const int32 Batch = SpawnRenderBatch(TileCenter);
 
-				FVector FinalScale(Scale);
-				FinalScale *= Scaled.renderFactors;
+				FRenderBatchData* Data = SpawnedRendererSubjects[Batch].GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
+				Data->bTiled = true;
+				Data->Tile = TileCount.Key;
 
-				float Radius = 0.0f;
+				// 个体只会在格子加迁移余量的范围内，固定包围盒免去每帧计算
+				const double HalfSize = TileSize * (0.5 + TileMigrationMargin) + TileBoundsMargin;
+				const FBox TileBounds(FVector(-HalfSize, -HalfSize, -TileBoundsHalfHeight), FVector(HalfSize, HalfSize, TileBoundsHalfHeight));
+				Data->SpawnedNiagaraSystem->SetSystemFixedBounds(TileBounds.ShiftBy(OffsetLocation));
 
-				if (Subject.HasTrait<FCollider>())
-				{
-					const auto Collider = Subject.GetTrait<FCollider>();
-					Radius = Collider.Radius;
-				}
+				TileBatches.Add(TileCount.Key, Batch);
+			}
+		}
+	}
 
-				FTransform SubjectTransform(
-					Rotation * OffsetRotation.Quaternion(),
-					Located.Location + OffsetLocation - FVector(0, 0, Radius),
-					FinalScale);
+	auto Chain = Mechanism->EnchainSolid(Filter);
+	const int32 NewNum = Chain->IterableNum();
+	const int32 BatchesNum = SpawnedRendererSubjects.Num();
 
-				int32 NewInstanceId;
-				FSubjectHandle RendererSubject;
-				FRendering Rendering;
+	if (NewNum == 0 || BatchesNum == 0) return;
 
-				int32 Selector = BatchSelector % NumRenderBatch;
-				Rendering.Renderer = SpawnedRendererSubjects[Selector];
-				FRenderBatchData* Data = Rendering.Renderer.GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
-				if (Data == nullptr) { return; }
+	// 格子模式下每个批次的新个体数量
+	TArray<int32> TiledCounts;
 
-				// Lock the critical section
-				Data->Lock();
+	if (bPartitionByTiles)
+	{
+		TiledCounts.SetNumZeroed(BatchesNum);
 
-				// Check if FreeTransforms has any members
-				if (Data->FreeTransforms.Num())
-				{
-					NewInstanceId = Data->FreeTransforms.Pop(); // Reuse an existing instance ID
-					Data->Transforms[NewInstanceId] = SubjectTransform; // Update the corresponding transform
+		for (const TPair<FIntPoint, int32>& TileCount : TileCounts)
+		{
+			TiledCounts[TileBatches.FindChecked(TileCount.Key)] = TileCount.Value;
+		}
+	}
 
-					Data->LocationArray[NewInstanceId] = SubjectTransform.GetLocation();
-					Data->OrientationArray[NewInstanceId] = SubjectTransform.GetRotation();
-					Data->ScaleArray[NewInstanceId] = SubjectTransform.GetScale3D();
+	// 第 i 个新个体进入批次 (FirstBatch + i) % BatchesNum，是该批次的第 i / BatchesNum 个
+	const int32 FirstBatch = BatchSelector % BatchesNum;
 
-					Data->Anim_Index0_Index1_PauseTime0_PauseTime1_Array[NewInstanceId] = FVector4(Anim.AnimIndex0, Anim.AnimIndex1, Anim.AnimPauseTime0, Anim.AnimPauseTime1);
-					Data->Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array[NewInstanceId] = FVector4(GetGameTimeSinceCreation(), GetGameTimeSinceCreation(), 1, 1);
+	auto CountInBatch = [&](int32 Num, int32 Batch)
+	{
+		if (bPartitionByTiles)
+		{
+			return FMath::Min(Num, TiledCounts[Batch]);
+		}
 
-					Data->Anim_Lerp_Array[NewInstanceId] = 0;
+		const int32 Offset = (Batch - FirstBatch + BatchesNum) % BatchesNum;
+		return Num > Offset ? (Num - Offset + BatchesNum - 1) / BatchesNum : 0;
+	};
 
-					Data->Mat_HitGlow_Freeze_Burn_Dissolve_Array[NewInstanceId] = FVector4(0, 0, 0, 1);
-					Data->HealthBar_Opacity_CurrentRatio_TargetRatio_Array[NewInstanceId] = FVector(HealthBar.Opacity, HealthBar.CurrentRatio, HealthBar.TargetRatio);
+	// 先为每个批次预留好槽位：优先复用空闲槽，不足时所有数组一次性扩容
+	TArray<FRenderBatchData*, TInlineAllocator<8>> BatchData;
+	ReservedSlots.SetNum(BatchesNum);
 
-					Data->InsidePool_Array[NewInstanceId] = false;
-				}
-				else
-				{
-					// Add new instance and get its ID
-					Data->Transforms.Add(SubjectTransform);
-					NewInstanceId = Data->Transforms.Num() - 1;
+	for (int32 Batch = 0; Batch < BatchesNum; ++Batch)
+	{
+		FRenderBatchData* Data = SpawnedRendererSubjects[Batch].GetTraitPtr<FRenderBatchData, EParadigm::Unsafe>();
+		TArray<int32>& Slots = ReservedSlots[Batch];
+		Slots.Reset();
+		BatchData.Add(Data);
+
+		if (Data == nullptr) continue;
+
+		const int32 Count = CountInBatch(NewNum, Batch);
+		const int32 ReusedNum = FMath::Min(Count, Data->FreeTransforms.Num());
+
+		for (int32 i = 0; i < ReusedNum; ++i)
+		{
+			Slots.Add(Data->FreeTransforms.Pop(false));
+		}
+
+		if (Count > ReusedNum)
+		{
+			const int32 First = Data->AddInstances(Count - ReusedNum);
+
+			for (int32 i = 0; i < Count - ReusedNum; ++i)
+			{
+				Slots.Add(First + i);
+			}
+		}
+	}
+
+	const float TimeStamp = GetGameTimeSinceCreation();
+	std::atomic<int32> Cursor{ 0 };
+
+	// 格子模式下各批次已分配的槽位数
+	TArray<int32> BatchCursors;
+	BatchCursors.SetNumZeroed(BatchesNum);
+
+	StageScope.CalculateThreadsCountAndBatchSize(NewNum, MaxThreadsAllowed, ThreadsCount, BatchSize);
+
+	// 每个槽位只属于一个个体，写入时不需要加锁
+	Chain->OperateConcurrently(
+		[&](FSolidSubjectHandle Subject,
+			const FLocated& Located,
+			const FDirected& Directed,
+			const FScaled& Scaled,
+			const FHealthBar& HealthBar,
+			const FAnimation& Anim)
+		{
+			const int32 Index = Cursor.fetch_add(1, std::memory_order_relaxed);
+
+			// 超出预留数量的留到下一帧
+			if (Index >= NewNum) return;
+
+			int32 Batch = (FirstBatch + Index) % BatchesNum;
+			int32 SlotIndex = Index / BatchesNum;
+
+			if (bPartitionByTiles)
+			{
+				const int32* TileBatch = TileBatches.Find(GetTile(Located.Location));
+
+				if (TileBatch == nullptr) return;
+
+				Batch = *TileBatch;
+				SlotIndex = FPlatformAtomics::InterlockedIncrement(&BatchCursors[Batch]) - 1;
+			}
 
-					// SubjectTransform
-					Data->LocationArray.Add(SubjectTransform.GetLocation());
-					Data->OrientationArray.Add(SubjectTransform.GetRotation());
-					Data->ScaleArray.Add(SubjectTransform.GetScale3D());
+			const TArray<int32>& Slots = ReservedSlots[Batch];
+			FRenderBatchData* Data = BatchData[Batch];
 
-					Data->Anim_Index0_Index1_PauseTime0_PauseTime1_Array.Add(FVector4(Anim.AnimIndex0, Anim.AnimIndex1, Anim.AnimPauseTime0, Anim.AnimPauseTime1));
-					Data->Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array.Add(FVector4(GetGameTimeSinceCreation(), GetGameTimeSinceCreation(), 1, 1));
+			if (Data == nullptr || !Slots.IsValidIndex(SlotIndex)) return;
 
-					Data->Anim_Lerp_Array.Add(0);
+			const int32 InstanceId = Slots[SlotIndex];
 
-					Data->Mat_HitGlow_Freeze_Burn_Dissolve_Array.Add(FVector4(0, 0, 0, 1));
-					Data->HealthBar_Opacity_CurrentRatio_TargetRatio_Array.Add(FVector(HealthBar.Opacity, HealthBar.CurrentRatio, HealthBar.TargetRatio));
+			FQuat Rotation{ FQuat::Identity };
+			Rotation = Directed.Direction.Rotation().Quaternion();
 
-					Data->InsidePool_Array.Add(false);
+			FVector FinalScale(Scale);
+			FinalScale *= Scaled.renderFactors;
+
+			float Radius = 0.0f;
+
+			if (const FCollider* Collider = Subject.GetTraitPtr<FCollider, EParadigm::Unsafe>())
+			{
+				Radius = Collider->Radius;
+			}
+
+			FTransform SubjectTransform(
+				Rotation * OffsetRotation.Quaternion(),
+				Located.Location + OffsetLocation - FVector(0, 0, Radius),
+				FinalScale);
+
+			Data->Transforms[InstanceId] = SubjectTransform;
+
+			Data->InstanceSubjects[InstanceId] = FSubjectHandle{ Subject };
+
+			const FVector4 AnimIndex(Anim.AnimIndex0, Anim.AnimIndex1, Anim.AnimPauseTime0, Anim.AnimPauseTime1);
+			const FVector4 AnimTime(TimeStamp, TimeStamp, 1, 1);
+			const FVector4 MatFx(0, 0, 0, 1);
+			const FVector HealthBarValue(HealthBar.Opacity, HealthBar.CurrentRatio, HealthBar.TargetRatio);
+
+			// 使用数据接口时只写打包数据，逐通道的数组不再分配
+			if (Data->CrowdBuffer.IsValid())
+			{
+				FBattleFrameCrowdBuffer& Packed = *Data->CrowdBuffer;
+				Packed.WriteTransform(InstanceId, SubjectTransform.GetLocation(), SubjectTransform.GetRotation(), SubjectTransform.GetScale3D());
+				Packed.WriteAnim(InstanceId, AnimIndex, AnimTime, 0);
+				Packed.WriteMatFx(InstanceId, MatFx);
+				Packed.WriteHealthBar(InstanceId, HealthBarValue);
+				Packed.WritePooled(InstanceId, false);
+			}
+			else
+			{
+				Data->LocationArray[InstanceId] = SubjectTransform.GetLocation();
+				Data->OrientationArray[InstanceId] = SubjectTransform.GetRotation();
+				Data->ScaleArray[InstanceId] = SubjectTransform.GetScale3D();
+
+				Data->Anim_Index0_Index1_PauseTime0_PauseTime1_Array[InstanceId] = AnimIndex;
+				Data->Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array[InstanceId] = AnimTime;
+
+				Data->Anim_Lerp_Array[InstanceId] = 0;
+
+				Data->Mat_HitGlow_Freeze_Burn_Dissolve_Array[InstanceId] = MatFx;
+				Data->HealthBar_Opacity_CurrentRatio_TargetRatio_Array[InstanceId] = HealthBarValue;
+
+				Data->InsidePool_Array[InstanceId] = false;
+
+				if (Data->bQuantized)
+				{
+					Data->Quantized_LocationXY_Array[InstanceId] = FBattleFrameRenderQuantize::EncodeLocationXY(SubjectTransform.GetLocation(), Data->QuantizeOrigin, Data->QuantizeStep);
+					Data->Quantized_LocationZ_Yaw_Array[InstanceId] = FBattleFrameRenderQuantize::EncodeLocationZYaw(SubjectTransform.GetLocation(), SubjectTransform.GetRotation(), Data->QuantizeOrigin, Data->QuantizeStep);
+					Data->Quantized_HitGlow_Freeze_Burn_Dissolve_Array[InstanceId] = FBattleFrameRenderQuantize::EncodeUnorm4(MatFx);
+					Data->Quantized_HealthBar_Array[InstanceId] = FBattleFrameRenderQuantize::EncodeUnorm3(HealthBarValue);
 				}
+			}
+
+			FRendering Rendering;
+			Rendering.Renderer = SpawnedRendererSubjects[Batch];
+			Rendering.InstanceId = InstanceId;
+			Subject.SetTraitDeferred(Rendering);
+			StageScope.AddDeferred();
+
+		}, ThreadsCount, BatchSize);
 
-				// Unlock the critical section
-				Data->Unlock();
+	// 没用上的槽位还回空闲列表
+	const int32 UsedNum = FMath::Min(Cursor.load(std::memory_order_relaxed), NewNum);
 
-				Rendering.InstanceId = NewInstanceId;
-				Subject.SetTrait(Rendering);
-				BatchSelector++;
+	for (int32 Batch = 0; Batch < BatchesNum; ++Batch)
+	{
+		FRenderBatchData* Data = BatchData[Batch];
+
+		if (Data == nullptr) continue;
+
+		const TArray<int32>& Slots = ReservedSlots[Batch];
+
+		const int32 BatchUsedNum = bPartitionByTiles ? FMath::Min(BatchCursors[Batch], Slots.Num()) : CountInBatch(UsedNum, Batch);
+
+		for (int32 i = 0; i < BatchUsedNum; ++i)
+		{
+			Data->MarkDirty(Slots[i]);
+		}
+
+		for (int32 i = BatchUsedNum; i < Slots.Num(); ++i)
+		{
+			Data->FreeTransforms.Add(Slots[i]);
+
+			if (Data->CrowdBuffer.IsValid())
+			{
+				Data->CrowdBuffer->WritePooled(Slots[i], true);
 			}
-		);
+			else
+			{
+				Data->InsidePool_Array[Slots[i]] = true;
+			}
+		}
+	}
+
+	if (!bPartitionByTiles)
+	{
+		BatchSelector += UsedNum;
 	}
+
+	Mechanism->ApplyDeferreds();
 }
 
 bool ANiagaraSubjectRenderer::IdleCheck()
 {
+	if (ABattleFrameGameMode* GameMode = ABattleFrameGameMode::GetInstance())
+	{
+		GameMode->WaitForCrowdSimulation();
+	}
+
 	bool isIdle = true;
 
-	for (int i = 0; i < NumRenderBatch; ++i)
+	for (int i = 0; i < SpawnedRendererSubjects.Num(); ++i)
 	{
 		if (isIdle)
 		{
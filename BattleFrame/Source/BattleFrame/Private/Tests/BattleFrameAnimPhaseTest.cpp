@@ -0,0 +1,53 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "Misc/AutomationTest.h"
+#include "BattleFrameAnimPhase.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameAnimPhaseGroupTest, "BattleFrame.Anim.PhaseGroup", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameAnimPhaseGroupTest::RunTest(const FString& Parameters)
+{
+	constexpr float Tolerance = 1e-3f;
+
+	for (const int32 Groups : { 1, 3, 8 })
+	{
+		for (const float Period : { 0.5f, 1.f, 2.5f })
+		{
+			for (int32 i = 0; i <= 200; ++i)
+			{
+				// 包括恰好落在相位上、周期开头与较大的时间
+				const float TimeStamp = i * Period / 16.f + (i % 7) * 123.f;
+
+				for (uint64 Key = 0; Key < static_cast<uint64>(Groups) * 2; ++Key)
+				{
+					const float Snapped = FBattleFrameAnimPhase::SnapToGroup(TimeStamp, Key, Groups, Period);
+					const FString Context = FString::Printf(TEXT("Groups %d, Period %.2f, Time %.4f, Key %llu"), Groups, Period, TimeStamp, Key);
+
+					TestTrue(Context + TEXT(", not later than the time stamp"), Snapped <= TimeStamp);
+					TestTrue(Context + TEXT(", within one period"), TimeStamp - Snapped < Period + Tolerance);
+
+					// 同组的结果落在同一个相位上
+					const float Phase = Snapped - FMath::FloorToFloat(Snapped / Period) * Period;
+					const float Expected = (Key % Groups) * Period / Groups;
+					const float Delta = FMath::Abs(Phase - Expected);
+
+					TestTrue(Context + TEXT(", on the group phase"), Delta < Tolerance || FMath::Abs(Delta - Period) < Tolerance);
+				}
+			}
+		}
+	}
+
+	// 相位在本周期内还没到时取上一个周期
+	TestEqual(TEXT("Late phase wraps to the previous period"), FBattleFrameAnimPhase::SnapToGroup(10.1f, 3, 4, 1.f), 9.75f, Tolerance);
+	TestEqual(TEXT("Passed phase stays in the current period"), FBattleFrameAnimPhase::SnapToGroup(10.9f, 3, 4, 1.f), 10.75f, Tolerance);
+
+	return true;
+}
+
+#endif
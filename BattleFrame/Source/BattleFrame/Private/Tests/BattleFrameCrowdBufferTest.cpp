@@ -0,0 +1,126 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "Misc/AutomationTest.h"
+#include "BattleFrameCrowdBuffer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameCrowdBufferLayoutTest, "BattleFrame.Render.CrowdBuffer.Layout", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameCrowdBufferLayoutTest::RunTest(const FString& Parameters)
+{
+	using EElement = FBattleFrameCrowdBuffer::EElement;
+	constexpr int32 Stride = FBattleFrameCrowdBuffer::Stride;
+
+	FBattleFrameCrowdBuffer Buffer;
+	Buffer.SetNum(3);
+
+	TestEqual(TEXT("Instances"), Buffer.Num(), 3);
+	TestEqual(TEXT("Floats4"), Buffer.GetData().Num(), 3 * Stride);
+
+	// 新实例在池中，旋转为单位四元数
+	for (int32 Id = 0; Id < Buffer.Num(); ++Id)
+	{
+		TestTrue(TEXT("New instance orientation is identity"), Buffer.Read(Id, EElement::Orientation).Equals(FVector4f(0.f, 0.f, 0.f, 1.f)));
+		TestEqual(TEXT("New instance is pooled"), Buffer.Read(Id, EElement::ScalePooled).W, 1.f);
+	}
+
+	const int32 Id = 1;
+	const FVector Location(100.f, -200.f, 300.f);
+	const FQuat Rotation(FRotator(0.f, 90.f, 0.f));
+	const FVector Scale(1.f, 2.f, 3.f);
+	const FVector4 IndexPause(1.f, 2.f, 3.f, 4.f);
+	const FVector4 TimeRate(5.f, 6.f, 7.f, 8.f);
+	const FVector4 MatFx(0.1f, 0.2f, 0.3f, 0.4f);
+	const FVector HealthBar(0.5f, 0.6f, 0.7f);
+
+	Buffer.WriteTransform(Id, Location, Rotation, Scale);
+	Buffer.WriteAnim(Id, IndexPause, TimeRate, 0.25f);
+	Buffer.WriteMatFx(Id, MatFx);
+	Buffer.WriteHealthBar(Id, HealthBar);
+	Buffer.WritePooled(Id, false);
+
+	// 每个元素都在 Id * Stride + Element
+	const TArray<FVector4f>& Data = Buffer.GetData();
+	const FQuat4f Rotation4f(Rotation);
+
+	TestTrue(TEXT("LocationLerp"), Data[Id * Stride + EElement::LocationLerp].Equals(FVector4f(FVector3f(Location), 0.25f)));
+	TestTrue(TEXT("Orientation"), Data[Id * Stride + EElement::Orientation].Equals(FVector4f(Rotation4f.X, Rotation4f.Y, Rotation4f.Z, Rotation4f.W)));
+	TestTrue(TEXT("ScalePooled"), Data[Id * Stride + EElement::ScalePooled].Equals(FVector4f(FVector3f(Scale), 0.f)));
+	TestTrue(TEXT("AnimIndex"), Data[Id * Stride + EElement::AnimIndex].Equals(FVector4f(IndexPause)));
+	TestTrue(TEXT("AnimTime"), Data[Id * Stride + EElement::AnimTime].Equals(FVector4f(TimeRate)));
+	TestTrue(TEXT("MatFx"), Data[Id * Stride + EElement::MatFx].Equals(FVector4f(MatFx)));
+	TestTrue(TEXT("HealthBar"), Data[Id * Stride + EElement::HealthBar].Equals(FVector4f(FVector3f(HealthBar), 0.f)));
+
+	// 相邻实例不受影响
+	TestTrue(TEXT("Neighbour untouched"), Buffer.Read(0, EElement::LocationLerp).Equals(FVector4f(0.f, 0.f, 0.f, 0.f)));
+	TestEqual(TEXT("Neighbour still pooled"), Buffer.Read(2, EElement::ScalePooled).W, 1.f);
+
+	// 搬移整个实例
+	Buffer.MoveInstance(Id, 2);
+
+	for (int32 Element = 0; Element < Stride; ++Element)
+	{
+		TestTrue(FString::Printf(TEXT("Moved element %d"), Element), Data[2 * Stride + Element].Equals(Data[Id * Stride + Element]));
+	}
+
+	// 增加实例不改动已有的数据
+	Buffer.SetNum(4, false);
+
+	TestTrue(TEXT("Grow keeps data"), Buffer.Read(Id, EElement::MatFx).Equals(FVector4f(MatFx)));
+	TestTrue(TEXT("Grown instance orientation is identity"), Buffer.Read(3, EElement::Orientation).Equals(FVector4f(0.f, 0.f, 0.f, 1.f)));
+	TestEqual(TEXT("Grown instance is pooled"), Buffer.Read(3, EElement::ScalePooled).W, 1.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameCrowdBufferPublishTest, "BattleFrame.Render.CrowdBuffer.Publish", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameCrowdBufferPublishTest::RunTest(const FString& Parameters)
+{
+	FBattleFrameCrowdBuffer Buffer;
+	Buffer.SetNum(2);
+
+	uint64 KnownVersion = Buffer.GetVersion();
+
+	// 没有提交时没有快照
+	TestFalse(TEXT("Unchanged version skips"), Buffer.GetPublished(KnownVersion).IsValid());
+
+	Buffer.WriteMatFx(1, FVector4(1.f, 0.f, 0.f, 0.f));
+	Buffer.Commit();
+
+	const FBattleFrameCrowdBuffer::FSnapshot First = Buffer.GetPublished(KnownVersion);
+
+	TestTrue(TEXT("New version publishes"), First.IsValid());
+	TestTrue(TEXT("Known version follows"), KnownVersion == Buffer.GetVersion());
+	TestEqual(TEXT("Published size"), First->Num(), Buffer.GetData().Num());
+	TestEqual(TEXT("Published data"), FMemory::Memcmp(First->GetData(), Buffer.GetData().GetData(), First->Num() * sizeof(FVector4f)), 0);
+
+	TestFalse(TEXT("Same version skips again"), Buffer.GetPublished(KnownVersion).IsValid());
+
+	// 提交之后的写入与扩容不影响已发布的快照
+	Buffer.WriteMatFx(1, FVector4(0.f, 1.f, 0.f, 0.f));
+	Buffer.SetNum(8);
+
+	TestEqual(TEXT("Snapshot keeps its size"), First->Num(), 2 * FBattleFrameCrowdBuffer::Stride);
+	TestTrue(TEXT("Snapshot keeps its data"), (*First)[1 * FBattleFrameCrowdBuffer::Stride + FBattleFrameCrowdBuffer::MatFx] == FVector4f(1.f, 0.f, 0.f, 0.f));
+
+	// 旧快照仍被持有时，新快照使用另一块内存
+	Buffer.Commit();
+	Buffer.Commit();
+
+	const FBattleFrameCrowdBuffer::FSnapshot Second = Buffer.GetPublished(KnownVersion);
+
+	TestTrue(TEXT("Newer version publishes"), Second.IsValid());
+	TestTrue(TEXT("Snapshots do not alias"), Second.Get() != First.Get());
+	TestEqual(TEXT("Newer snapshot size"), Second->Num(), 8 * FBattleFrameCrowdBuffer::Stride);
+	TestEqual(TEXT("Held snapshot untouched"), First->Num(), 2 * FBattleFrameCrowdBuffer::Stride);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "Misc/AutomationTest.h"
+#include "BattleFrameCulling.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const FVector CameraLocation(100.0, 200.0, 300.0);
+	const FRotator CameraRotation(-20.f, 35.f, 0.f);
+	constexpr float FOV = 90.f;
+	constexpr float Aspect = 16.f / 9.f;
+	constexpr float MaxDistance = 5000.f;
+
+	FBattleFrameCullingView MakeView(float Margin)
+	{
+		return FBattleFrameCullingView::MakePerspective(CameraLocation, CameraRotation, FOV, Aspect, MaxDistance, Margin);
+	}
+
+	// 相机空间坐标：Depth 沿视线，X 向右，Y 向上
+	FVector ToWorld(const FBattleFrameCullingView& View, double Depth, double X, double Y)
+	{
+		return View.Location + View.Forward * Depth + View.Right * X + View.Up * Y;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameCullingViewTest, "BattleFrame.Render.Culling.View", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameCullingViewTest::RunTest(const FString& Parameters)
+{
+	const FBattleFrameCullingView View = MakeView(0.f);
+	const double Depth = 1000.0;
+	const double HalfX = View.HalfWidth * Depth;
+	const double HalfY = View.HalfHeight * Depth;
+
+	TestTrue(TEXT("Enabled"), View.bEnabled);
+	TestFalse(TEXT("Disabled without max distance"), FBattleFrameCullingView::MakePerspective(CameraLocation, CameraRotation, FOV, Aspect, 0.f, 0.f).bEnabled);
+
+	TestTrue(TEXT("Center"), View.IntersectsSphere(ToWorld(View, Depth, 0.0, 0.0), 0.f));
+	TestTrue(TEXT("Inside corner"), View.IntersectsSphere(ToWorld(View, Depth, HalfX * 0.9, HalfY * 0.9), 0.f));
+
+	TestFalse(TEXT("Left"), View.IntersectsSphere(ToWorld(View, Depth, -HalfX * 1.1, 0.0), 0.f));
+	TestFalse(TEXT("Right"), View.IntersectsSphere(ToWorld(View, Depth, HalfX * 1.1, 0.0), 0.f));
+	TestFalse(TEXT("Above"), View.IntersectsSphere(ToWorld(View, Depth, 0.0, HalfY * 1.1), 0.f));
+	TestFalse(TEXT("Below"), View.IntersectsSphere(ToWorld(View, Depth, 0.0, -HalfY * 1.1), 0.f));
+	TestFalse(TEXT("Behind"), View.IntersectsSphere(ToWorld(View, -100.0, 0.0, 0.0), 0.f));
+
+	TestTrue(TEXT("Before max distance"), View.IntersectsSphere(ToWorld(View, MaxDistance - 10.0, 0.0, 0.0), 0.f));
+	TestFalse(TEXT("Beyond max distance"), View.IntersectsSphere(ToWorld(View, MaxDistance + 10.0, 0.0, 0.0), 0.f));
+
+	// 半径让球体跨过平面
+	TestTrue(TEXT("Sphere overlapping the left plane"), View.IntersectsSphere(ToWorld(View, Depth, -HalfX - 10.0, 0.0), 20.f));
+	TestTrue(TEXT("Box overlapping the far plane"), View.IntersectsBox(ToWorld(View, MaxDistance + 10.0, 0.0, 0.0), FVector(20.f)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameCullingMarginTest, "BattleFrame.Render.Culling.Margin", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameCullingMarginTest::RunTest(const FString& Parameters)
+{
+	const float Margin = 50.f;
+	const FBattleFrameCullingView Exact = MakeView(0.f);
+	const FBattleFrameCullingView Widened = MakeView(Margin);
+	const double Depth = 1000.0;
+
+	// 到左侧面的垂直距离为 30 的点
+	const double Slope = FMath::Sqrt(1.0 + Exact.HalfWidth * Exact.HalfWidth);
+	const FVector NearLeft = ToWorld(Exact, Depth, -Exact.HalfWidth * Depth - 30.0 * Slope, 0.0);
+	const FVector FarLeft = ToWorld(Exact, Depth, -Exact.HalfWidth * Depth - 80.0 * Slope, 0.0);
+
+	TestFalse(TEXT("Outside the exact left plane"), Exact.IntersectsSphere(NearLeft, 0.f));
+	TestTrue(TEXT("Within margin of the left plane"), Widened.IntersectsSphere(NearLeft, 0.f));
+	TestFalse(TEXT("Beyond margin of the left plane"), Widened.IntersectsSphere(FarLeft, 0.f));
+
+	TestTrue(TEXT("Within margin of the far plane"), Widened.IntersectsSphere(ToWorld(Widened, MaxDistance + 40.0, 0.0, 0.0), 0.f));
+	TestFalse(TEXT("Beyond margin of the far plane"), Widened.IntersectsSphere(ToWorld(Widened, MaxDistance + 60.0, 0.0, 0.0), 0.f));
+
+	TestFalse(TEXT("Just behind the camera, exact"), Exact.IntersectsSphere(ToWorld(Exact, -10.0, 0.0, 0.0), 0.f));
+	TestTrue(TEXT("Just behind the camera, widened"), Widened.IntersectsSphere(ToWorld(Widened, -10.0, 0.0, 0.0), 0.f));
+
+	// 包围盒包含外推后被接受的点
+	const FBox Bounds = Widened.GetBounds().ExpandBy(1.0);
+
+	TestTrue(TEXT("Bounds contain the margin of the left plane"), Bounds.IsInside(NearLeft));
+	TestTrue(TEXT("Bounds contain the margin of the far plane"), Bounds.IsInside(ToWorld(Widened, MaxDistance + 40.0, 0.0, 0.0)));
+	TestTrue(TEXT("Bounds contain the point behind the camera"), Bounds.IsInside(ToWorld(Widened, -10.0, 0.0, 0.0)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameCullingProjectTest, "BattleFrame.Render.Culling.ProjectToScreen", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameCullingProjectTest::RunTest(const FString& Parameters)
+{
+	const FBattleFrameCullingView View = MakeView(0.f);
+	const double Depth = 2000.0;
+	const double HalfX = View.HalfWidth * Depth * 0.999;
+	const double HalfY = View.HalfHeight * Depth * 0.999;
+	const double Tolerance = 1e-3;
+
+	FVector2D Screen;
+
+	TestTrue(TEXT("Center projects"), View.ProjectToScreen(ToWorld(View, Depth, 0.0, 0.0), Screen));
+	TestTrue(TEXT("Center is (0.5, 0.5)"), Screen.Equals(FVector2D(0.5, 0.5), Tolerance));
+
+	TestTrue(TEXT("Top left projects"), View.ProjectToScreen(ToWorld(View, Depth, -HalfX, HalfY), Screen));
+	TestTrue(TEXT("Top left is (0, 0)"), Screen.Equals(FVector2D(0.0, 0.0), Tolerance));
+
+	TestTrue(TEXT("Bottom right projects"), View.ProjectToScreen(ToWorld(View, Depth, HalfX, -HalfY), Screen));
+	TestTrue(TEXT("Bottom right is (1, 1)"), Screen.Equals(FVector2D(1.0, 1.0), Tolerance));
+
+	TestFalse(TEXT("Off screen"), View.ProjectToScreen(ToWorld(View, Depth, HalfX * 1.2, 0.0), Screen));
+	TestFalse(TEXT("Behind"), View.ProjectToScreen(ToWorld(View, -Depth, 0.0, 0.0), Screen));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameCullingGridTest, "BattleFrame.Render.Culling.Grid", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameCullingGridTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Samples = 48;
+
+	for (const float Margin : { 0.f, 50.f, 500.f })
+	{
+		const FBattleFrameCullingView View = MakeView(Margin);
+
+		FBattleFrameCullingGrid Grid;
+		Grid.Build(View, 200.f);
+
+		TestTrue(TEXT("Grid enabled"), Grid.IsEnabled());
+		TestTrue(TEXT("Some cells visible"), Grid.VisibleCellsNum() > 0);
+
+		// 在包围盒外扩一圈的范围内取样，端点也取到
+		const FBox Bounds = View.GetBounds();
+		const FBox Sampled = Bounds.ExpandBy(Bounds.GetSize().GetMax() * 0.1);
+		int32 AcceptedNum = 0;
+		int32 OutOfBoundsNum = 0;
+		int32 CulledNum = 0;
+
+		for (int32 Z = 0; Z <= Samples; ++Z)
+		{
+			for (int32 Y = 0; Y <= Samples; ++Y)
+			{
+				for (int32 X = 0; X <= Samples; ++X)
+				{
+					const FVector Point = Sampled.Min + Sampled.GetSize() * FVector(X, Y, Z) / Samples;
+
+					if (!View.IntersectsSphere(Point, 0.f)) continue;
+
+					++AcceptedNum;
+					OutOfBoundsNum += !Bounds.ExpandBy(1.0).IsInside(Point);
+					CulledNum += !Grid.IsVisible(Point);
+				}
+			}
+		}
+
+		TestTrue(FString::Printf(TEXT("Margin %.0f, samples accepted"), Margin), AcceptedNum > 0);
+		TestEqual(FString::Printf(TEXT("Margin %.0f, accepted points outside bounds"), Margin), OutOfBoundsNum, 0);
+		TestEqual(FString::Printf(TEXT("Margin %.0f, accepted points culled by grid"), Margin), CulledNum, 0);
+
+		// 恰好在包围盒最大角上的点落在最后一个格子里
+		if (View.IntersectsSphere(Bounds.Max, 0.f))
+		{
+			TestTrue(FString::Printf(TEXT("Margin %.0f, bounds max visible"), Margin), Grid.IsVisible(Bounds.Max));
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "Misc/AutomationTest.h"
+#include "BattleFrameRenderQuantize.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameQuantizeLocationTest, "BattleFrame.Render.Quantize.Location", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameQuantizeLocationTest::RunTest(const FString& Parameters)
+{
+	const FVector Origin(12345.6, -7890.1, 250.0);
+	const FQuat Rotation = FQuat::Identity;
+
+	for (const float Step : { 0.5f, 1.f, 4.f })
+	{
+		const double Range = 32767.0 * Step;
+		const double Tolerance = Step * 0.5 + UE_KINDA_SMALL_NUMBER;
+
+		// 范围内误差不超过半个步长
+		for (int32 i = 0; i <= 100; ++i)
+		{
+			const double Alpha = i / 100.0;
+			const FVector Offset(
+				FMath::Lerp(-Range, Range, Alpha),
+				FMath::Lerp(Range, -Range, Alpha) * 0.37,
+				FMath::Lerp(-Range, Range, Alpha * Alpha) + 0.3 * Step);
+			const FVector Location = Origin + Offset;
+
+			const int32 XY = FBattleFrameRenderQuantize::EncodeLocationXY(Location, Origin, Step);
+			const int32 ZYaw = FBattleFrameRenderQuantize::EncodeLocationZYaw(Location, Rotation, Origin, Step);
+			const FVector Decoded = FBattleFrameRenderQuantize::DecodeLocation(XY, ZYaw, Origin, Step);
+
+			TestTrue(FString::Printf(TEXT("Step %.1f, X within half step at %s"), Step, *Location.ToString()), FMath::Abs(Decoded.X - Location.X) <= Tolerance);
+			TestTrue(FString::Printf(TEXT("Step %.1f, Y within half step at %s"), Step, *Location.ToString()), FMath::Abs(Decoded.Y - Location.Y) <= Tolerance);
+			TestTrue(FString::Printf(TEXT("Step %.1f, Z within half step at %s"), Step, *Location.ToString()), FMath::Abs(Decoded.Z - Location.Z) <= Tolerance);
+		}
+
+		// 范围外夹到 +-32767 个步长
+		const FVector Far = Origin + FVector(Range * 3.0, -Range * 3.0, Range + 10.0 * Step);
+		const FVector Clamped = FBattleFrameRenderQuantize::DecodeLocation(
+			FBattleFrameRenderQuantize::EncodeLocationXY(Far, Origin, Step),
+			FBattleFrameRenderQuantize::EncodeLocationZYaw(Far, Rotation, Origin, Step),
+			Origin, Step);
+
+		TestEqual(TEXT("X clamps to +32767 steps"), Clamped.X, Origin.X + Range, UE_KINDA_SMALL_NUMBER);
+		TestEqual(TEXT("Y clamps to -32767 steps"), Clamped.Y, Origin.Y - Range, UE_KINDA_SMALL_NUMBER);
+		TestEqual(TEXT("Z clamps to +32767 steps"), Clamped.Z, Origin.Z + Range, UE_KINDA_SMALL_NUMBER);
+
+		// 超出范围的位置需要移动原点
+		TestTrue(TEXT("Range edge is in range"), FBattleFrameRenderQuantize::IsInRange(Origin + FVector(Range, -Range, 0.0), Origin, Step));
+		TestFalse(TEXT("Far location is out of range"), FBattleFrameRenderQuantize::IsInRange(Far, Origin, Step));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameQuantizeYawTest, "BattleFrame.Render.Quantize.Yaw", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameQuantizeYawTest::RunTest(const FString& Parameters)
+{
+	const FVector Origin = FVector::ZeroVector;
+	const float HalfStep = 0.5f / FBattleFrameRenderQuantize::YawScale;
+	const float Tolerance = HalfStep + 1e-3f;
+
+	// 包括 360 度附近回绕到 0 的情况
+	for (const float Yaw : { -180.f, -90.f, -0.001f, 0.f, 0.001f, 45.f, 179.999f, 180.f, 270.f, 359.99f, 359.999f, 359.9999f })
+	{
+		const FQuat Rotation(FRotator(0.f, Yaw, 0.f));
+		const int32 ZYaw = FBattleFrameRenderQuantize::EncodeLocationZYaw(FVector::ZeroVector, Rotation, Origin, 1.f);
+		const float Decoded = FBattleFrameRenderQuantize::DecodeYaw(ZYaw);
+
+		TestTrue(FString::Printf(TEXT("Yaw %f decodes into [0, 360)"), Yaw), Decoded >= 0.f && Decoded < 360.f);
+		TestTrue(FString::Printf(TEXT("Yaw %f within half step, got %f"), Yaw, Decoded), FMath::Abs(FMath::FindDeltaAngleDegrees(Yaw, Decoded)) <= Tolerance);
+	}
+
+	// 偏航角不影响高度
+	const FVector Location(0.0, 0.0, 123.0);
+	const int32 ZYaw = FBattleFrameRenderQuantize::EncodeLocationZYaw(Location, FQuat(FRotator(0.f, 359.999f, 0.f)), Origin, 1.f);
+
+	TestEqual(TEXT("Z survives a wrapping yaw"), FBattleFrameRenderQuantize::DecodeLocation(0, ZYaw, Origin, 1.f).Z, 123.0, UE_KINDA_SMALL_NUMBER);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleFrameQuantizeUnormTest, "BattleFrame.Render.Quantize.Unorm", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleFrameQuantizeUnormTest::RunTest(const FString& Parameters)
+{
+	const float Tolerance = 1.f / 510.f + 1e-6f;
+
+	// 误差不超过 1/510
+	for (int32 i = 0; i <= 1000; ++i)
+	{
+		const float A = i / 1000.f;
+		const float B = 1.f - A;
+		const float C = FMath::Frac(A * 7.3f);
+		const float D = FMath::Frac(A * 3.1f + 0.5f);
+
+		const FVector4 Decoded4 = FBattleFrameRenderQuantize::DecodeUnorm4(FBattleFrameRenderQuantize::EncodeUnorm4(FVector4(A, B, C, D)));
+
+		TestTrue(FString::Printf(TEXT("Unorm4 X %f"), A), FMath::Abs(Decoded4.X - A) <= Tolerance);
+		TestTrue(FString::Printf(TEXT("Unorm4 Y %f"), B), FMath::Abs(Decoded4.Y - B) <= Tolerance);
+		TestTrue(FString::Printf(TEXT("Unorm4 Z %f"), C), FMath::Abs(Decoded4.Z - C) <= Tolerance);
+		TestTrue(FString::Printf(TEXT("Unorm4 W %f"), D), FMath::Abs(Decoded4.W - D) <= Tolerance);
+
+		const FVector Decoded3 = FBattleFrameRenderQuantize::DecodeUnorm3(FBattleFrameRenderQuantize::EncodeUnorm3(FVector(D, C, B)));
+
+		TestTrue(FString::Printf(TEXT("Unorm3 X %f"), D), FMath::Abs(Decoded3.X - D) <= Tolerance);
+		TestTrue(FString::Printf(TEXT("Unorm3 Y %f"), C), FMath::Abs(Decoded3.Y - C) <= Tolerance);
+		TestTrue(FString::Printf(TEXT("Unorm3 Z %f"), B), FMath::Abs(Decoded3.Z - B) <= Tolerance);
+	}
+
+	// 范围外夹到 [0, 1]，各通道互不影响
+	const FVector4 Clamped = FBattleFrameRenderQuantize::DecodeUnorm4(FBattleFrameRenderQuantize::EncodeUnorm4(FVector4(-1.f, 2.f, 1.f, 0.f)));
+
+	TestEqual(TEXT("Clamp below"), Clamped.X, 0.0);
+	TestEqual(TEXT("Clamp above"), Clamped.Y, 1.0);
+	TestEqual(TEXT("Full channel"), Clamped.Z, 1.0);
+	TestEqual(TEXT("Empty channel"), Clamped.W, 0.0);
+
+	return true;
+}
+
+#endif
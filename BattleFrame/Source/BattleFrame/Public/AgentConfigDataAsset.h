@@ -136,4 +136,8 @@ public:
 
     UAgentConfigDataAsset() {}
 
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 };
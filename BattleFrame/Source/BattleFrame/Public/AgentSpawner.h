@@ -68,6 +68,8 @@ private:
 
 	static AAgentSpawner* Instance;
 
+	// 已生成的个体序号，作为生成位置随机数的键
+	uint64 SpawnSequence = 0;
 
 protected:
 
@@ -0,0 +1,26 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Shared animation phases for animation LOD. Looping animations of distant agents start at one of Groups phases
+ * spread evenly over Period, agents in the same group move in step. Groups must be at least 1 and Period positive.
+ */
+struct BATTLEFRAME_API FBattleFrameAnimPhase
+{
+	// 不晚于 TimeStamp 的最近一个属于 Key 所在组的相位，结果落在 (TimeStamp - Period, TimeStamp]
+	static FORCEINLINE float SnapToGroup(float TimeStamp, uint64 Key, int32 Groups, float Period)
+	{
+		const float Base = FMath::FloorToFloat(TimeStamp / Period) * Period;
+		const float Snapped = Base + static_cast<float>(Key % static_cast<uint64>(Groups)) * Period / Groups;
+
+		// 本周期内的相位还没到时取上一个周期，动画不会从未来开始
+		return Snapped > TimeStamp ? Snapped - Period : Snapped;
+	}
+};
@@ -0,0 +1,88 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Traits/Curves.h"
+
+class UAgentConfigDataAsset;
+
+// 预烘焙的单条曲线，从 0 到最后一个关键帧等距采样
+struct BATTLEFRAME_API FBakedCurve
+{
+	static constexpr int32 SamplesNum = 64;
+
+	float EndTime = 0.f;
+	float SamplesPerSecond = 0.f;
+	float Samples[SamplesNum] = {};
+
+	void Bake(const FRichCurve& Curve);
+
+	// 超出范围时取两端的值
+	FORCEINLINE float Eval(float Time) const
+	{
+		const float Position = FMath::Clamp(Time * SamplesPerSecond, 0.f, float(SamplesNum - 1));
+		const int32 Index = FMath::Min(int32(Position), SamplesNum - 2);
+
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+	}
+};
+
+struct BATTLEFRAME_API FBakedCurveSet
+{
+	FBakedCurve DissolveIn;
+	FBakedCurve DissolveOut;
+	FBakedCurve HitEmission;
+	FBakedCurve HitSqueezeSquash;
+};
+
+/**
+ * Shared, immutable lookup tables of the FCurves of every agent config data asset. A data asset is baked the first
+ * time an agent of it is spawned and the agents only keep the index of the set (FBakedCurves), empty curves fall
+ * back to the FCurves defaults at bake time.
+ * Baking happens on the game thread, Get may be called from any thread. Every data asset owns one set for as long as
+ * the module is loaded. Invalidating only marks it, the set is re-baked in place by RebakeInvalidated between frames
+ * or by the next FindOrBake, both of which must not overlap with the simulation. Sets are never freed or moved.
+ */
+class BATTLEFRAME_API FBattleFrameCurveRegistry
+{
+public:
+
+	static FBattleFrameCurveRegistry& Get();
+
+	int32 FindOrBake(const UAgentConfigDataAsset* DataAsset);
+
+	// 数据资产的曲线被修改后调用，标记为需要重新烘焙
+	void Invalidate(const UAgentConfigDataAsset* DataAsset);
+
+	// 在原槽位重新烘焙被标记的数据资产，在两帧之间的游戏线程调用
+	void RebakeInvalidated();
+
+	// 没有烘焙过的个体（Index 为 INDEX_NONE）使用 FCurves 的默认曲线
+	FORCEINLINE const FBakedCurveSet& GetSet(int32 Index) const
+	{
+		return Index != INDEX_NONE && Index < Sets.Num() ? *Sets[Index] : DefaultSet;
+	}
+
+private:
+
+	FBattleFrameCurveRegistry();
+
+	static void Bake(FBakedCurveSet& Set, const UAgentConfigDataAsset* DataAsset);
+
+	// 预留足够的指针，工作线程不加锁读取，数组不能扩容
+	static constexpr int32 ReservedSetsNum = 1024;
+
+	FCriticalSection Mutex;
+	TMap<FObjectKey, int32> Indices;
+	TArray<TUniquePtr<FBakedCurveSet>> Sets;
+	FBakedCurveSet DefaultSet;
+
+	// 等待重新烘焙的数据资产
+	TMap<FObjectKey, TWeakObjectPtr<const UAgentConfigDataAsset>> Invalidated;
+};
@@ -0,0 +1,124 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Packed, interleaved per-instance render state of one render batch, read by UNiagaraDataInterfaceBattleFrameCrowd.
+ * Every instance takes Stride float4, the layout below is mirrored by the HLSL of the data interface. Writing
+ * different instances from different threads is safe, resizing and Commit belong to the thread running the
+ * simulation. Commit publishes a snapshot, the data interface only ever reads published snapshots.
+ */
+class BATTLEFRAME_API FBattleFrameCrowdBuffer
+{
+public:
+
+	// 每个实例占用的 float4 数量与各自的内容
+	static constexpr int32 Stride = 7;
+
+	enum EElement : int32
+	{
+		LocationLerp = 0, // xyz 位置，w 动画混合
+		Orientation = 1,  // 旋转四元数
+		ScalePooled = 2,  // xyz 缩放，w 是否在池中
+		AnimIndex = 3,    // Index0, Index1, PauseTime0, PauseTime1
+		AnimTime = 4,     // TimeStamp0, TimeStamp1, PlayRate0, PlayRate1
+		MatFx = 5,        // HitGlow, Freeze, Burn, Dissolve
+		HealthBar = 6     // Opacity, CurrentRatio, TargetRatio
+	};
+
+	// 调整实例数量，新实例在池中
+	void SetNum(int32 InstancesNum, bool bAllowShrinking = true);
+
+	int32 Num() const { return Data.Num() / Stride; }
+
+	FORCEINLINE void WriteTransform(int32 Id, const FVector& Location, const FQuat& Rotation, const FVector& Scale)
+	{
+		const FQuat4f Rotation4f(Rotation);
+		FVector4f* Instance = &Data[Id * Stride];
+		Instance[LocationLerp] = FVector4f(FVector3f(Location), Instance[LocationLerp].W);
+		Instance[Orientation] = FVector4f(Rotation4f.X, Rotation4f.Y, Rotation4f.Z, Rotation4f.W);
+		Instance[ScalePooled] = FVector4f(FVector3f(Scale), Instance[ScalePooled].W);
+	}
+
+	FORCEINLINE void WriteAnim(int32 Id, const FVector4& IndexPause, const FVector4& TimeRate, float Lerp)
+	{
+		FVector4f* Instance = &Data[Id * Stride];
+		Instance[LocationLerp].W = Lerp;
+		Instance[AnimIndex] = FVector4f(IndexPause);
+		Instance[AnimTime] = FVector4f(TimeRate);
+	}
+
+	FORCEINLINE void WriteMatFx(int32 Id, const FVector4& Value)
+	{
+		Data[Id * Stride + MatFx] = FVector4f(Value);
+	}
+
+	FORCEINLINE void WriteHealthBar(int32 Id, const FVector& Value)
+	{
+		Data[Id * Stride + HealthBar] = FVector4f(FVector3f(Value), 0.f);
+	}
+
+	FORCEINLINE void WritePooled(int32 Id, bool bPooled)
+	{
+		Data[Id * Stride + ScalePooled].W = bPooled ? 1.f : 0.f;
+	}
+
+	// 整个实例搬到另一个位置，用于紧凑排列
+	FORCEINLINE void MoveInstance(int32 From, int32 To)
+	{
+		FMemory::Memcpy(&Data[To * Stride], &Data[From * Stride], Stride * sizeof(FVector4f));
+	}
+
+	FORCEINLINE const FVector4f& Read(int32 Id, EElement Element) const
+	{
+		return Data[Id * Stride + Element];
+	}
+
+	const TArray<FVector4f>& GetData() const { return Data; }
+
+	using FSnapshot = TSharedPtr<const TArray<FVector4f>, ESPMode::ThreadSafe>;
+
+	// 本帧写入完成，复制一份快照发布给数据接口
+	void Commit();
+
+	uint64 GetVersion() const;
+
+	// 最近发布的快照，版本与 KnownVersion 相同时返回空，可在任意线程调用
+	FSnapshot GetPublished(uint64& KnownVersion) const;
+
+private:
+
+	TArray<FVector4f> Data;
+
+	// 已发布的快照与版本，由 Mutex 保护
+	mutable FCriticalSection Mutex;
+	TSharedPtr<TArray<FVector4f>, ESPMode::ThreadSafe> Published;
+	uint64 Version = 0;
+
+	// 上一份快照，没有其他持有者时复用其内存，只在 Commit 中访问
+	TSharedPtr<TArray<FVector4f>, ESPMode::ThreadSafe> Spare;
+};
+
+// 按 Niagara 组件查找渲染批次的数据
+class BATTLEFRAME_API FBattleFrameCrowdBufferRegistry
+{
+public:
+
+	static FBattleFrameCrowdBufferRegistry& Get();
+
+	void Register(const UObject* Component, const TSharedPtr<FBattleFrameCrowdBuffer>& Buffer);
+	void Unregister(const UObject* Component);
+	TSharedPtr<FBattleFrameCrowdBuffer> Find(const UObject* Component) const;
+
+private:
+
+	mutable FCriticalSection Mutex;
+	TMap<FObjectKey, TSharedPtr<FBattleFrameCrowdBuffer>> Buffers;
+};
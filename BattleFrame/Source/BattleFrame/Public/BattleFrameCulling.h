@@ -0,0 +1,126 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Perspective view volume used to cull agents on the CPU. Built from plain camera values so it works without a
+ * viewport or RHI. The side planes meet at the camera, the far plane sits at MaxDistance, all normals point inward
+ * and every test is widened by Margin.
+ */
+struct BATTLEFRAME_API FBattleFrameCullingView
+{
+	bool bEnabled = false;
+	FVector Location = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+	FVector Right = FVector::RightVector;
+	FVector Up = FVector::UpVector;
+	float HalfWidth = 1.f;  // tan(水平视角 / 2)
+	float HalfHeight = 1.f; // tan(垂直视角 / 2)
+	float MaxDistance = 0.f;
+	float Margin = 0.f;
+
+	// 左、右、下、上、远
+	FPlane Planes[5];
+
+	// FOVDegrees 为水平视角，AspectRatio 为宽 / 高
+	static FBattleFrameCullingView MakePerspective(const FVector& Location, const FRotator& Rotation, float FOVDegrees, float AspectRatio, float MaxDistance, float Margin);
+
+	FORCEINLINE bool IntersectsSphere(const FVector& Center, float Radius) const
+	{
+		for (const FPlane& Plane : Planes)
+		{
+			if (Plane.PlaneDot(Center) < -(Radius + Margin))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	FORCEINLINE bool IntersectsBox(const FVector& Center, const FVector& Extent) const
+	{
+		for (const FPlane& Plane : Planes)
+		{
+			const float PushOut = FMath::Abs(Plane.X * Extent.X) + FMath::Abs(Plane.Y * Extent.Y) + FMath::Abs(Plane.Z * Extent.Z);
+
+			if (Plane.PlaneDot(Center) < -(PushOut + Margin))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// 外推 Margin 后视锥的包围盒
+	FBox GetBounds() const;
+
+	// 投影到屏幕，左上为 (0, 0)，右下为 (1, 1)，不在屏幕内时返回 false
+	FORCEINLINE bool ProjectToScreen(const FVector& Point, FVector2D& OutScreen) const
+	{
+		const FVector Delta = Point - Location;
+		const float Depth = FVector::DotProduct(Delta, Forward);
+
+		if (Depth <= KINDA_SMALL_NUMBER) return false;
+
+		const float X = FVector::DotProduct(Delta, Right) / (Depth * HalfWidth);
+		const float Y = FVector::DotProduct(Delta, Up) / (Depth * HalfHeight);
+
+		if (FMath::Abs(X) > 1.f || FMath::Abs(Y) > 1.f) return false;
+
+		OutScreen = FVector2D(X * 0.5f + 0.5f, 0.5f - Y * 0.5f);
+		return true;
+	}
+};
+
+/**
+ * Coarse visibility grid over the bounds of a culling view. Each cell is tested once per frame, an agent is visible
+ * when the cell it stands in is. Cells grow when the bounds would need more than MaxCellsPerAxis per axis, so a far
+ * view costs the same to build as a near one.
+ */
+struct BATTLEFRAME_API FBattleFrameCullingGrid
+{
+	static constexpr int32 MaxCellsPerAxis = 32;
+
+	void Build(const FBattleFrameCullingView& View, float CellSize);
+
+	void Reset() { bEnabled = false; }
+
+	bool IsEnabled() const { return bEnabled; }
+
+	// 可在并行操作中调用
+	FORCEINLINE bool IsVisible(const FVector& Location) const
+	{
+		if (!bEnabled) return true;
+
+		const FVector Local = (Location - Bounds.Min) * InvCellSize;
+
+		if (Local.X < 0 || Local.Y < 0 || Local.Z < 0) return false;
+
+		const int32 X = static_cast<int32>(Local.X);
+		const int32 Y = static_cast<int32>(Local.Y);
+		const int32 Z = static_cast<int32>(Local.Z);
+
+		if (X >= CellsNum.X || Y >= CellsNum.Y || Z >= CellsNum.Z) return false;
+
+		return Cells[(Z * CellsNum.Y + Y) * CellsNum.X + X];
+	}
+
+	int32 VisibleCellsNum() const { return VisibleNum; }
+
+private:
+
+	bool bEnabled = false;
+	FBox Bounds = FBox(ForceInit);
+	float InvCellSize = 0.f;
+	FIntVector CellsNum = FIntVector::ZeroValue;
+	TArray<bool> Cells;
+	int32 VisibleNum = 0;
+};
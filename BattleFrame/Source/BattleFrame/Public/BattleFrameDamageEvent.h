@@ -0,0 +1,74 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SubjectHandle.h"
+#include "Traits/DmgSphere.h"
+#include "Traits/Debuff.h"
+
+enum class EBattleFrameDamageFlags : uint8
+{
+	None = 0,
+	Critical = 1 << 0, // 暴击
+	Temporal = 1 << 1  // 持续伤害
+};
+
+ENUM_CLASS_FLAGS(EBattleFrameDamageFlags)
+
+// 伤害类型，混合伤害取占比最大的一种
+enum class EBattleFrameDamageType : uint8
+{
+	Normal,
+	Kinetic,
+	Fire,
+	Ice,
+	Percent,
+
+	Num
+};
+
+// 一次待结算的伤害
+struct BATTLEFRAME_API FBattleFrameDamageEvent
+{
+	FSubjectHandle Target;
+	FSubjectHandle Instigator;
+	float Amount = 0.f;
+	EBattleFrameDamageFlags Flags = EBattleFrameDamageFlags::None;
+	EBattleFrameDamageType Type = EBattleFrameDamageType::Normal;
+};
+
+// 攻击者对目标的一次伤害请求，并行代码可先收集再统一结算
+struct BATTLEFRAME_API FBattleFrameDamagePair
+{
+	FSubjectHandle Instigator;
+	FSubjectHandle Target;
+	FVector HitFromLocation = FVector::ZeroVector;
+	FDmgSphere DmgSphere;
+	FDebuff Debuff;
+};
+
+/**
+ * Damage events grouped by target for the resolution pass. Targets keep the order in which they were first hit and
+ * the events of one target keep the order in which they were added. The arrays are reused between frames.
+ */
+struct BATTLEFRAME_API FBattleFrameDamageBatch
+{
+	// 按目标分组后的事件，第 i 个目标的事件为 [Offsets[i], Offsets[i + 1])
+	TArray<FBattleFrameDamageEvent> Events;
+	TArray<FSubjectHandle> Targets;
+	TArray<int32> Offsets;
+
+	// 对 Unsorted 做计数排序
+	void Build(const TArray<FBattleFrameDamageEvent>& Unsorted);
+
+private:
+
+	TMap<FSubjectHandle, int32> TargetIndices;
+	TArray<int32> Buckets;
+	TArray<int32> Cursors;
+};
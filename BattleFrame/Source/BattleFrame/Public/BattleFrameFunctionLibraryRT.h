@@ -27,6 +27,7 @@ public:
 
     static void SetSubTypeTraitByIndex(int32 Index, FSubjectRecord& SubjectRecord);
     static void SetSubTypeTraitByEnum(ESubType SubType, FSubjectRecord& SubjectRecord);
+    static ESubType GetSubTypeEnumByStruct(const UScriptStruct* SubType);
     static void IncludeSubTypeTraitByIndex(int32 Index, FFilter& Filter);
     static void CalculateThreadsCountAndBatchSize(int32 IterableNum, int32& MaxThreadsAllowed, int32& ThreadsCount, int32& BatchSize);
 };
@@ -0,0 +1,139 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+// C++
+#include <atomic>
+
+// Unreal
+#include "CoreMinimal.h"
+
+// BattleFrame
+#include "BattleFramePerThreadBuffer.h"
+#include "BattleFrameCulling.h"
+#include "Traits/SubType.h"
+
+#include "BattleFrameFxEvent.generated.h"
+
+UENUM(BlueprintType)
+enum class EBattleFrameFxCategory : uint8
+{
+	Appear,
+	Attack,
+	Hit,
+	Death,
+
+	Num UMETA(Hidden)
+};
+
+// 每帧特效数量上限与优先级评分，上限为 0 表示不限
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBattleFrameFxBudget
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	int32 MaxAppearFxPerFrame = 64;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	int32 MaxAttackFxPerFrame = 128;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	int32 MaxHitFxPerFrame = 128;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	int32 MaxDeathFxPerFrame = 64;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "屏幕按 N x N 分区，每个分区单独限量，屏幕外算作一个分区", ClampMin = "1", ClampMax = "16"))
+	int32 ScreenRegions = 4;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "每个屏幕分区每帧最多的特效", ClampMin = "0"))
+	int32 MaxFxPerScreenRegion = 32;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "距离得分从相机处的满分线性降到此距离处的 0", ClampMin = "1"))
+	float FalloffDistance = 5000.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	float DistanceScore = 1.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	float CriticalScore = 1.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+	float KillScore = 2.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "玩家造成或受到的特效", ClampMin = "0"))
+	float PlayerScore = 4.f;
+
+	int32 GetMaxPerFrame(EBattleFrameFxCategory Category) const;
+
+	float Score(float Distance, bool bCritical, bool bKill, bool bPlayer) const
+	{
+		return DistanceScore * FMath::Clamp(1.f - Distance / FalloffDistance, 0.f, 1.f)
+			+ (bCritical ? CriticalScore : 0.f)
+			+ (bKill ? KillScore : 0.f)
+			+ (bPlayer ? PlayerScore : 0.f);
+	}
+};
+
+// 一次即发即弃的特效
+struct BATTLEFRAME_API FBattleFrameFxEvent
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+	FVector Scale = FVector::OneVector;
+	ESubType SubType = ESubType::None;
+	EBattleFrameFxCategory Category = EBattleFrameFxCategory::Hit;
+	float Priority = 0.f;
+	uint64 Key = 0; // 同分时按此排序，与线程调度无关
+};
+
+/**
+ * Fire and forget effects handed straight to the in place FX renderer of their type, no subject is spawned. Adding
+ * takes no lock, Distribute sorts the events into one array per type once a frame and each renderer takes its own
+ * array with Consume. With a budget, Distribute first keeps the best scored events within the per category and per
+ * screen region caps, the order only depends on score and key so the same frame keeps the same effects. Events of
+ * types without a registered renderer are handed back for the caller to spawn as subjects. Register, Distribute and
+ * Consume run on the game thread.
+ */
+class BATTLEFRAME_API FBattleFrameFxEventQueue
+{
+public:
+
+	static constexpr int32 TypesNum = 256;
+
+	FBattleFrameFxEventQueue();
+
+	void Register(ESubType SubType);
+	void Unregister(ESubType SubType);
+
+	FORCEINLINE bool IsRegistered(ESubType SubType) const
+	{
+		return RegisteredNum[static_cast<uint8>(SubType)].load(std::memory_order_relaxed) > 0;
+	}
+
+	FORCEINLINE void Add(const FBattleFrameFxEvent& Event)
+	{
+		Events.Add(Event);
+	}
+
+	// 合并各线程的事件，按预算筛选后按类型分组，没有渲染器的类型放入 OutUnrouted，返回丢弃的数量
+	int32 Distribute(const FBattleFrameFxBudget* Budget, const FBattleFrameCullingView& View, TArray<FBattleFrameFxEvent>& OutUnrouted);
+
+	// 取出该类型的事件追加到 Out
+	void Consume(ESubType SubType, TArray<FBattleFrameFxEvent>& Out);
+
+private:
+
+	TBattleFramePerThreadBuffer<FBattleFrameFxEvent> Events;
+	TArray<FBattleFrameFxEvent> MergedEvents;
+	TArray<int32> RegionCounts;
+	TArray<FBattleFrameFxEvent> Buckets[TypesNum];
+	std::atomic<int32> RegisteredNum[TypesNum];
+};
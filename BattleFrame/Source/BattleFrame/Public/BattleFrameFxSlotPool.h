@@ -0,0 +1,106 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Instance slots of an attached FX renderer. Released slots wait in a queue ordered by release time and become
+ * reusable once their cooldown has passed, so allocating and releasing cost O(1) (O(log n) when the lowest index is
+ * preferred) and nothing is scanned per frame. When the pool is at its maximum size the oldest live effect gives up
+ * its slot.
+ */
+class BATTLEFRAME_API FBattleFrameFxSlotPool
+{
+public:
+
+	// bLowestIndexFirst 时优先复用序号小的槽位，数组末尾的槽位更容易一直空闲；否则按释放先后复用
+	void Reset(bool bInLowestIndexFirst);
+
+	int32 Num() const { return SerialsBySlot.Num(); }
+
+	int32 GetActiveNum() const { return ActiveNum; }
+
+	// 释放后超过 Cooldown 的槽位变为可用，冷却时间可随时修改
+	void Update(double Now, double Cooldown);
+
+	// MaxNum 为 0 表示不限。返回 INDEX_NONE 表示没有槽位；新建槽位时 bOutNew 为 true；挤掉旧特效时 bOutEvicted 为 true
+	int32 Allocate(int32 MaxNum, bool& bOutNew, bool& bOutEvicted);
+
+	void Release(int32 Slot, double ReleaseTime);
+
+private:
+
+	// 数组加队首下标的先进先出队列
+	template<typename ElementType>
+	struct TFifo
+	{
+		TArray<ElementType> Items;
+		int32 Head = 0;
+
+		bool IsEmpty() const { return Head == Items.Num(); }
+
+		int32 Num() const { return Items.Num() - Head; }
+
+		const ElementType& First() const { return Items[Head]; }
+
+		void Push(const ElementType& Item) { Items.Add(Item); }
+
+		ElementType Pop()
+		{
+			ElementType Item = Items[Head++];
+
+			// 队首之前的空间过半时整体前移
+			if (Head == Items.Num())
+			{
+				Items.Reset();
+				Head = 0;
+			}
+			else if (Head >= 1024 && Head * 2 >= Items.Num())
+			{
+				Items.RemoveAt(0, Head, false);
+				Head = 0;
+			}
+
+			return Item;
+		}
+
+		void Reset()
+		{
+			Items.Reset();
+			Head = 0;
+		}
+	};
+
+	struct FCooling
+	{
+		double ReleaseTime = 0.0;
+		int32 Slot = INDEX_NONE;
+	};
+
+	struct FSpawned
+	{
+		uint32 Serial = 0;
+		int32 Slot = INDEX_NONE;
+	};
+
+	void Occupy(int32 Slot);
+
+	bool bLowestIndexFirst = false;
+
+	TFifo<FCooling> Cooling;
+	TFifo<int32> Ready;
+	TArray<int32> ReadyHeap;
+
+	// 按占用先后排列，槽位已释放或被重新占用的条目在出队时跳过
+	TFifo<FSpawned> Spawned;
+
+	// 槽位当前占用的序号，0 表示空闲
+	TArray<uint32> SerialsBySlot;
+	uint32 NextSerial = 1;
+	int32 ActiveNum = 0;
+};
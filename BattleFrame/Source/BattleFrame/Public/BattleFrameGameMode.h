@@ -16,6 +16,9 @@
 #include "Sound/SoundBase.h"
 #include "Engine/World.h"
 #include "HAL/PlatformMisc.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Tasks/Task.h"
+#include "UObject/SoftObjectPath.h"
 
 // Apparatus
 #include "Mechanism.h"
@@ -26,11 +29,23 @@
 #include "Traits/DmgSphere.h"
 #include "Traits/SubType.h"
 #include "Traits/Animation.h"
+#include "BattleFrameStats.h"
+#include "BattleFrameStageTuner.h"
+#include "BattleFrameTimerWheel.h"
+#include "BattleFramePerThreadBuffer.h"
+#include "BattleFrameDamageEvent.h"
+#include "BattleFrameRandom.h"
+#include "BattleFrameTelemetry.h"
+#include "BattleFrameTextRing.h"
+#include "BattleFrameFxEvent.h"
+#include "BattleFrameCulling.h"
 
 #include "BattleFrameGameMode.generated.h"
 
 // Forward Declearation
 class UNeighborGridComponent;
+class ABattleFrameGameMode;
+class AFlowField;
 
 USTRUCT(BlueprintType) struct FResult
 {
@@ -51,6 +66,56 @@ public:
 	TArray<float> DmgDealt;
 };
 
+// 上一次模拟结束时的个体状态，只读
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBattleFrameAgentSnapshot
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FSubjectHandle Subject;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float Health = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float MaxHealth = 0.f;
+};
+
+struct BATTLEFRAME_API FBattleFrameCrowdSnapshot
+{
+	double SimulationTime = 0.0;
+	TArray<FBattleFrameAgentSnapshot> Agents;
+};
+
+// Finishes the asynchronous crowd step of the game mode in a later tick group
+USTRUCT()
+struct BATTLEFRAME_API FBattleFrameCrowdCompletionTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+
+	ABattleFrameGameMode* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FBattleFrameCrowdCompletionTickFunction> : public TStructOpsTypeTraitsBase2<FBattleFrameCrowdCompletionTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
 UCLASS()
 class BATTLEFRAME_API ABattleFrameGameMode
 	: public AMechanicalGameModeBase
@@ -65,6 +130,90 @@ public:
 	int32 ThreadsCount = 1;
 	int32 BatchSize = 1;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
+	bool bRecordStageStats = true;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
+	int32 StageStatsHistoryFrames = 300;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "根据各阶段实测耗时自动选择线程数与批大小，从默认线程数开始只试探相邻的线程数"))
+	bool bAutoTuneStages = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "估算单线程耗时低于此值（微秒）时不再分发到多个线程", EditCondition = "bAutoTuneStages", ClampMin = "0"))
+	float AutoTuneMinParallelWorkUs = 100.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "每个批次至少包含的工作量（微秒）", EditCondition = "bAutoTuneStages", ClampMin = "0"))
+	float AutoTuneMinBatchWorkUs = 25.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "每个候选线程数至少采样的帧数", EditCondition = "bAutoTuneStages", ClampMin = "1"))
+	int32 AutoTuneMinSamples = 4;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "稳定后每隔多少帧试探一次相邻的线程数", EditCondition = "bAutoTuneStages", ClampMin = "1"))
+	int32 AutoTuneReprobeInterval = 120;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "固定某些阶段的线程数与批大小，优先于自动调优"))
+	TArray<FBattleFrameStageTuning> StageTuningPresets;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "在后台任务中运行集群模拟，与游戏线程的其它工作重叠，需在开始游戏前设置"))
+	bool bAsyncSimulation = false;
+
+	UPROPERTY(EditAnywhere, Category = Performance, meta = (Tooltip = "异步模拟在此分组中完成并提交渲染数据", EditCondition = "bAsyncSimulation"))
+	TEnumAsByte<ETickingGroup> AsyncCompletionTickGroup = TG_PostUpdateWork;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "每帧模拟结束时写入只读快照，供蓝图查询"))
+	bool bWriteCrowdSnapshot = true;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "只把主视角视锥内的个体写入渲染批次，视锥外的放回池中"))
+	bool bCullInvisibleAgents = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "视锥向外扩展的距离，避免个体在屏幕边缘突然出现", EditCondition = "bCullInvisibleAgents", ClampMin = "0"))
+	float CullingMargin = 500.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "超过此距离的个体不渲染", EditCondition = "bCullInvisibleAgents", ClampMin = "1"))
+	float CullingDistance = 30000.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "可见性网格的格子大小，视锥较大时自动放大", EditCondition = "bCullInvisibleAgents", ClampMin = "1"))
+	float CullingCellSize = 1000.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "用末尾的实例填补死亡个体留下的空位，渲染批次的长度与存活个体数一致"))
+	bool bCompactRenderBatches = true;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "紧凑排列后释放多余的数组内存", EditCondition = "bCompactRenderBatches"))
+	bool bShrinkRenderBatches = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "远处的个体不做动画混合，循环动画对齐到少量共享相位，并隔帧更新动画状态"))
+	bool bAnimationLOD = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "与主视角的距离超过此值时使用动画 LOD", EditCondition = "bAnimationLOD", ClampMin = "0"))
+	float AnimLODDistance = 5000.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "每种循环动画共享的相位数量", EditCondition = "bAnimationLOD", ClampMin = "1"))
+	int32 AnimLODPhaseGroups = 4;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "相位对齐的周期（秒）", EditCondition = "bAnimationLOD", ClampMin = "0.01"))
+	float AnimLODPhasePeriod = 1.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "动画 LOD 个体每隔几帧更新一次动画状态", EditCondition = "bAnimationLOD", ClampMin = "1"))
+	int32 AnimLODUpdateInterval = 4;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "只更新和上传最近受伤个体的血条，作为单独的 ActiveHealthBar 数组传给 Niagara，逐实例血条数组保持隐藏"))
+	bool bSparseHealthBars = false;
+
+	UPROPERTY(EditAnywhere, Category = Performance, meta = (Tooltip = "受击数字环形缓冲的容量，向上取整到 2 的幂，写满后丢弃新数字，需在开始游戏前设置", ClampMin = "1"))
+	int32 TextRingCapacity = 8192;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "每帧最多显示的受击数字，击杀与暴击优先，0 为不限", ClampMin = "0"))
+	int32 TextBudgetPerFrame = 256;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "同一目标在此时间（秒）内受到的伤害合并为一个数字，0 为不合并", ClampMin = "0"))
+	float TextMergeWindow = 0.1f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "按类别与屏幕分区限制每帧的特效数量，超出时按距离、暴击、击杀与玩家相关程度取舍，音效同样按评分取前 NumSoundsPerFrame 个"))
+	bool bBudgetFx = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "bBudgetFx"))
+	FBattleFrameFxBudget FxBudget;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Sound)
 	int32 NumSoundsPerFrame = 1;
 
@@ -74,9 +223,27 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Game)
 	bool bIsGameOver = false;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Game, meta = (Tooltip = "随机种子，相同种子与相同操作得到相同的战斗，与线程数无关"))
+	int32 RandomSeed = 0;
+
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Statistics)
 	bool bGenerateSubjectQuantity = false;
 
+	UPROPERTY(EditAnywhere, Category = Statistics, meta = (Tooltip = "记录每次伤害与击杀，供平衡性分析，需在开始游戏前设置"))
+	bool bRecordTelemetry = false;
+
+	UPROPERTY(EditAnywhere, Category = Statistics, meta = (Tooltip = "保留的最近记录条数，向上取整到 2 的幂", EditCondition = "bRecordTelemetry", ClampMin = "1"))
+	int32 TelemetryCapacity = 65536;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Statistics, meta = (Tooltip = "超出预算被丢弃的特效总数"))
+	int32 DroppedFxCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Statistics, meta = (Tooltip = "超出预算被丢弃的音效总数"))
+	int32 DroppedSoundCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Statistics, meta = (Tooltip = "超出预算或容量被丢弃的受击数字总数"))
+	int32 DroppedTextCount = 0;
+
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Statistics)
 	int32 AgentCount = 0;
 
@@ -100,18 +267,108 @@ public:
 	TQueue<TSoftObjectPtr<USoundBase>, EQueueMode::Mpsc> SoundsToPlay;
 	TQueue<float> VolumesToPlay;
 
+	// 累计的模拟时间，计时轮以此为准
+	double SimulationTime = 0.0;
+	uint64 SimulationFrame = 0;
+	FBattleFrameTimerWheel TimerWheel;
+
+	// 本帧产生的伤害，由结算阶段统一按目标处理
+	TBattleFramePerThreadBuffer<FBattleFrameDamageEvent> DamageEvents;
+	TArray<FBattleFrameDamageEvent> MergedDamageEvents;
+	FBattleFrameDamageBatch DamageBatch;
+
+	// 伤害与击杀记录
+	FBattleFrameTelemetry Telemetry;
+
+	// 攻击阶段收集的伤害请求
+	TBattleFramePerThreadBuffer<FBattleFrameDamagePair> DamagePairs;
+	TArray<FBattleFrameDamagePair> QueuedDamagePairs;
+
+	// 本帧各类命中已出现的次数，键为不含序号的命中键
+	TMap<uint64, uint32> HitIndices;
+
+	// 稀疏血条，结算伤害时各线程登记，再合并到活跃列表
+	TBattleFramePerThreadBuffer<FSubjectHandle> HealthBarActivations;
+	TArray<FSubjectHandle> ActiveHealthBars;
+
+	// 即发即弃的特效，直接交给对应类型的特效渲染器
+	FBattleFrameFxEventQueue FxEvents;
+	TArray<FBattleFrameFxEvent> UnroutedFxEvents;
+
+	// 开启特效预算时的音效，每帧按评分取舍
+	struct FSoundEvent
+	{
+		TSoftObjectPtr<USoundBase> Sound;
+		float Priority = 0.f;
+		uint64 Key = 0;
+	};
+
+	TBattleFramePerThreadBuffer<FSoundEvent> SoundEvents;
+	TArray<FSoundEvent> MergedSoundEvents;
+
+	// 受击数字，伤害代码写入环形缓冲，每帧合并后按预算分发到渲染批次
+	FBattleFrameTextRing TextRing;
+	TArray<FBattleFrameTextEvent> DrainedTextEvents;
+
+	// 在游戏线程解析好的自定义目标
+	struct FCrowdTarget
+	{
+		FSubjectHandle Handle;
+		FVector Location = FVector::ZeroVector;
+	};
+
+	// 游戏线程收集、供模拟使用的输入，模拟不直接访问 UObject
+	struct FCrowdInputs
+	{
+		bool bPlayerIsValid = false;
+		FVector PlayerLocation = FVector::ZeroVector;
+		FSubjectHandle PlayerHandle;
+		bool bViewIsValid = false;
+		FVector ViewLocation = FVector::ZeroVector;
+		FBattleFrameCullingView CullingView;
+		double GameTime = 0.0;
+		TMap<FSoftObjectPath, FCrowdTarget> CustomTargets;
+		TMap<FSoftObjectPath, AFlowField*> FlowFieldsByPath;
+		TMap<const AFlowField*, FVector> FlowFieldLocations;
+	};
+
+	FCrowdInputs CrowdInputs;
+
+	// 模拟中引用过的自定义目标，之后每帧在收集输入时解析；新出现的先记下，下一帧加入
+	TSet<FSoftObjectPath> CustomTargetPaths;
+	TBattleFramePerThreadBuffer<FSoftObjectPath> NewCustomTargetPaths;
+	TArray<FSoftObjectPath> MergedCustomTargetPaths;
+
+	// 本帧的可见性网格，在渲染阶段前由 CullingView 生成
+	FBattleFrameCullingGrid CullingGrid;
+
+	// 异步模拟
+	FBattleFrameCrowdCompletionTickFunction CrowdCompletionTick;
+	UE::Tasks::FTask SimulationTask;
+	bool bCrowdFramePending = false;
+
+	// 双缓冲快照，模拟写后台，完成时交换
+	FBattleFrameCrowdSnapshot CrowdSnapshots[2];
+	int32 FrontSnapshot = 0;
+
 
 public:
 
 	ABattleFrameGameMode()
 	{
 		PrimaryActorTick.bCanEverTick = true;
+
+		CrowdCompletionTick.bCanEverTick = true;
+		CrowdCompletionTick.bStartWithTickEnabled = true;
+		CrowdCompletionTick.TickGroup = TG_PostUpdateWork;
 	}
 
 	void BeginPlay() override;
 
 	void EndPlay(const EEndPlayReason::Type EndPlayReason) override
 	{
+		CompleteCrowdFrame();
+
 		if (Instance == this)
 		{
 			Instance = nullptr;
@@ -122,32 +379,195 @@ public:
 
 	void Tick(float DeltaTime) override;
 
+	void RegisterActorTickFunctions(bool bRegister) override;
+
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	static ABattleFrameGameMode* GetInstance()
 	{
 		return Instance;
 	}
 
+	// 蓝图入口，等同于 ApplyDamageBatch
 	UFUNCTION(BlueprintCallable, Category = "Damage")
 	FResult ApplyDamageToSubjects(
-		const TArray<FSubjectHandle> Subjects,
-		const TArray<FSubjectHandle> IgnoreSubjects,
+		const TArray<FSubjectHandle>& Subjects,
+		const TArray<FSubjectHandle>& IgnoreSubjects,
 		FSubjectHandle DmgInstigator,
 		FVector HitFromLocation,
-		const FDmgSphere DmgSphere,
-		const FDebuff Debuff
+		const FDmgSphere& DmgSphere,
+		const FDebuff& Debuff
 	);
 
-	std::pair<bool, float> ProcessCritDamage(float BaseDamage, float damageMult, float Probability);
+	// 对一组目标造成同一份伤害，目标去重与忽略列表使用哈希集合，结果追加到 OutResult
+	void ApplyDamageBatch(
+		TArrayView<const FSubjectHandle> Subjects,
+		TArrayView<const FSubjectHandle> IgnoreSubjects,
+		const FSubjectHandle& DmgInstigator,
+		const FVector& HitFromLocation,
+		const FDmgSphere& DmgSphere,
+		const FDebuff& Debuff,
+		FResult& OutResult
+	);
+
+	// 并行结算多组攻击者到目标的伤害，同一目标可出现多次，结果按请求顺序追加到 OutResult
+	void ApplyDamagePairs(TArrayView<const FBattleFrameDamagePair> Pairs, FResult* OutResult = nullptr);
+
+	// 在并行操作中收集伤害请求，由 ApplyQueuedDamagePairs 统一结算
+	void QueueDamagePair(const FBattleFrameDamagePair& Pair)
+	{
+		DamagePairs.Add(Pair);
+	}
+
+	void ApplyQueuedDamagePairs();
+
+	// 本帧内同一攻击者以相同位置与伤害命中同一目标的次数，只在游戏线程或模拟线程上调用
+	uint32 NextHitIndex(
+		const FSubjectHandle& Overlapper,
+		const FSubjectHandle& DmgInstigator,
+		const FVector& HitFromLocation,
+		const FDmgSphere& DmgSphere
+	);
+
+	// 单个目标的伤害、减益与受击效果，HitIndex 区分同一帧内相同的命中，目标没有生命值时返回 false
+	bool ApplyDamageToSubject(
+		const FSubjectHandle& Overlapper,
+		const FSubjectHandle& DmgInstigator,
+		const FVector& HitFromLocation,
+		const FDmgSphere& DmgSphere,
+		const FDebuff& Debuff,
+		uint32 HitIndex,
+		bool& bOutCritical,
+		bool& bOutKill,
+		float& OutDmgDealt
+	);
+
+	// 记录一次伤害，在结算阶段生效，可在并行操作中调用
+	void QueueDamage(const FSubjectHandle& Target, const FSubjectHandle& Instigator, float Amount, EBattleFrameDamageFlags Flags = EBattleFrameDamageFlags::None, EBattleFrameDamageType Type = EBattleFrameDamageType::Normal)
+	{
+		DamageEvents.Add({ Target, Instigator, Amount, Flags, Type });
+	}
+
+	// 在 Delay 秒后触发一次计时事件，可在并行操作中调用
+	void ScheduleTimer(const FSubjectHandle& Subject, EBattleFrameTimer Timer, double Delay)
+	{
+		TimerWheel.Schedule(Subject, Timer, SimulationTime + Delay);
+	}
+
+	double GetSimulationTime() const { return SimulationTime; }
+
+	// 本帧、某个键与用途对应的随机数 [0, 1)，可在并行操作中调用
+	float RandomFloat(uint64 Key, EBattleFrameRandomPurpose Purpose) const
+	{
+		return FBattleFrameRandom::FRand(static_cast<uint32>(RandomSeed), SimulationFrame, Key, Purpose);
+	}
+
+	// 等待正在运行的异步模拟。在游戏线程上修改集群数据（生成、伤害、增删特征）之前调用，模拟内部调用时直接返回
+	UFUNCTION(BlueprintCallable, Category = Performance)
+	void WaitForCrowdSimulation();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = Performance)
+	bool IsCrowdSimulationRunning() const { return bCrowdFramePending; }
 
-	void QueueSound(TSoftObjectPtr<USoundBase> Sound, float Probability);
+	// 结束本帧的异步模拟：等待任务，提交渲染数据，交换快照
+	void CompleteCrowdFrame();
 
-	void QueueText(FSubjectHandle Subject, float Value, float Style, float Scale, float Radius, FVector Location);
+	// 让其它在游戏线程上操作集群数据的 Tick 排在异步模拟完成之后
+	void AddCrowdTickPrerequisite(FTickFunction& TickFunction)
+	{
+		if (bAsyncSimulation)
+		{
+			TickFunction.AddPrerequisite(this, CrowdCompletionTick);
+		}
+	}
+
+	FBattleFrameFxEventQueue& GetFxEvents() { return FxEvents; }
+
+	const FBattleFrameCrowdSnapshot& GetCrowdSnapshot() const { return CrowdSnapshots[FrontSnapshot]; }
+
+	// 快照中的个体数量
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = Snapshot)
+	int32 GetSnapshotAgentNum() const { return GetCrowdSnapshot().Agents.Num(); }
+
+	// 在快照中查询球形范围内的个体，异步模拟期间也可安全调用
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	TArray<FBattleFrameAgentSnapshot> QuerySnapshotAgentsInSphere(FVector Origin, float Radius) const;
+
+	void GatherCrowdInputs();
+
+	void SimulateCrowd(float DeltaTime);
+
+	void PresentCrowd();
+
+	void WriteCrowdSnapshot();
+
+	std::pair<bool, float> ProcessCritDamage(float BaseDamage, float damageMult, float Probability, uint64 RandomKey);
+
+	void QueueSound(TSoftObjectPtr<USoundBase> Sound, float Probability, const FSubjectHandle& Subject);
+
+	void QueueText(FSubjectHandle Subject, float Value, float Style, float Scale, float Radius, FVector Location, bool bKill = false);
 
 	static float RangeMapProbability(int32 subjectQuantity, FVector4 rangeMapParam);
 
-	void QueueFx(FSubjectHandle Subject, FTransform Transform, ESubType SubType);
+	// 生成了特效 Subject 时返回 true，调用方据此统计延迟操作
+	bool QueueFx(FSubjectHandle Subject, FTransform Transform, ESubType SubType, EBattleFrameFxCategory Category, const FSubjectHandle& Other = FSubjectHandle(), bool bCritical = false, bool bKill = false);
+
+	float ScoreFx(const FVector& Location, const FSubjectHandle& Subject, const FSubjectHandle& Other, bool bCritical, bool bKill) const;
 
 	static void CopyAnimData(FAnimation& Animation);
 
+	// 用末尾的存活实例填补 FreeTransforms 中的空位并截断数组，完成后 FreeTransforms 为空
+	static void CompactRenderBatch(FRenderBatchData& Data, bool bAllowShrinking);
+
+	// 上一帧各阶段的耗时、遍历数量、线程数、批大小与延迟操作数
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = Performance)
+	FBattleFrameFrameStats GetLastFrameStats() const
+	{
+		return FBattleFrameStatsCollector::Get().GetLastFrame();
+	}
+
+	// 导出最近 StageStatsHistoryFrames 帧的统计数据，路径为空时写入 Saved/Profiling/BattleFrame
+	UFUNCTION(BlueprintCallable, Category = Performance)
+	bool ExportStageStatsToCSV(const FString& FilePath) const
+	{
+		return FBattleFrameStatsCollector::Get().ExportToCSV(FilePath);
+	}
+
+	// 统计最近 Window 秒的伤害与击杀记录，Window 不大于 0 时统计全部
+	UFUNCTION(BlueprintCallable, Category = Statistics)
+	FBattleFrameTelemetryAggregate GetTelemetryAggregate(float Window = 0.f);
+
+	// 导出全部伤害与击杀记录，路径为空时写入 Saved/Profiling/BattleFrame
+	UFUNCTION(BlueprintCallable, Category = Statistics)
+	bool ExportTelemetryToCSV(const FString& FilePath);
+
+	UFUNCTION(BlueprintCallable, Category = Statistics)
+	void ResetTelemetry();
+
+	// 把当前调优结果保存为预设，之后各阶段固定使用这些值
+	UFUNCTION(BlueprintCallable, Category = Performance)
+	TArray<FBattleFrameStageTuning> CaptureStageTuningPresets()
+	{
+		WaitForCrowdSimulation();
+		StageTuningPresets = FBattleFrameStageTuner::Get().CapturePresets();
+		FBattleFrameStageTuner::Get().SetPresets(StageTuningPresets);
+		return StageTuningPresets;
+	}
+
+	UFUNCTION(BlueprintCallable, Category = Performance)
+	void ApplyStageTuningPresets(const TArray<FBattleFrameStageTuning>& Presets)
+	{
+		WaitForCrowdSimulation();
+		StageTuningPresets = Presets;
+		FBattleFrameStageTuner::Get().SetPresets(StageTuningPresets);
+	}
+
+	// 清空调优数据与预设，重新测量
+	UFUNCTION(BlueprintCallable, Category = Performance)
+	void ResetStageTuning()
+	{
+		WaitForCrowdSimulation();
+		StageTuningPresets.Reset();
+		FBattleFrameStageTuner::Get().Reset();
+	}
+
 };
\ No newline at end of file
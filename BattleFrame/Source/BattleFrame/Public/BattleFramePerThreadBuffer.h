@@ -0,0 +1,81 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/ScopeLock.h"
+
+/**
+ * Append only buffer with one array per producing thread. Adding takes no lock and, once the arrays have grown to
+ * their working size, allocates nothing. ConsumeTo moves everything out and must not run concurrently with Add.
+ */
+template<typename ElementType>
+class TBattleFramePerThreadBuffer
+{
+public:
+
+	TBattleFramePerThreadBuffer()
+		: TlsSlot(FPlatformTLS::AllocTlsSlot())
+	{
+	}
+
+	~TBattleFramePerThreadBuffer()
+	{
+		FPlatformTLS::FreeTlsSlot(TlsSlot);
+	}
+
+	TBattleFramePerThreadBuffer(const TBattleFramePerThreadBuffer&) = delete;
+	TBattleFramePerThreadBuffer& operator=(const TBattleFramePerThreadBuffer&) = delete;
+
+	FORCEINLINE void Add(const ElementType& Element)
+	{
+		GetThreadArray().Add(Element);
+	}
+
+	// 按线程依次追加到 Out，同一线程内保持添加顺序，各线程的数组保留容量
+	void ConsumeTo(TArray<ElementType>& Out)
+	{
+		FScopeLock ScopeLock(&Mutex);
+
+		int32 Num = 0;
+
+		for (const TUniquePtr<TArray<ElementType>>& Array : Arrays)
+		{
+			Num += Array->Num();
+		}
+
+		Out.Reserve(Out.Num() + Num);
+
+		for (const TUniquePtr<TArray<ElementType>>& Array : Arrays)
+		{
+			Out.Append(*Array);
+			Array->Reset();
+		}
+	}
+
+private:
+
+	TArray<ElementType>& GetThreadArray()
+	{
+		TArray<ElementType>* Array = static_cast<TArray<ElementType>*>(FPlatformTLS::GetTlsValue(TlsSlot));
+
+		// 每个线程第一次添加时注册自己的数组
+		if (!Array)
+		{
+			FScopeLock ScopeLock(&Mutex);
+			Array = Arrays.Add_GetRef(MakeUnique<TArray<ElementType>>()).Get();
+			FPlatformTLS::SetTlsValue(TlsSlot, Array);
+		}
+
+		return *Array;
+	}
+
+	uint32 TlsSlot;
+	FCriticalSection Mutex;
+	TArray<TUniquePtr<TArray<ElementType>>> Arrays;
+};
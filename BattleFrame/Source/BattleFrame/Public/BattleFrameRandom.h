@@ -0,0 +1,73 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SubjectHandle.h"
+
+// 随机数用途，同一输入下不同用途得到互不相关的结果
+enum class EBattleFrameRandomPurpose : uint32
+{
+	Crit,          // 暴击
+	Sound,         // 音效概率
+	SpawnLocation, // 生成位置
+	SpawnHeight,   // 飞行高度
+	FxBudget       // 特效预算中同分的取舍
+};
+
+/**
+ * Counter based random numbers. A value is a SplitMix64 hash of the seed, the frame, a key (usually the subject) and
+ * the purpose, so there is no shared state to contend on and the result does not depend on which thread or in which
+ * order it is drawn. The same seed and the same inputs replay the same battle.
+ */
+struct BATTLEFRAME_API FBattleFrameRandom
+{
+	static FORCEINLINE uint64 SplitMix64(uint64 X)
+	{
+		X += 0x9E3779B97F4A7C15ull;
+		X = (X ^ (X >> 30)) * 0xBF58476D1CE4E5B9ull;
+		X = (X ^ (X >> 27)) * 0x94D049BB133111EBull;
+		return X ^ (X >> 31);
+	}
+
+	static FORCEINLINE uint64 Hash(uint64 Seed, uint64 Frame, uint64 Key, EBattleFrameRandomPurpose Purpose)
+	{
+		uint64 H = SplitMix64(Seed);
+		H = SplitMix64(H ^ Frame);
+		H = SplitMix64(H ^ Key);
+		return SplitMix64(H ^ static_cast<uint64>(Purpose));
+	}
+
+	// [0, 1)
+	static FORCEINLINE float FRand(uint64 Seed, uint64 Frame, uint64 Key, EBattleFrameRandomPurpose Purpose)
+	{
+		return static_cast<float>(Hash(Seed, Frame, Key, Purpose) >> 40) * (1.f / 16777216.f);
+	}
+
+	static FORCEINLINE float FRandRange(float Min, float Max, uint64 Seed, uint64 Frame, uint64 Key, EBattleFrameRandomPurpose Purpose)
+	{
+		return Min + (Max - Min) * FRand(Seed, Frame, Key, Purpose);
+	}
+
+	static FORCEINLINE uint64 SubjectKey(const FSubjectHandle& Subject)
+	{
+		return GetTypeHash(Subject);
+	}
+
+	// 攻击者与目标组成的键
+	static FORCEINLINE uint64 PairKey(const FSubjectHandle& Instigator, const FSubjectHandle& Target)
+	{
+		return (SubjectKey(Instigator) << 32) | SubjectKey(Target);
+	}
+
+	// 一次命中的键，由攻击者、目标、命中位置、伤害与本帧内相同命中的序号共同决定（多发弹幕的每一发各不相同）
+	static FORCEINLINE uint64 HitKey(const FSubjectHandle& Instigator, const FSubjectHandle& Target, const FVector& HitFromLocation, uint32 HitHash, uint32 HitIndex)
+	{
+		const uint64 Hit = (static_cast<uint64>(GetTypeHash(HitFromLocation)) << 32) | HitHash;
+		return SplitMix64(PairKey(Instigator, Target) ^ SplitMix64(Hit ^ SplitMix64(SubjectKey(Instigator) + HitIndex)));
+	}
+};
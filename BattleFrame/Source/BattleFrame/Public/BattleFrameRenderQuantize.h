@@ -0,0 +1,106 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Compact encoding of per-instance render data, every packed value fits in one int32 Niagara array element.
+ * Locations are 16-bit fixed point relative to the batch origin (Step cm per unit, +-32767 * Step around the
+ * origin, clamped outside), orientation keeps only the yaw in 16 bits, material fx and health bar values are 8-bit
+ * normalized. The Niagara system decodes with the same formulas, see the Decode functions.
+ */
+struct BATTLEFRAME_API FBattleFrameRenderQuantize
+{
+	static constexpr float YawScale = 65536.f / 360.f;
+
+	// 以原点为中心每个轴可表示的半径
+	static FORCEINLINE double GetRange(float Step)
+	{
+		return 32767.0 * Step;
+	}
+
+	// 位置能否无夹取地编码
+	static FORCEINLINE bool IsInRange(const FVector& Location, const FVector& Origin, float Step)
+	{
+		return (Location - Origin).GetAbsMax() <= GetRange(Step);
+	}
+
+	static FORCEINLINE int32 ToFixed16(double Value, double Origin, float Step)
+	{
+		return FMath::Clamp(FMath::RoundToInt32((Value - Origin) / Step), -32767, 32767);
+	}
+
+	static FORCEINLINE double FromFixed16(int32 Packed, double Origin, float Step)
+	{
+		return Origin + static_cast<int16>(Packed & 0xFFFF) * Step;
+	}
+
+	static FORCEINLINE uint32 ToUnorm8(float Value)
+	{
+		return static_cast<uint32>(FMath::RoundToInt32(FMath::Clamp(Value, 0.f, 1.f) * 255.f));
+	}
+
+	static FORCEINLINE float FromUnorm8(uint32 Packed)
+	{
+		return (Packed & 0xFF) * (1.f / 255.f);
+	}
+
+	// 低 16 位 X，高 16 位 Y
+	static FORCEINLINE int32 EncodeLocationXY(const FVector& Location, const FVector& Origin, float Step)
+	{
+		const uint32 X = static_cast<uint16>(ToFixed16(Location.X, Origin.X, Step));
+		const uint32 Y = static_cast<uint16>(ToFixed16(Location.Y, Origin.Y, Step));
+		return static_cast<int32>(X | (Y << 16));
+	}
+
+	// 低 16 位 Z，高 16 位偏航角，只适用于不俯仰的地面单位
+	static FORCEINLINE int32 EncodeLocationZYaw(const FVector& Location, const FQuat& Rotation, const FVector& Origin, float Step)
+	{
+		const uint32 Z = static_cast<uint16>(ToFixed16(Location.Z, Origin.Z, Step));
+		const uint32 Yaw = static_cast<uint16>(FMath::RoundToInt32(FRotator::ClampAxis(Rotation.Rotator().Yaw) * YawScale));
+		return static_cast<int32>(Z | (Yaw << 16));
+	}
+
+	static FORCEINLINE FVector DecodeLocation(int32 XY, int32 ZYaw, const FVector& Origin, float Step)
+	{
+		return FVector(
+			FromFixed16(XY, Origin.X, Step),
+			FromFixed16(static_cast<uint32>(XY) >> 16, Origin.Y, Step),
+			FromFixed16(ZYaw, Origin.Z, Step));
+	}
+
+	// 度，[0, 360)
+	static FORCEINLINE float DecodeYaw(int32 ZYaw)
+	{
+		return (static_cast<uint32>(ZYaw) >> 16) / YawScale;
+	}
+
+	// HitGlow, Freeze, Burn, Dissolve 依次占 8 位
+	static FORCEINLINE int32 EncodeUnorm4(const FVector4& Value)
+	{
+		return static_cast<int32>(ToUnorm8(Value.X) | (ToUnorm8(Value.Y) << 8) | (ToUnorm8(Value.Z) << 16) | (ToUnorm8(Value.W) << 24));
+	}
+
+	static FORCEINLINE FVector4 DecodeUnorm4(int32 Packed)
+	{
+		const uint32 Bits = static_cast<uint32>(Packed);
+		return FVector4(FromUnorm8(Bits), FromUnorm8(Bits >> 8), FromUnorm8(Bits >> 16), FromUnorm8(Bits >> 24));
+	}
+
+	// Opacity, CurrentRatio, TargetRatio 依次占 8 位
+	static FORCEINLINE int32 EncodeUnorm3(const FVector& Value)
+	{
+		return static_cast<int32>(ToUnorm8(Value.X) | (ToUnorm8(Value.Y) << 8) | (ToUnorm8(Value.Z) << 16));
+	}
+
+	static FORCEINLINE FVector DecodeUnorm3(int32 Packed)
+	{
+		const uint32 Bits = static_cast<uint32>(Packed);
+		return FVector(FromUnorm8(Bits), FromUnorm8(Bits >> 8), FromUnorm8(Bits >> 16));
+	}
+};
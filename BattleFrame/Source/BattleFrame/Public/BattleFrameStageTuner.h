@@ -0,0 +1,104 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "BattleFrameStageTuner.generated.h"
+
+// 某个阶段固定使用的线程数与批大小
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBattleFrameStageTuning
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
+	FName Stage = NAME_None;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (ClampMin = "1"))
+	int32 ThreadsCount = 1;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (Tooltip = "0 表示按数量与线程数自动计算"))
+	int32 BatchSize = 0;
+};
+
+/**
+ * Picks the thread count and batch size of every stage from the wall time it measured on recent frames.
+ * Each stage starts on the thread count of the default heuristic (all workers) and only ever tries the neighbouring
+ * rung of the ladder 1, 2, 4 .. all workers, moving to it when it measures cheaper. Once settled a neighbour is
+ * re-probed every ReprobeInterval frames to follow load changes. Small workloads whose estimated serial cost is below
+ * MinParallelWorkUs run on a single thread. Only touched from the thread driving the pipeline.
+ */
+class BATTLEFRAME_API FBattleFrameStageTuner
+{
+public:
+
+	static FBattleFrameStageTuner& Get();
+
+	bool bEnabled = false;
+
+	// 估算单线程耗时低于此值（微秒）时不再分发到多个线程
+	float MinParallelWorkUs = 100.f;
+
+	// 每个批次至少包含的工作量（微秒），避免批次过碎
+	float MinBatchWorkUs = 25.f;
+
+	// 每个候选线程数至少采样的帧数
+	int32 MinSamples = 4;
+
+	// 稳定后每隔多少帧重新试探一次相邻的线程数
+	int32 ReprobeInterval = 120;
+
+	// Chooses the dispatch of one enchained loop. Candidate is INDEX_NONE for the first loop of a stage in a frame
+	// and is filled in, so the remaining loops of the stage use the same thread count.
+	void Decide(const FName Stage, int32 IterableNum, int32 MaxThreadsAllowed, int32& Candidate, int32& ThreadsCount, int32& BatchSize);
+
+	// Feeds back the measured wall time of a stage
+	void Report(const FName Stage, int32 Candidate, int32 IterableNum, double TimeMs);
+
+	// 当前估算的每个元素耗时（微秒），未采样时为 0
+	float GetCostPerItemUs(const FName Stage) const;
+
+	void SetPresets(const TArray<FBattleFrameStageTuning>& Presets);
+	TArray<FBattleFrameStageTuning> CapturePresets() const;
+
+	void Reset();
+
+private:
+
+	struct FCandidate
+	{
+		int32 ThreadsCount = 1;
+		double CostPerItemUs = 0.0;
+		int32 Samples = 0;
+	};
+
+	struct FStage
+	{
+		TArray<FCandidate> Candidates;
+		int32 MaxThreads = 0;
+		int32 Best = 0;
+		int32 Probing = INDEX_NONE;
+		int32 FramesSinceProbe = 0;
+		bool bProbeUp = true;
+
+		// 最近一次分发的结果，供导出预设
+		int32 LastThreadsCount = 0;
+		int32 LastBatchSize = 0;
+
+		bool bPreset = false;
+		FBattleFrameStageTuning Preset;
+	};
+
+	void BuildCandidates(FStage& StageData, int32 MaxThreads) const;
+	int32 PickCandidate(FStage& StageData) const;
+	double EstimateCostPerItemUs(const FStage& StageData, int32 Candidate) const;
+
+	TMap<FName, FStage> Stages;
+};
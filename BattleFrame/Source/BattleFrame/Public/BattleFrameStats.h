@@ -0,0 +1,205 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+// C++
+#include <atomic>
+
+// Unreal
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/CriticalSection.h"
+
+#include "BattleFrameStats.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("BattleFrame"), STATGROUP_BattleFrame, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pipeline"), STAT_BattleFramePipeline, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Iterated Subjects"), STAT_BattleFrameIterated, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deferred Ops"), STAT_BattleFrameDeferredOps, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Niagara Upload Bytes"), STAT_BattleFrameNiagaraUploadBytes, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Culled Agents"), STAT_BattleFrameCulledAgents, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dropped Texts"), STAT_BattleFrameDroppedTexts, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dropped Fx"), STAT_BattleFrameDroppedFx, STATGROUP_BattleFrame, BATTLEFRAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dropped Sounds"), STAT_BattleFrameDroppedSounds, STATGROUP_BattleFrame, BATTLEFRAME_API);
+
+// 单个阶段在一帧内的统计数据
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBattleFrameStageStats
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	FName Stage = NAME_None;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	float TimeMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	int32 IterableNum = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	int32 ThreadsCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	int32 BatchSize = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	int32 DeferredOps = 0;
+
+	// 线程数与批大小是否由自动调优决定
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	bool bAutoTuned = false;
+
+	// 调优器估算的每个元素耗时（微秒）
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	float CostPerItemUs = 0.f;
+};
+
+// 一帧内所有阶段的统计数据
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBattleFrameFrameStats
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	int64 Frame = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	float TotalTimeMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Performance)
+	TArray<FBattleFrameStageStats> Stages;
+};
+
+// Collects per stage timings of the battle pipeline. Stages are opened and closed on the threads driving the pipeline,
+// the async simulation and the game thread may do so at the same time, so the frame data is guarded by a lock.
+class BATTLEFRAME_API FBattleFrameStatsCollector
+{
+public:
+
+	static FBattleFrameStatsCollector& Get();
+
+	bool bEnabled = true;
+	int32 MaxHistoryFrames = 300;
+
+	void BeginFrame(int64 Frame);
+	void EndFrame();
+
+	int32 BeginStage(const FName Stage);
+	void EndStage(int32 Index, const FBattleFrameStageStats& StageStats);
+
+	// 返回副本，可在模拟运行时调用
+	FBattleFrameFrameStats GetLastFrame() const;
+	TArray<FBattleFrameFrameStats> GetHistory() const;
+	bool ExportToCSV(const FString& FilePath) const;
+
+#if STATS
+	TStatId GetStatId(const FName Stage);
+#endif
+
+private:
+
+	mutable FCriticalSection Mutex;
+	FBattleFrameFrameStats CurrentFrame;
+	FBattleFrameFrameStats LastFrame;
+	TArray<FBattleFrameFrameStats> History;
+	int32 HistoryHead = 0;
+	uint64 FrameStartCycles = 0;
+	bool bFrameOpen = false;
+
+#if STATS
+	FCriticalSection StatIdsLock;
+	TMap<FName, TStatId> StatIds;
+#endif
+};
+
+// Times one pipeline stage and records how it was dispatched
+class BATTLEFRAME_API FBattleFrameStageScope
+{
+public:
+
+	explicit FBattleFrameStageScope(const FName InStage);
+	~FBattleFrameStageScope();
+
+	FBattleFrameStageScope(const FBattleFrameStageScope&) = delete;
+	FBattleFrameStageScope& operator=(const FBattleFrameStageScope&) = delete;
+
+	// Same as UBattleFrameFunctionLibraryRT::CalculateThreadsCountAndBatchSize, but remembers the result for this stage.
+	// When the stage tuner is enabled the values come from its measurements instead.
+	void CalculateThreadsCountAndBatchSize(int32 IterableNum, int32& MaxThreadsAllowed, int32& ThreadsCount, int32& BatchSize);
+
+	// For stages not dispatched through the helper above (ParallelFor etc.)
+	void Track(int32 InIterableNum, int32 InThreadsCount, int32 InBatchSize);
+
+	FORCEINLINE void AddDeferred(int32 Num = 1)
+	{
+		DeferredOps.fetch_add(Num, std::memory_order_relaxed);
+	}
+
+	// Counts a deferred op towards the stage open or bound on the calling thread, for helpers called from inside
+	// stages. Counts gather per thread and merge into the stage when the scope or binding ends.
+	static void CountDeferred(int32 Num = 1);
+
+	// The stage open on the calling thread, to hand to FWorkerBinding in parallel work
+	static FBattleFrameStageScope* GetCurrent();
+
+	// Makes a worker thread count its deferred ops towards Scope while alive
+	class BATTLEFRAME_API FWorkerBinding
+	{
+	public:
+
+		explicit FWorkerBinding(FBattleFrameStageScope* Scope);
+		~FWorkerBinding();
+
+		FWorkerBinding(const FWorkerBinding&) = delete;
+		FWorkerBinding& operator=(const FWorkerBinding&) = delete;
+
+	private:
+
+		FBattleFrameStageScope* Previous = nullptr;
+	};
+
+private:
+
+	FName Stage;
+	int32 Index = INDEX_NONE;
+	bool bRecording = false;
+	int32 TunedCandidate = INDEX_NONE;
+	bool bAutoTuned = false;
+	uint64 StartCycles = 0;
+	int32 IterableNum = 0;
+	int32 ThreadsCount = 0;
+	int32 BatchSize = 0;
+	std::atomic<int32> DeferredOps{ 0 };
+	FBattleFrameStageScope* Previous = nullptr;
+
+#if STATS
+	FCycleCounter CycleCounter;
+#endif
+};
+
+// Opens and closes a frame on the collector
+class BATTLEFRAME_API FBattleFrameFrameScope
+{
+public:
+
+	FBattleFrameFrameScope(int64 Frame, bool bEnabled);
+	~FBattleFrameFrameScope();
+
+private:
+
+	bool bWasEnabled = false;
+
+#if STATS
+	FScopeCycleCounter CycleCounter;
+#endif
+};
@@ -0,0 +1,133 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+// C++
+#include <atomic>
+
+// Unreal
+#include "CoreMinimal.h"
+
+// BattleFrame
+#include "BattleFrameDamageEvent.h"
+
+#include "BattleFrameTelemetry.generated.h"
+
+// 一条伤害或击杀记录，队伍与子类型为 -1 表示未知
+struct FBattleFrameCombatRecord
+{
+	uint32 Frame = 0;
+	float Time = 0.f;
+	float Amount = 0.f;
+	float TimeToKill = -1.f; // 仅击杀记录，从第一次受伤到死亡的时间
+	int16 TargetSubType = -1;
+	int16 InstigatorSubType = -1;
+	int8 TargetTeam = -1;
+	int8 InstigatorTeam = -1;
+	EBattleFrameDamageType DamageType = EBattleFrameDamageType::Normal;
+	EBattleFrameDamageFlags Flags = EBattleFrameDamageFlags::None;
+	bool bKill = false;
+};
+
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBattleFrameTelemetryAggregate
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	int32 RecordsNum = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float TotalDamage = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float CriticalDamage = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float TemporalDamage = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	int32 Kills = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry, meta = (Tooltip = "按受击者队伍统计的伤害，下标为队伍序号"))
+	TArray<float> DamageTakenByTeam;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry, meta = (Tooltip = "按攻击者队伍统计的伤害，下标为队伍序号"))
+	TArray<float> DamageDealtByTeam;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry, meta = (Tooltip = "按受击者子类型统计的伤害"))
+	TMap<int32, float> DamageTakenBySubType;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry, meta = (Tooltip = "按伤害类型统计：普通、动能、火焰、冰冻、百分比"))
+	TArray<float> DamageByType;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry, meta = (Tooltip = "按攻击者子类型统计的击杀，-1 为非 Agent"))
+	TMap<int32, int32> KillsByInstigatorSubType;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float TimeToKillMean = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float TimeToKillMedian = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float TimeToKillP90 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Telemetry)
+	float TimeToKillMax = 0.f;
+};
+
+/**
+ * Fixed size ring of combat records written by the damage resolution. Adding is a single atomic increment and a
+ * copy, old records are overwritten once the ring is full. Queries and the CSV dump read the ring on the game
+ * thread and must not overlap with the simulation.
+ */
+class BATTLEFRAME_API FBattleFrameTelemetry
+{
+public:
+
+	static constexpr int32 MaxTeams = 10;
+
+	// 容量向上取整到 2 的幂，0 表示关闭
+	void Reset(int32 Capacity);
+
+	bool IsEnabled() const { return Mask != 0; }
+
+	FORCEINLINE void Add(const FBattleFrameCombatRecord& Record)
+	{
+		const uint64 Index = Head.fetch_add(1, std::memory_order_relaxed);
+		Records[Index & Mask] = Record;
+	}
+
+	int32 Num() const;
+
+	// 统计 SinceTime 之后的记录
+	FBattleFrameTelemetryAggregate Aggregate(double SinceTime) const;
+
+	bool ExportToCSV(const FString& FilePath) const;
+
+private:
+
+	template<typename FunctionType>
+	void ForEachRecord(FunctionType&& Function) const
+	{
+		const uint64 End = Head.load(std::memory_order_acquire);
+		const uint64 Count = FMath::Min<uint64>(End, Records.Num());
+
+		// 从最旧的记录开始
+		for (uint64 i = End - Count; i < End; ++i)
+		{
+			Function(Records[i & Mask]);
+		}
+	}
+
+	TArray<FBattleFrameCombatRecord> Records;
+	uint64 Mask = 0;
+	std::atomic<uint64> Head{ 0 };
+};
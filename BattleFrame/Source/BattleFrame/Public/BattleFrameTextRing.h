@@ -0,0 +1,84 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+// C++
+#include <atomic>
+
+// Unreal
+#include "CoreMinimal.h"
+
+// BattleFrame
+#include "SubjectHandle.h"
+
+// 数值越大越先显示
+enum class EBattleFrameTextPriority : uint8
+{
+	Normal,
+	Critical,
+	Kill
+};
+
+// 一条受击数字
+struct FBattleFrameTextEvent
+{
+	FSubjectHandle Target;
+	FSubjectHandle Renderer;
+	FVector Location = FVector::ZeroVector;
+	float Value = 0.f;
+	float Style = 0.f;
+	float Scale = 1.f;
+	float Offset = 0.f;
+	double Time = 0.0;
+	EBattleFrameTextPriority Priority = EBattleFrameTextPriority::Normal;
+};
+
+/**
+ * Fixed size ring of damage text written from the damage code. Adding is a single atomic increment and a copy, if
+ * more events than the capacity are added between two drains the newest ones are dropped, a slot that has not been
+ * drained is never overwritten. Each slot publishes the index it holds once written, Drain skips slots that were not
+ * published. Drain merges the hits on the same target inside a time window and hands out at most a budget of texts,
+ * highest priority first. Drain runs on one thread and must not overlap with Add.
+ */
+class BATTLEFRAME_API FBattleFrameTextRing
+{
+public:
+
+	// 容量向上取整到 2 的幂，0 表示关闭
+	void Reset(int32 Capacity);
+
+	bool IsEnabled() const { return Mask != 0; }
+
+	FORCEINLINE void Add(const FBattleFrameTextEvent& Event)
+	{
+		if (!IsEnabled()) return;
+
+		const uint64 Index = Head.fetch_add(1, std::memory_order_relaxed);
+
+		// 环已写满时丢弃新事件，不覆盖尚未取出的槽位
+		if (Index - Tail.load(std::memory_order_relaxed) > Mask) return;
+
+		const uint64 Slot = Index & Mask;
+		Events[Slot] = Event;
+		Sequences[Slot].store(Index + 1, std::memory_order_release);
+	}
+
+	// MergeWindow 为 0 时不合并，Budget 为 0 时不限数量，返回本次丢弃的条数
+	int32 Drain(double Time, float MergeWindow, int32 Budget, TArray<FBattleFrameTextEvent>& Out);
+
+private:
+
+	TArray<FBattleFrameTextEvent> Events;
+	TUniquePtr<std::atomic<uint64>[]> Sequences; // 槽位已写入的序号加一
+	uint64 Mask = 0;
+	std::atomic<uint64> Head{ 0 };
+	std::atomic<uint64> Tail{ 0 };
+
+	// 合并窗口内尚未显示的数字
+	TArray<FBattleFrameTextEvent> Pending;
+	TMap<FSubjectHandle, int32> PendingIndices;
+};
@@ -0,0 +1,97 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+// C++
+#include <atomic>
+
+// Unreal
+#include "CoreMinimal.h"
+
+// Apparatus
+#include "SubjectHandle.h"
+
+// 计时事件类型
+enum class EBattleFrameTimer : uint8
+{
+	AppearStart,   // 出生延迟结束，开始淡入/动画/特效
+	AppearEnd,     // 移除 FAppearing
+	AppearAnimEnd, // 移除 FAppearAnim
+	FreezeEnd,     // 移除 FFreezing
+	Despawn,       // 死亡延迟结束，移除个体
+	Trace,         // 索敌冷却结束
+	Burn,          // 灼烧结算一段伤害
+
+	Num
+};
+
+/**
+ * Hierarchical timer wheel for one shot state expirations. Three levels of 256 slots at a fixed tick resolution
+ * (about 4 seconds on the first level and 18 minutes on the second at 60 ticks per second), longer timers wait in
+ * an overflow list. Scheduling is thread safe so it can be done from inside concurrent operations, Advance and
+ * Consume belong to the game thread.
+ *
+ * Timers are not cancelled. A handler must check that the subject is still valid and still in the state the
+ * timer was scheduled for, traits that can be refreshed keep their absolute end time for that purpose.
+ */
+class BATTLEFRAME_API FBattleFrameTimerWheel
+{
+public:
+
+	static constexpr int32 SlotBits = 8;
+	static constexpr int32 SlotsNum = 1 << SlotBits;
+	static constexpr int32 LevelsNum = 3;
+
+	explicit FBattleFrameTimerWheel(double InResolution = 1.0 / 60.0);
+
+	// 清空所有计时并把当前时间设为 Now
+	void Reset(double Now);
+
+	void Schedule(const FSubjectHandle& Subject, EBattleFrameTimer Timer, double DueTime);
+
+	// 推进到 Now，到期的计时按类型放入待处理列表
+	void Advance(double Now);
+
+	// 取走某类到期计时
+	TArray<FSubjectHandle> Consume(EBattleFrameTimer Timer);
+
+	int32 Num() const;
+
+	double GetResolution() const { return Resolution; }
+
+private:
+
+	struct FEntry
+	{
+		FSubjectHandle Subject;
+		int64 Tick = 0;
+		EBattleFrameTimer Timer = EBattleFrameTimer::Num;
+	};
+
+	void Insert(FEntry&& Entry);
+	void Cascade(int32 Level);
+
+	void Lock() const
+	{
+		while (LockFlag.exchange(true, std::memory_order_acquire));
+	}
+
+	void Unlock() const
+	{
+		LockFlag.store(false, std::memory_order_release);
+	}
+
+	mutable std::atomic<bool> LockFlag{ false };
+
+	double Resolution;
+	int64 CurrentTick = 0;
+	int32 EntriesNum = 0;
+
+	TArray<FEntry> Wheels[LevelsNum][SlotsNum];
+	TArray<FEntry> Overflow;
+	TArray<FSubjectHandle> Due[static_cast<uint8>(EBattleFrameTimer::Num)];
+};
@@ -78,6 +78,7 @@ public:
 		}
 	}
 
+	// 异步模拟运行时，在游戏线程调用会先等待模拟结束
 	UFUNCTION(BlueprintCallable)
 	void SphereTraceForSubjects(const FVector& Location, float Radius, const FFilter& Filter, TArray<FSubjectHandle>& Results) const;
 	
@@ -12,6 +12,8 @@
 #include "NiagaraComponent.h" // Include the Niagara Component header
 #include "Machine.h"
 #include "HAL/PlatformMisc.h"
+#include "BattleFrameFxEvent.h"
+#include "BattleFrameFxSlotPool.h"
 
 #include "NiagaraFXRenderer.generated.h"
 
@@ -22,6 +24,13 @@ enum class EFxMode : uint8
 	Attached UMETA(DisplayName = "Attached")
 };
 
+UENUM(BlueprintType)
+enum class EFxSlotReuse : uint8
+{
+	OldestReleased UMETA(DisplayName = "OldestReleased", ToolTip = "按释放先后复用"),
+	LowestIndex UMETA(DisplayName = "LowestIndex", ToolTip = "优先复用序号小的槽位，数组末尾的槽位更容易保持空闲")
+};
+
 UCLASS()
 class BATTLEFRAME_API ANiagaraFXRenderer : public AActor
 {
@@ -34,6 +43,8 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
@@ -46,6 +57,15 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "FxRenderer")
 	UScriptStruct* SubType = nullptr;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "FxRenderer", meta = (Tooltip = "Attached 模式下槽位释放后等待多久才能复用，让上一个特效播完", ClampMin = "0"))
+	float SlotCooldown = 2.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "FxRenderer", meta = (Tooltip = "Attached 模式的最大槽位数，用满后挤掉最早的特效，0 为不限", ClampMin = "0"))
+	int32 MaxPoolSize = 0;
+
+	UPROPERTY(EditAnywhere, Category = "FxRenderer")
+	EFxSlotReuse SlotReuse = EFxSlotReuse::OldestReleased;
+
 	// Variable to hold the Niagara System Asset
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FxRenderer")
 	UNiagaraSystem* NiagaraAsset;
@@ -54,10 +74,21 @@ public:
 	UNiagaraComponent* SpawnedNiagaraSystem;
 
 
+	// 直接接收的特效类型，None 表示只处理 Subject
+	ESubType FxEventType = ESubType::None;
+	TArray<FBattleFrameFxEvent> FxEventArray;
+
 	TArray<FTransform> Transforms;
-	FBitMask ValidTransforms;
-	TArray<int32> FreeTransforms;
-	TArray<float> CoolDowns;
+
+	// Attached 模式的槽位，只遍历占用中的槽位
+	FBattleFrameFxSlotPool SlotPool;
+	TArray<FSubjectHandle> SlotSubjects;
+	TArray<uint32> SlotFrames; // 最近一次被 Subject 更新的帧
+	TArray<int32> ActiveSlots;
+	TArray<int32> ActiveSlotIndices;
+	TArray<FSubjectHandle> EvictedSubjects;
+	double PoolTime = 0.0;
+	uint32 PoolFrame = 0;
 
 	TArray<FVector> LocationArray;
 	TArray<FQuat> OrientationArray;
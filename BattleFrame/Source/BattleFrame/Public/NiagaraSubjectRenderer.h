@@ -63,11 +63,26 @@ public:
     ANiagaraSubjectRenderer();
     virtual void Tick(float DeltaTime) override;
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     
     // Public Methods
     void Register();
     void ActivateRenderer();
 
+    // 生成一个渲染批次与对应的 Niagara 系统，返回其序号
+    int32 SpawnRenderBatch(const FVector& Location);
+
+    // 个体离开所在批次的格子时移除 FRendering，由 Register 放入新格子的批次
+    void MigrateTiles();
+
+    // 回收空闲时间超过 IdleBatchRetireDelay 的格子批次
+    void RetireIdleBatches(float DeltaTime);
+
+    FIntPoint GetTile(const FVector& Location) const
+    {
+        return FIntPoint(FMath::FloorToInt32(Location.X / TileSize), FMath::FloorToInt32(Location.Y / TileSize));
+    }
+
     UFUNCTION(BlueprintCallable)
     bool IdleCheck();
 
@@ -92,6 +107,19 @@ public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Settings")
     FRotator OffsetRotation = FRotator(0,0,0);
 
+    // 系统通过 BattleFrame Crowd 数据接口读取打包数据，每帧整体复制一次，不再写入 Niagara 数组
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Settings")
+    bool bUseCrowdDataInterface = false;
+
+    // 以压缩编码上传位置、偏航角、材质特效与血条，系统用 Quantize_Origin 与 Quantize_Step 解码，只适用于地面单位。
+    // 个体超出范围时原点移到批次包围盒中心，包围盒仍超出范围时批次改回完整精度，Quantize_Enabled 为 false
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Settings", meta = (EditCondition = "!bUseCrowdDataInterface"))
+    bool bQuantizeRenderData = false;
+
+    // 位置精度，单位厘米，可表示的范围为以原点为中心 ±32767 倍
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Settings", meta = (EditCondition = "bQuantizeRenderData", ClampMin = "0.01"))
+    float QuantizedLocationStep = 2.f;
+
     bool Initialized = false;
     bool TickEnabled = false;
     bool isActive = false;
@@ -103,9 +131,37 @@ public:
     //UPROPERTY(EditAnywhere, Category = Performance)
     //int32 CurrentBatchSize = 1;
 
-    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "!bPartitionByTiles"))
     int32 NumRenderBatch = 4;
 
+    // 按世界格子划分渲染批次，每个 Niagara 系统只包含附近的个体，批次随占用情况创建与回收
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
+    bool bPartitionByTiles = false;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "bPartitionByTiles", ClampMin = "100"))
+    float TileSize = 10000.f;
+
+    // 离开格子超过此比例的格子大小才迁移，避免在边界来回切换
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "bPartitionByTiles", ClampMin = "0", ClampMax = "0.5"))
+    float TileMigrationMargin = 0.1f;
+
+    // 格子批次使用固定包围盒，在格子与迁移余量之外再扩展此距离，容纳模型自身的大小
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "bPartitionByTiles", ClampMin = "0"))
+    float TileBoundsMargin = 500.f;
+
+    // 格子批次固定包围盒以渲染器高度为中心的半高
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "bPartitionByTiles", ClampMin = "0"))
+    float TileBoundsHalfHeight = 5000.f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance, meta = (EditCondition = "bPartitionByTiles", ClampMin = "0"))
+    float IdleBatchRetireDelay = 5.f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
+    int32 MaxThreadsAllowed = FMath::Clamp(FPlatformMisc::NumberOfWorkerThreadsToSpawn() - 1, 1, FLT_MAX);
+
+    int32 ThreadsCount = 1;
+    int32 BatchSize = 1;
+
     //UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Performance)
     int32 RAMReserve = 5000;
 
@@ -122,5 +178,12 @@ public:
 
     int64 BatchSelector = 0;
 
+    // 注册时每个批次预留的槽位，按轮询顺序或格子分配
+    TArray<TArray<int32>> ReservedSlots;
+
+    // 格子到批次序号，以及各批次连续空闲的时间
+    TMap<FIntPoint, int32> TileBatches;
+    TArray<float> BatchIdleTimes;
+
 
 };
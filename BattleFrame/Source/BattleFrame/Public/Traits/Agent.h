@@ -19,6 +19,9 @@ struct BATTLEFRAME_API FAgent
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	int32 Score = 1;
 
+	// 生成时写入的队伍序号
+	int32 Team = 0;
+
 	//UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	//bool bIsBoss = false;
 
@@ -9,5 +9,6 @@ struct BATTLEFRAME_API FAppearAnim
 	GENERATED_BODY()
 
 public:
-	float animTime = 0.0f;
+	// 出生动画结束的模拟时间
+	double EndTime = 0.0;
 };
@@ -13,7 +13,8 @@ struct BATTLEFRAME_API FAppearing
  
   public:
 
-	  float time = 0.0f;
+	  // 出生结束的模拟时间
+	  double EndTime = 0.0;
 
 	  FAppearing() {};
 };
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "BakedCurves.generated.h"
+
+
+/**
+ * Index of the baked curve set of the agent's config, see FBattleFrameCurveRegistry.
+ */
+USTRUCT(BlueprintType, Category = "Basic")
+struct BATTLEFRAME_API FBakedCurves
+{
+	GENERATED_BODY()
+
+public:
+
+	int32 Index = INDEX_NONE;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+#include "SubjectHandle.h"
+#include "Traits/Debuff.h"
+#include "Burning.generated.h"
+
+// 一层灼烧
+struct FBurnStack
+{
+	FSubjectHandle Instigator;
+	float DamagePerTick = 0.f;
+	int32 TicksLeft = 0;
+
+	float Remaining() const { return DamagePerTick * TicksLeft; }
+};
+
+/**
+ * Damage over time stacks on the target. The stacks live inline in the trait and tick together every TickInterval
+ * from the Burn timer, applying an effect never spawns or despawns a subject. Agents carry an empty FBurning from
+ * spawn so that concurrent hits only take the lock.
+ */
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FBurning
+{
+	GENERATED_BODY()
+
+private:
+
+	mutable std::atomic<bool> LockFlag{ false };
+
+public:
+
+	void Lock() const
+	{
+		while (LockFlag.exchange(true, std::memory_order_acquire));
+	}
+
+	void Unlock() const
+	{
+		LockFlag.store(false, std::memory_order_release);
+	}
+
+	static constexpr int32 MaxStacks = 4;
+	static constexpr int32 TicksPerApplication = 4; // 每次灼烧分4段
+	static constexpr float TickInterval = 0.5f; // 每0.5秒一段
+
+	FBurnStack Stacks[MaxStacks];
+	int32 StacksNum = 0;
+
+	// 下一段伤害的模拟时间，重复的计时会被忽略
+	double NextTickTime = 0.0;
+
+	FBurning() {};
+
+	FBurning(const FBurning& Burning)
+	{
+		LockFlag.store(Burning.LockFlag.load());
+
+		for (int32 i = 0; i < MaxStacks; ++i)
+		{
+			Stacks[i] = Burning.Stacks[i];
+		}
+
+		StacksNum = Burning.StacksNum;
+		NextTickTime = Burning.NextTickTime;
+	}
+
+	FBurning& operator=(const FBurning& Burning)
+	{
+		LockFlag.store(Burning.LockFlag.load());
+
+		for (int32 i = 0; i < MaxStacks; ++i)
+		{
+			Stacks[i] = Burning.Stacks[i];
+		}
+
+		StacksNum = Burning.StacksNum;
+		NextTickTime = Burning.NextTickTime;
+
+		return *this;
+	}
+
+	// 按规则加入一层，调用方持锁，返回是否由空变为燃烧中
+	bool AddStack(const FBurnStack& Stack, EDotStackingRule Rule)
+	{
+		const bool bWasEmpty = StacksNum == 0;
+
+		if (bWasEmpty)
+		{
+			Stacks[StacksNum++] = Stack;
+			return true;
+		}
+
+		switch (Rule)
+		{
+			case EDotStackingRule::Refresh:
+			{
+				StacksNum = 1;
+				Stacks[0] = Stack;
+				break;
+			}
+
+			case EDotStackingRule::StrongestWins:
+			{
+				// 在已有的各层与新的一层中取最强的，合并为一层
+				int32 Strongest = 0;
+
+				for (int32 i = 1; i < StacksNum; ++i)
+				{
+					if (Stacks[i].DamagePerTick > Stacks[Strongest].DamagePerTick)
+					{
+						Strongest = i;
+					}
+				}
+
+				Stacks[0] = Stack.DamagePerTick >= Stacks[Strongest].DamagePerTick ? Stack : Stacks[Strongest];
+				StacksNum = 1;
+				break;
+			}
+
+			case EDotStackingRule::AddStack:
+			default:
+			{
+				if (StacksNum < MaxStacks)
+				{
+					Stacks[StacksNum++] = Stack;
+					break;
+				}
+
+				// 层数已满，替换剩余伤害最少的一层
+				int32 Weakest = 0;
+
+				for (int32 i = 1; i < StacksNum; ++i)
+				{
+					if (Stacks[i].Remaining() < Stacks[Weakest].Remaining())
+					{
+						Weakest = i;
+					}
+				}
+
+				if (Stack.Remaining() > Stacks[Weakest].Remaining())
+				{
+					Stacks[Weakest] = Stack;
+				}
+				break;
+			}
+		}
+
+		return false;
+	}
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "DeathStarted.generated.h"
+
+
+/**
+ * Marks a dying subject whose death has been initialized and whose despawn is scheduled.
+ */
+USTRUCT(BlueprintType, Category = "Basic")
+struct BATTLEFRAME_API FDeathStarted
+{
+	GENERATED_BODY()
+};
@@ -3,6 +3,14 @@
 #include "CoreMinimal.h"
 #include "Debuff.generated.h" 
 
+UENUM(BlueprintType)
+enum class EDotStackingRule : uint8
+{
+	Refresh UMETA(DisplayName = "Refresh", Tooltip = "只保留一层，新的灼烧覆盖旧的并重置段数"),
+	AddStack UMETA(DisplayName = "AddStack", Tooltip = "每次命中叠加一层，层数满时替换剩余伤害最少的一层"),
+	StrongestWins UMETA(DisplayName = "StrongestWins", Tooltip = "只保留一层，每段伤害更高的生效")
+};
+
 USTRUCT(BlueprintType)
 struct BATTLEFRAME_API FDebuff
 {
@@ -25,6 +33,9 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "延时伤害百分比"))
 	float TemporalDmgPercent = 0.25f;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "延时伤害的叠加方式"))
+	EDotStackingRule TemporalDmgStacking = EDotStackingRule::AddStack;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "是否可以使目标减速"))
 	bool bCanSlow = false;
 
@@ -14,6 +14,9 @@ public:
 	float SlowTimeout = 4.f;
 	float SlowStr = 1.f;
 	float OriginalDecoupleProportion = 1.f;
+
+	// 冰冻结束的模拟时间，刷新冰冻时后移，旧的计时会被忽略
+	double EndTime = 0.0;
 	//float CurrentSlowStr = 0.f;
 
 };
\ No newline at end of file
@@ -40,8 +40,8 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Meta = (ToolTip = "最大生命值"))
 	float Maximum = 100.f;
 
-	TQueue<float, EQueueMode::Mpsc> DamageToTake;
-	TQueue<FSubjectHandle, EQueueMode::Mpsc> DamageInstigator;
+	// 第一次受到伤害的模拟时间，用于统计击杀耗时
+	double FirstHitTime = -1.0;
 
 	FHealth() {};
 
@@ -50,6 +50,7 @@ public:
 		LockFlag.store(Health.LockFlag.load());
 		Current = Health.Current;
 		Maximum = Health.Maximum;
+		FirstHitTime = Health.FirstHitTime;
 	}
 
 	FHealth& operator=(const FHealth& Health)
@@ -57,6 +58,7 @@ public:
 		LockFlag.store(Health.LockFlag.load());
 		Current = Health.Current;
 		Maximum = Health.Maximum;
+		FirstHitTime = Health.FirstHitTime;
 		return *this;
 	}
 };
@@ -24,10 +24,17 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "血条插值变化的速度"))
 	float InterpSpeed = 2.f;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "受伤后血条保持显示的时间，仅用于稀疏血条"))
+	float HideDelay = 3.f;
+
 	float TargetRatio = 1.f;
 	float CurrentRatio = 1.f;
 	float Opacity = 0.f;
 
+	// 稀疏血条，受伤时加入，超过 HideTime 且插值完成后移出
+	double HideTime = 0.0;
+	bool bActive = false;
+
 	//UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (Tooltip = "血条的缩放比例"))
 	//FVector Scale = FVector(1, 1, 1);
 };
@@ -6,8 +6,39 @@
 #include "NiagaraSystem.h" 
 #include "NiagaraComponent.h"
 
+#include "BattleFrameCrowdBuffer.h"
+#include "BattleFrameRenderQuantize.h"
+
 #include "RenderBatchData.generated.h"
 
+// 需要同步到 Niagara 的逐实例数组
+enum class ERenderChannel : uint8
+{
+    Location,
+    Orientation,
+    Scale,
+    AnimIndex,
+    AnimTime,
+    AnimLerp,
+    MatFx,
+    HealthBar,
+    InsidePool,
+
+    // 压缩编码
+    QuantizedLocationXY,
+    QuantizedLocationZYaw,
+    QuantizedMatFx,
+    QuantizedHealthBar,
+
+    Num
+};
+
+// 一个通道自上次上传后是否有改动
+struct FRenderChannelState
+{
+    bool bDirty = false;
+    int32 UploadedNum = INDEX_NONE; // 上次上传时的数组长度，不一致时整体上传
+};
 
 USTRUCT(BlueprintType, Category = "TraitRenderer")
 struct BATTLEFRAME_API FRenderBatchData
@@ -33,6 +64,10 @@ struct BATTLEFRAME_API FRenderBatchData
     // Renderer
     UNiagaraComponent* SpawnedNiagaraSystem = nullptr;
 
+    // 按格子划分时批次所在的格子
+    bool bTiled = false;
+    FIntPoint Tile = FIntPoint::ZeroValue;
+
     // Offset
     FVector OffsetLocation = FVector::ZeroVector;
     FRotator OffsetRotation = FRotator::ZeroRotator;
@@ -40,8 +75,10 @@ struct BATTLEFRAME_API FRenderBatchData
 
     // Pooling
     TArray<FTransform> Transforms;
-    FBitMask ValidTransforms;
-    TArray<int32> FreeTransforms;
+    TArray<bool> ValidTransforms; // 每个实例一个字节，并行写入不同实例时互不影响
+    TArray<int32> FreeTransforms; // 已在池中的空闲槽位，随释放与复用增量维护
+    TArray<int32> ReleasedTransforms; // 本帧个体移除或迁出时释放的槽位，由 ReleaseInstance 加锁追加
+    std::atomic<int32> WrittenNum{ 0 }; // 本帧写入的实例数，与存活数不符时整体重新收集空位
 
     // Transform
     TArray<FVector> LocationArray;
@@ -59,6 +96,10 @@ struct BATTLEFRAME_API FRenderBatchData
     // HealthBar
     TArray<FVector> HealthBar_Opacity_CurrentRatio_TargetRatio_Array;
 
+    // 稀疏血条，只含最近受伤的个体，每帧重建
+    TArray<FVector> ActiveHealthBar_Location_Array;
+    TArray<FVector> ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array;
+
     // TextPopUp
     TArray<FVector> Text_Location_Array;
     TArray<FVector4> Text_Value_Style_Scale_Offset_Array;
@@ -66,18 +107,209 @@ struct BATTLEFRAME_API FRenderBatchData
     // Other
     TArray<bool> InsidePool_Array;
 
+    // 实例对应的个体，紧凑排列搬动实例时据此更新 FRendering
+    TArray<FSubjectHandle> InstanceSubjects;
+
+    // Quantized，开启后代替位置、旋转、材质特效与血条数组上传，见 FBattleFrameRenderQuantize
+    bool bQuantized = false;
+    FVector QuantizeOrigin = FVector::ZeroVector;
+    float QuantizeStep = 2.f;
+    std::atomic<bool> bQuantizeOutOfRange{ false }; // 本帧有位置超出编码范围，写入后重新选取原点
+    bool bQuantizeChanged = false; // 原点或编码方式已变，同步时通知 Niagara
+
+    TArray<int32> Quantized_LocationXY_Array;
+    TArray<int32> Quantized_LocationZ_Yaw_Array;
+    TArray<int32> Quantized_HitGlow_Freeze_Burn_Dissolve_Array;
+    TArray<int32> Quantized_HealthBar_Array;
+
+    // Upload
+    FRenderChannelState Channels[static_cast<uint8>(ERenderChannel::Num)];
+    TArray<uint16> DirtyChannels; // 每个实例改动过的通道，由 CollectDirty 汇总到 Channels
+    int32 TextUploadedNum = INDEX_NONE;
+    int32 ActiveHealthBarUploadedNum = INDEX_NONE;
+
+    // 使用 Crowd 数据接口时的打包数据，为空时走逐通道的数组
+    TSharedPtr<FBattleFrameCrowdBuffer> CrowdBuffer;
 
     FRenderBatchData(){};
 
+    static_assert(static_cast<uint8>(ERenderChannel::Num) <= 16, "DirtyChannels holds one bit per channel");
+
+    // 值有变化时写入并记录改动，只触及该实例自己的数据，不同线程写入不同实例时无需加锁
+    template<typename ElementType>
+    FORCEINLINE void Write(ERenderChannel Channel, TArray<ElementType>& Array, int32 Index, const ElementType& Value)
+    {
+        if (Array[Index] != Value)
+        {
+            Array[Index] = Value;
+            DirtyChannels[Index] |= 1 << static_cast<uint8>(Channel);
+        }
+    }
+
+    // 实例的所有通道都需要上传
+    FORCEINLINE void MarkDirty(int32 Index)
+    {
+        DirtyChannels[Index] = (1 << static_cast<uint8>(ERenderChannel::Num)) - 1;
+    }
+
+    // 把逐实例的改动标记按通道汇总，同步前调用
+    void CollectDirty()
+    {
+        uint16 Flags = 0;
+
+        for (uint16& InstanceFlags : DirtyChannels)
+        {
+            Flags |= InstanceFlags;
+            InstanceFlags = 0;
+        }
+
+        for (uint8 Channel = 0; Flags; ++Channel, Flags >>= 1)
+        {
+            Channels[Channel].bDirty |= (Flags & 1) != 0;
+        }
+    }
+
+    // 槽位不再被任何个体使用，在同步前放回池中，可在并行操作中调用
+    void ReleaseInstance(int32 Id)
+    {
+        Lock();
+        ReleasedTransforms.Add(Id);
+        Unlock();
+    }
+
+    // 所有实例数组一次性扩容 Num 个，新实例在池中，返回第一个新实例的序号
+    int32 AddInstances(int32 Num)
+    {
+        const int32 First = Transforms.Num();
+        const int32 NewNum = First + Num;
+
+        Transforms.SetNum(NewNum);
+        ValidTransforms.SetNumZeroed(NewNum);
+        DirtyChannels.SetNumZeroed(NewNum);
+        InstanceSubjects.SetNum(NewNum);
+
+        // 使用数据接口时只有打包数据
+        if (CrowdBuffer.IsValid())
+        {
+            CrowdBuffer->SetNum(NewNum);
+            return First;
+        }
+
+        LocationArray.SetNum(NewNum);
+        OrientationArray.SetNum(NewNum);
+        ScaleArray.SetNum(NewNum);
+
+        Anim_Index0_Index1_PauseTime0_PauseTime1_Array.SetNum(NewNum);
+        Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array.SetNum(NewNum);
+        Anim_Lerp_Array.SetNum(NewNum);
+
+        Mat_HitGlow_Freeze_Burn_Dissolve_Array.SetNum(NewNum);
+        HealthBar_Opacity_CurrentRatio_TargetRatio_Array.SetNum(NewNum);
+
+        InsidePool_Array.SetNum(NewNum);
+
+        if (bQuantized)
+        {
+            Quantized_LocationXY_Array.SetNum(NewNum);
+            Quantized_LocationZ_Yaw_Array.SetNum(NewNum);
+            Quantized_HitGlow_Freeze_Burn_Dissolve_Array.SetNum(NewNum);
+            Quantized_HealthBar_Array.SetNum(NewNum);
+        }
+
+        for (int32 i = First; i < NewNum; ++i)
+        {
+            InsidePool_Array[i] = true;
+        }
+
+        return First;
+    }
+
+    // 把实例 From 的全部数据搬到 To，To 的所有通道都需要上传
+    void MoveInstance(int32 From, int32 To)
+    {
+        Transforms[To] = Transforms[From];
+        InstanceSubjects[To] = InstanceSubjects[From];
+        MarkDirty(To);
+
+        if (CrowdBuffer.IsValid())
+        {
+            CrowdBuffer->MoveInstance(From, To);
+            return;
+        }
+
+        LocationArray[To] = LocationArray[From];
+        OrientationArray[To] = OrientationArray[From];
+        ScaleArray[To] = ScaleArray[From];
+
+        Anim_Index0_Index1_PauseTime0_PauseTime1_Array[To] = Anim_Index0_Index1_PauseTime0_PauseTime1_Array[From];
+        Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array[To] = Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array[From];
+        Anim_Lerp_Array[To] = Anim_Lerp_Array[From];
+
+        Mat_HitGlow_Freeze_Burn_Dissolve_Array[To] = Mat_HitGlow_Freeze_Burn_Dissolve_Array[From];
+        HealthBar_Opacity_CurrentRatio_TargetRatio_Array[To] = HealthBar_Opacity_CurrentRatio_TargetRatio_Array[From];
+
+        InsidePool_Array[To] = InsidePool_Array[From];
+
+        if (bQuantized)
+        {
+            Quantized_LocationXY_Array[To] = Quantized_LocationXY_Array[From];
+            Quantized_LocationZ_Yaw_Array[To] = Quantized_LocationZ_Yaw_Array[From];
+            Quantized_HitGlow_Freeze_Burn_Dissolve_Array[To] = Quantized_HitGlow_Freeze_Burn_Dissolve_Array[From];
+            Quantized_HealthBar_Array[To] = Quantized_HealthBar_Array[From];
+        }
+    }
+
+    // 丢弃 Num 之后的实例，bAllowShrinking 时释放多余的内存
+    void TruncateInstances(int32 Num, bool bAllowShrinking)
+    {
+        if (Num >= Transforms.Num()) return;
+
+        Transforms.SetNum(Num, bAllowShrinking);
+        ValidTransforms.SetNum(Num, bAllowShrinking);
+        DirtyChannels.SetNum(Num, bAllowShrinking);
+        InstanceSubjects.SetNum(Num, bAllowShrinking);
+
+        if (CrowdBuffer.IsValid())
+        {
+            CrowdBuffer->SetNum(Num, bAllowShrinking);
+            return;
+        }
+
+        LocationArray.SetNum(Num, bAllowShrinking);
+        OrientationArray.SetNum(Num, bAllowShrinking);
+        ScaleArray.SetNum(Num, bAllowShrinking);
+
+        Anim_Index0_Index1_PauseTime0_PauseTime1_Array.SetNum(Num, bAllowShrinking);
+        Anim_TimeStamp0_TimeStamp1_PlayRate0_Playrate1_Array.SetNum(Num, bAllowShrinking);
+        Anim_Lerp_Array.SetNum(Num, bAllowShrinking);
+
+        Mat_HitGlow_Freeze_Burn_Dissolve_Array.SetNum(Num, bAllowShrinking);
+        HealthBar_Opacity_CurrentRatio_TargetRatio_Array.SetNum(Num, bAllowShrinking);
+
+        InsidePool_Array.SetNum(Num, bAllowShrinking);
+
+        if (bQuantized)
+        {
+            Quantized_LocationXY_Array.SetNum(Num, bAllowShrinking);
+            Quantized_LocationZ_Yaw_Array.SetNum(Num, bAllowShrinking);
+            Quantized_HitGlow_Freeze_Burn_Dissolve_Array.SetNum(Num, bAllowShrinking);
+            Quantized_HealthBar_Array.SetNum(Num, bAllowShrinking);
+        }
+    }
+
     FRenderBatchData(const FRenderBatchData& Data)
     {
         LockFlag.store(Data.LockFlag.load());
 
         SpawnedNiagaraSystem = Data.SpawnedNiagaraSystem;
 
+        bTiled = Data.bTiled;
+        Tile = Data.Tile;
+
         Transforms=Data.Transforms;
         ValidTransforms=Data.ValidTransforms;
         FreeTransforms=Data.FreeTransforms;
+        ReleasedTransforms = Data.ReleasedTransforms;
 
         LocationArray=Data.LocationArray;
         OrientationArray=Data.OrientationArray;
@@ -90,11 +322,32 @@ struct BATTLEFRAME_API FRenderBatchData
         Mat_HitGlow_Freeze_Burn_Dissolve_Array = Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array;
 
         HealthBar_Opacity_CurrentRatio_TargetRatio_Array = Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array;
+        ActiveHealthBar_Location_Array = Data.ActiveHealthBar_Location_Array;
+        ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array = Data.ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array;
 
         Text_Location_Array = Data.Text_Location_Array;
         Text_Value_Style_Scale_Offset_Array = Data.Text_Value_Style_Scale_Offset_Array;
 
         InsidePool_Array = Data.InsidePool_Array;
+        InstanceSubjects = Data.InstanceSubjects;
+
+        bQuantized = Data.bQuantized;
+        QuantizeOrigin = Data.QuantizeOrigin;
+        QuantizeStep = Data.QuantizeStep;
+        Quantized_LocationXY_Array = Data.Quantized_LocationXY_Array;
+        Quantized_LocationZ_Yaw_Array = Data.Quantized_LocationZ_Yaw_Array;
+        Quantized_HitGlow_Freeze_Burn_Dissolve_Array = Data.Quantized_HitGlow_Freeze_Burn_Dissolve_Array;
+        Quantized_HealthBar_Array = Data.Quantized_HealthBar_Array;
+
+        for (uint8 i = 0; i < static_cast<uint8>(ERenderChannel::Num); ++i)
+        {
+            Channels[i] = Data.Channels[i];
+        }
+
+        TextUploadedNum = Data.TextUploadedNum;
+        ActiveHealthBarUploadedNum = Data.ActiveHealthBarUploadedNum;
+        DirtyChannels = Data.DirtyChannels;
+        CrowdBuffer = Data.CrowdBuffer;
     }
 
     FRenderBatchData& operator=(const FRenderBatchData& Data)
@@ -103,9 +356,13 @@ struct BATTLEFRAME_API FRenderBatchData
 
         SpawnedNiagaraSystem = Data.SpawnedNiagaraSystem;
 
+        bTiled = Data.bTiled;
+        Tile = Data.Tile;
+
         Transforms = Data.Transforms;
         ValidTransforms = Data.ValidTransforms;
         FreeTransforms = Data.FreeTransforms;
+        ReleasedTransforms = Data.ReleasedTransforms;
 
         LocationArray = Data.LocationArray;
         OrientationArray = Data.OrientationArray;
@@ -118,11 +375,32 @@ struct BATTLEFRAME_API FRenderBatchData
         Mat_HitGlow_Freeze_Burn_Dissolve_Array = Data.Mat_HitGlow_Freeze_Burn_Dissolve_Array;
 
         HealthBar_Opacity_CurrentRatio_TargetRatio_Array = Data.HealthBar_Opacity_CurrentRatio_TargetRatio_Array;
+        ActiveHealthBar_Location_Array = Data.ActiveHealthBar_Location_Array;
+        ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array = Data.ActiveHealthBar_Opacity_CurrentRatio_TargetRatio_Array;
 
         Text_Location_Array = Data.Text_Location_Array;
         Text_Value_Style_Scale_Offset_Array = Data.Text_Value_Style_Scale_Offset_Array;
 
         InsidePool_Array = Data.InsidePool_Array;
+        InstanceSubjects = Data.InstanceSubjects;
+
+        bQuantized = Data.bQuantized;
+        QuantizeOrigin = Data.QuantizeOrigin;
+        QuantizeStep = Data.QuantizeStep;
+        Quantized_LocationXY_Array = Data.Quantized_LocationXY_Array;
+        Quantized_LocationZ_Yaw_Array = Data.Quantized_LocationZ_Yaw_Array;
+        Quantized_HitGlow_Freeze_Burn_Dissolve_Array = Data.Quantized_HitGlow_Freeze_Burn_Dissolve_Array;
+        Quantized_HealthBar_Array = Data.Quantized_HealthBar_Array;
+
+        for (uint8 i = 0; i < static_cast<uint8>(ERenderChannel::Num); ++i)
+        {
+            Channels[i] = Data.Channels[i];
+        }
+
+        TextUploadedNum = Data.TextUploadedNum;
+        ActiveHealthBarUploadedNum = Data.ActiveHealthBarUploadedNum;
+        DirtyChannels = Data.DirtyChannels;
+        CrowdBuffer = Data.CrowdBuffer;
 
         return *this;
     }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TimersScheduled.generated.h"
+
+
+/**
+ * The subject's appear and trace timers have been scheduled by the game mode.
+ */
+USTRUCT(BlueprintType)
+struct BATTLEFRAME_API FTimersScheduled
+{
+	GENERATED_BODY()
+};
@@ -12,7 +12,7 @@ struct BATTLEFRAME_API FTracing
 
 public:
 
-	bool bShouldTrace = false;
-	float TimeLeft = 0;
+	// 下次索敌的模拟时间，由计时轮触发
+	double NextTraceTime = 0.0;
 
 };
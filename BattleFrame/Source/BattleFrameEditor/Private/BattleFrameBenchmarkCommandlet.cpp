@@ -0,0 +1,494 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#include "BattleFrameBenchmarkCommandlet.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/BoxComponent.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+
+#include "Machine.h"
+#include "FlowField.h"
+#include "AgentSpawner.h"
+#include "AgentConfigDataAsset.h"
+#include "NeighborGridActor.h"
+#include "NeighborGridComponent.h"
+#include "RVOSquareObstacle.h"
+#include "BattleFrameGameMode.h"
+#include "Traits/Agent.h"
+#include "Traits/Health.h"
+#include "Traits/Team.h"
+#include "Traits/Trace.h"
+#include "Traits/Navigation.h"
+#include "Traits/DmgSphere.h"
+#include "Traits/Debuff.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBattleFrameBenchmark, Log, All);
+
+namespace BattleFrameBenchmark
+{
+	// 每个单位大约占用的面积，用于推算场地尺寸
+	constexpr float AreaPerAgent = 150.f * 150.f;
+	constexpr float NeighborCellSize = 300.f;
+	constexpr float FlowFieldCellSize = 150.f;
+	constexpr float WallThickness = 100.f;
+
+	const TCHAR* DefaultConfigs[] =
+	{
+		TEXT("/BattleFrame/Demo/Agent/AgentAsset/ChestMonster/AgentConfig_ChestMonster_SK.AgentConfig_ChestMonster_SK"),
+		TEXT("/BattleFrame/Demo/Agent/AgentAsset/TurtleShell/AgentConfig_TurtleShell_SK.AgentConfig_TurtleShell_SK")
+	};
+
+	static double Percentile(const TArray<double>& Sorted, double P)
+	{
+		if (Sorted.Num() == 0) return 0.0;
+
+		const double Rank = P * (Sorted.Num() - 1);
+		const int32 Lower = FMath::FloorToInt32(Rank);
+		const int32 Upper = FMath::Min(Lower + 1, Sorted.Num() - 1);
+
+		return FMath::Lerp(Sorted[Lower], Sorted[Upper], Rank - Lower);
+	}
+
+	static TSharedRef<FJsonObject> Summarize(TArray<double> Values)
+	{
+		TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+
+		Values.Sort();
+
+		double Sum = 0.0;
+		for (const double Value : Values) { Sum += Value; }
+
+		Json->SetNumberField(TEXT("mean"), Values.Num() > 0 ? Sum / Values.Num() : 0.0);
+		Json->SetNumberField(TEXT("p50"), Percentile(Values, 0.50));
+		Json->SetNumberField(TEXT("p90"), Percentile(Values, 0.90));
+		Json->SetNumberField(TEXT("p95"), Percentile(Values, 0.95));
+		Json->SetNumberField(TEXT("p99"), Percentile(Values, 0.99));
+		Json->SetNumberField(TEXT("max"), Values.Num() > 0 ? Values.Last() : 0.0);
+
+		return Json;
+	}
+}
+
+UBattleFrameBenchmarkCommandlet::UBattleFrameBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UBattleFrameBenchmarkCommandlet::Main(const FString& Params)
+{
+	FSettings Settings;
+
+	FParse::Value(*Params, TEXT("Agents="), Settings.Agents);
+	FParse::Value(*Params, TEXT("Frames="), Settings.Frames);
+	FParse::Value(*Params, TEXT("Warmup="), Settings.Warmup);
+	FParse::Value(*Params, TEXT("DeltaTime="), Settings.DeltaTime);
+	FParse::Value(*Params, TEXT("Output="), Settings.Output);
+	FParse::Value(*Params, TEXT("Label="), Settings.Label);
+
+	Settings.Agents = FMath::Max(Settings.Agents, 1);
+	Settings.Frames = FMath::Max(Settings.Frames, 1);
+	Settings.Warmup = FMath::Max(Settings.Warmup, 0);
+	Settings.DeltaTime = FMath::Max(Settings.DeltaTime, KINDA_SMALL_NUMBER);
+
+	FString ConfigsParam;
+	if (FParse::Value(*Params, TEXT("Configs="), ConfigsParam, false) || FParse::Value(*Params, TEXT("Config="), ConfigsParam, false))
+	{
+		TArray<FString> Paths;
+		ConfigsParam.ParseIntoArray(Paths, TEXT(","));
+		for (const FString& Path : Paths) { Settings.Configs.Add(FSoftObjectPath(Path.TrimStartAndEnd())); }
+	}
+
+	if (Settings.Configs.IsEmpty())
+	{
+		for (const TCHAR* Path : BattleFrameBenchmark::DefaultConfigs) { Settings.Configs.Add(FSoftObjectPath(Path)); }
+	}
+
+	if (Settings.Output.IsEmpty())
+	{
+		Settings.Output = FPaths::ProfilingDir() / TEXT("BattleFrame") / FString::Printf(TEXT("Benchmark-%s.json"), *FDateTime::Now().ToString());
+	}
+
+	// 场景选择
+	TArray<EBattleFrameBenchmarkScenario> Scenarios;
+	FString ScenarioParam = TEXT("All");
+	FParse::Value(*Params, TEXT("Scenario="), ScenarioParam);
+
+	for (const EBattleFrameBenchmarkScenario Scenario : { EBattleFrameBenchmarkScenario::OpenFieldMarch, EBattleFrameBenchmarkScenario::ChokePointSiege, EBattleFrameBenchmarkScenario::TwoArmyMelee, EBattleFrameBenchmarkScenario::HeavyAoE })
+	{
+		if (ScenarioParam.Equals(TEXT("All"), ESearchCase::IgnoreCase) || ScenarioParam.Equals(ToString(Scenario), ESearchCase::IgnoreCase))
+		{
+			Scenarios.Add(Scenario);
+		}
+	}
+
+	if (Scenarios.IsEmpty())
+	{
+		UE_LOG(LogBattleFrameBenchmark, Error, TEXT("Unknown scenario '%s'"), *ScenarioParam);
+		return 1;
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("label"), Settings.Label);
+	Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetNumberField(TEXT("agents"), Settings.Agents);
+	Root->SetNumberField(TEXT("frames"), Settings.Frames);
+	Root->SetNumberField(TEXT("warmup"), Settings.Warmup);
+	Root->SetNumberField(TEXT("deltaTime"), Settings.DeltaTime);
+	Root->SetNumberField(TEXT("workerThreads"), FPlatformMisc::NumberOfWorkerThreadsToSpawn());
+
+	TArray<TSharedPtr<FJsonValue>> ScenarioResults;
+	int32 ExitCode = 0;
+
+	for (const EBattleFrameBenchmarkScenario Scenario : Scenarios)
+	{
+		FScenarioResult Result;
+		Result.Scenario = Scenario;
+
+		if (!RunScenario(Scenario, Settings, Result))
+		{
+			ExitCode = 1;
+			continue;
+		}
+
+		ScenarioResults.Add(MakeShared<FJsonValueObject>(ToJson(Result, Settings)));
+	}
+
+	Root->SetArrayField(TEXT("scenarios"), ScenarioResults);
+
+	FString JsonString;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	FJsonSerializer::Serialize(Root, Writer);
+
+	if (!FFileHelper::SaveStringToFile(JsonString, *Settings.Output))
+	{
+		UE_LOG(LogBattleFrameBenchmark, Error, TEXT("Failed to write %s"), *Settings.Output);
+		return 1;
+	}
+
+	UE_LOG(LogBattleFrameBenchmark, Display, TEXT("Benchmark results written to %s"), *Settings.Output);
+
+	return ExitCode;
+}
+
+bool UBattleFrameBenchmarkCommandlet::RunScenario(EBattleFrameBenchmarkScenario Scenario, const FSettings& Settings, FScenarioResult& OutResult)
+{
+	UE_LOG(LogBattleFrameBenchmark, Display, TEXT("Running %s with %d agents for %d frames"), ToString(Scenario), Settings.Agents, Settings.Frames);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, FName(*FString::Printf(TEXT("BattleFrameBenchmark_%s"), ToString(Scenario))));
+
+	if (!World)
+	{
+		UE_LOG(LogBattleFrameBenchmark, Error, TEXT("Failed to create world for %s"), ToString(Scenario));
+		return false;
+	}
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	const float HalfExtent = FMath::Max(1000.f, FMath::Sqrt(Settings.Agents * BattleFrameBenchmark::AreaPerAgent));
+
+	AFlowField* FlowField = nullptr;
+	AAgentSpawner* Spawner = nullptr;
+	BuildArena(World, Scenario, Settings, HalfExtent, FlowField, Spawner);
+
+	// 游戏模式最后生成，保证开始游戏时网格已就绪
+	ABattleFrameGameMode* GameMode = World->SpawnActor<ABattleFrameGameMode>();
+	GameMode->bRecordStageStats = true;
+	GameMode->StageStatsHistoryFrames = Settings.Frames;
+
+	World->InitializeActorsForPlay(FURL());
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	SpawnAgents(World, Scenario, Settings, HalfExtent, FlowField, Spawner, OutResult);
+
+	OutResult.FrameTimesMs.Reserve(Settings.Frames);
+	OutResult.StageFrames.Reserve(Settings.Frames);
+
+	for (int32 Frame = 0; Frame < Settings.Warmup + Settings.Frames; ++Frame)
+	{
+		if (Scenario == EBattleFrameBenchmarkScenario::HeavyAoE)
+		{
+			ApplyAoE(GameMode, HalfExtent, Frame);
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		World->Tick(LEVELTICK_All, Settings.DeltaTime);
+		const double FrameTimeMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+		if (Frame >= Settings.Warmup)
+		{
+			OutResult.FrameTimesMs.Add(FrameTimeMs);
+
+			const FBattleFrameFrameStats& FrameStats = FBattleFrameStatsCollector::Get().GetLastFrame();
+			if (FrameStats.Frame == GFrameCounter)
+			{
+				OutResult.StageFrames.Add(FrameStats);
+			}
+		}
+
+		++GFrameCounter;
+	}
+
+	if (AMechanism* Mechanism = UMachine::ObtainMechanism(World))
+	{
+		OutResult.AliveAgents = Mechanism->EnchainSolid(FFilter::Make<FAgent>())->IterableNum();
+	}
+
+	// 清理场景
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		It->Destroy();
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return true;
+}
+
+void UBattleFrameBenchmarkCommandlet::BuildArena(UWorld* World, EBattleFrameBenchmarkScenario Scenario, const FSettings& Settings, float HalfExtent, AFlowField*& OutFlowField, AAgentSpawner*& OutSpawner)
+{
+	// 邻居网格覆盖整个场地
+	const FTransform ArenaTransform(FVector::ZeroVector);
+
+	ANeighborGridActor* Grid = World->SpawnActorDeferred<ANeighborGridActor>(ANeighborGridActor::StaticClass(), ArenaTransform);
+	const int32 GridCells = FMath::CeilToInt32(HalfExtent * 2.f / BattleFrameBenchmark::NeighborCellSize) + 2;
+	Grid->GetComponent()->CellSize = BattleFrameBenchmark::NeighborCellSize;
+	Grid->GetComponent()->Size = FIntVector(GridCells, GridCells, 1);
+	Grid->FinishSpawning(ArenaTransform);
+
+	// 流场目标放在场地一侧，行军与攻城场景从另一侧出发
+	OutFlowField = World->SpawnActorDeferred<AFlowField>(AFlowField::StaticClass(), ArenaTransform);
+	OutFlowField->flowFieldSize = FVector(HalfExtent * 2.f, HalfExtent * 2.f, 300.f);
+	OutFlowField->cellSize = BattleFrameBenchmark::FlowFieldCellSize;
+	OutFlowField->goalLocation = FVector(HalfExtent * 0.9f, 0.f, 0.f);
+	OutFlowField->bEditorLiveUpdate = false;
+	OutFlowField->drawCellsInGame = false;
+	OutFlowField->drawArrowsInGame = false;
+	OutFlowField->FinishSpawning(ArenaTransform);
+
+	// 场地中央的墙，中间留出一个窄口
+	if (Scenario == EBattleFrameBenchmarkScenario::ChokePointSiege)
+	{
+		const float GapHalfWidth = FMath::Max(300.f, HalfExtent * 0.05f);
+		const float WallHalfLength = (HalfExtent - GapHalfWidth) * 0.5f;
+
+		for (const float Side : { -1.f, 1.f })
+		{
+			const FTransform WallTransform(FVector(0.f, Side * (GapHalfWidth + WallHalfLength), 0.f));
+
+			ARVOSquareObstacle* Wall = World->SpawnActorDeferred<ARVOSquareObstacle>(ARVOSquareObstacle::StaticClass(), WallTransform);
+			Wall->BoxComponent->SetBoxExtent(FVector(BattleFrameBenchmark::WallThickness, WallHalfLength, 200.f));
+			Wall->FinishSpawning(WallTransform);
+		}
+	}
+
+	OutSpawner = World->SpawnActor<AAgentSpawner>();
+	OutSpawner->AgentConfigAssets.Reset();
+
+	for (const FSoftObjectPath& Path : Settings.Configs)
+	{
+		OutSpawner->AgentConfigAssets.Add(TSoftObjectPtr<UAgentConfigDataAsset>(Path));
+	}
+}
+
+void UBattleFrameBenchmarkCommandlet::SpawnAgents(UWorld* World, EBattleFrameBenchmarkScenario Scenario, const FSettings& Settings, float HalfExtent, AFlowField* FlowField, AAgentSpawner* Spawner, FScenarioResult& OutResult)
+{
+	TArray<FSubjectHandle> Team0;
+	TArray<FSubjectHandle> Team1;
+
+	const int32 ConfigsNum = Settings.Configs.Num();
+	const FVector2D Region(HalfExtent * 0.6f, HalfExtent * 1.6f);
+
+	switch (Scenario)
+	{
+		case EBattleFrameBenchmarkScenario::OpenFieldMarch:
+		case EBattleFrameBenchmarkScenario::ChokePointSiege:
+		case EBattleFrameBenchmarkScenario::HeavyAoE:
+		{
+			// 按配置平均分配数量
+			for (int32 i = 0; i < ConfigsNum; ++i)
+			{
+				const int32 Quantity = Settings.Agents / ConfigsNum + (i < Settings.Agents % ConfigsNum ? 1 : 0);
+				const FVector Origin = Scenario == EBattleFrameBenchmarkScenario::HeavyAoE ? FVector::ZeroVector : FVector(-HalfExtent * 0.6f, 0.f, 0.f);
+				const FVector2D SpawnRegion = Scenario == EBattleFrameBenchmarkScenario::HeavyAoE ? FVector2D(HalfExtent * 1.6f) : Region;
+
+				Team0.Append(Spawner->SpawnAgentsRectangular(i, Quantity, 0, Origin, SpawnRegion, 0.f, EInitialDirection::FaceForward));
+			}
+			break;
+		}
+		case EBattleFrameBenchmarkScenario::TwoArmyMelee:
+		{
+			// 两支队伍面对面，各占一半
+			const int32 Half = Settings.Agents / 2;
+
+			Team0 = Spawner->SpawnAgentsRectangular(0, Half, 0, FVector(-HalfExtent * 0.5f, 0.f, 0.f), Region, 0.f, EInitialDirection::FaceLocation, FVector::ZeroVector);
+			Team1 = Spawner->SpawnAgentsRectangular(1 % ConfigsNum, Settings.Agents - Half, 1, FVector(HalfExtent * 0.5f, 0.f, 0.f), Region, 0.f, EInitialDirection::FaceLocation, FVector::ZeroVector);
+			break;
+		}
+	}
+
+	// 改为使用本场景生成的流场，近战场景改为按队伍索敌
+	auto Setup = [&](TArray<FSubjectHandle>& Agents, UScriptStruct* EnemyTeam)
+	{
+		for (FSubjectHandle& Agent : Agents)
+		{
+			if (!Agent.IsValid()) continue;
+
+			if (FNavigation* Navigation = Agent.GetTraitPtr<FNavigation, EParadigm::Unsafe>())
+			{
+				Navigation->FlowFieldActor = FlowField;
+				Navigation->FlowField = FlowField;
+			}
+
+			if (EnemyTeam)
+			{
+				if (FTrace* Trace = Agent.GetTraitPtr<FTrace, EParadigm::Unsafe>())
+				{
+					Trace->bEnable = true;
+					Trace->Mode = ETraceMode::SphereTraceByTraits;
+					Trace->IncludeTraits = { EnemyTeam };
+					Trace->Range = HalfExtent * 2.f;
+				}
+			}
+		}
+	};
+
+	const bool bMelee = Scenario == EBattleFrameBenchmarkScenario::TwoArmyMelee;
+	Setup(Team0, bMelee ? FTeam1::StaticStruct() : nullptr);
+	Setup(Team1, bMelee ? FTeam0::StaticStruct() : nullptr);
+
+	OutResult.SpawnedAgents = Team0.Num() + Team1.Num();
+
+	if (OutResult.SpawnedAgents < Settings.Agents)
+	{
+		UE_LOG(LogBattleFrameBenchmark, Warning, TEXT("%s spawned %d of %d agents, check the agent configs"), ToString(Scenario), OutResult.SpawnedAgents, Settings.Agents);
+	}
+}
+
+void UBattleFrameBenchmarkCommandlet::ApplyAoE(ABattleFrameGameMode* GameMode, float HalfExtent, int32 Frame)
+{
+	// 每帧若干个固定序列的爆炸点，保证多次运行的负载一致
+	FRandomStream Stream(Frame);
+
+	FDmgSphere DmgSphere;
+	DmgSphere.Damage = 20.f;
+	DmgSphere.FireDmg = 0.5f;
+
+	FDebuff Debuff;
+	Debuff.bCanTemporalDmg = true;
+	Debuff.bCanSlow = true;
+
+	if (!ANeighborGridActor::GetInstance()) return;
+
+	const FFilter Filter = FFilter::Make<FAgent, FHealth>();
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		const FVector Center(Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(-HalfExtent, HalfExtent), 0.f);
+
+		TArray<FSubjectHandle> Results;
+		ANeighborGridActor::GetInstance()->GetComponent()->SphereTraceForSubjects(Center, 600.f, Filter, Results);
+
+		if (Results.Num() > 0)
+		{
+			GameMode->ApplyDamageToSubjects(Results, TArray<FSubjectHandle>(), FSubjectHandle(), Center, DmgSphere, Debuff);
+		}
+	}
+}
+
+TSharedRef<FJsonObject> UBattleFrameBenchmarkCommandlet::ToJson(const FScenarioResult& Result, const FSettings& Settings)
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+
+	Json->SetStringField(TEXT("scenario"), ToString(Result.Scenario));
+	Json->SetNumberField(TEXT("spawnedAgents"), Result.SpawnedAgents);
+	Json->SetNumberField(TEXT("aliveAgents"), Result.AliveAgents);
+	Json->SetObjectField(TEXT("frameTimeMs"), BattleFrameBenchmark::Summarize(Result.FrameTimesMs));
+
+	// 按阶段名汇总
+	TArray<FName> StageOrder;
+	TMap<FName, TArray<const FBattleFrameStageStats*>> StagesByName;
+
+	for (const FBattleFrameFrameStats& FrameStats : Result.StageFrames)
+	{
+		for (const FBattleFrameStageStats& StageStats : FrameStats.Stages)
+		{
+			if (!StagesByName.Contains(StageStats.Stage))
+			{
+				StageOrder.Add(StageStats.Stage);
+			}
+
+			StagesByName.FindOrAdd(StageStats.Stage).Add(&StageStats);
+		}
+	}
+
+	TArray<double> PipelineTimes;
+	for (const FBattleFrameFrameStats& FrameStats : Result.StageFrames) { PipelineTimes.Add(FrameStats.TotalTimeMs); }
+	Json->SetObjectField(TEXT("pipelineTimeMs"), BattleFrameBenchmark::Summarize(PipelineTimes));
+
+	TArray<TSharedPtr<FJsonValue>> Stages;
+
+	for (const FName Stage : StageOrder)
+	{
+		const TArray<const FBattleFrameStageStats*>& Samples = StagesByName[Stage];
+
+		TArray<double> Times;
+		double IterableSum = 0.0;
+		double DeferredSum = 0.0;
+		int32 MaxThreads = 0;
+		int32 MaxBatch = 0;
+
+		for (const FBattleFrameStageStats* Sample : Samples)
+		{
+			Times.Add(Sample->TimeMs);
+			IterableSum += Sample->IterableNum;
+			DeferredSum += Sample->DeferredOps;
+			MaxThreads = FMath::Max(MaxThreads, Sample->ThreadsCount);
+			MaxBatch = FMath::Max(MaxBatch, Sample->BatchSize);
+		}
+
+		TSharedRef<FJsonObject> StageJson = MakeShared<FJsonObject>();
+		StageJson->SetStringField(TEXT("stage"), Stage.ToString());
+		StageJson->SetObjectField(TEXT("timeMs"), BattleFrameBenchmark::Summarize(Times));
+		StageJson->SetNumberField(TEXT("meanIterable"), IterableSum / Samples.Num());
+		StageJson->SetNumberField(TEXT("meanDeferredOps"), DeferredSum / Samples.Num());
+		StageJson->SetNumberField(TEXT("maxThreads"), MaxThreads);
+		StageJson->SetNumberField(TEXT("maxBatchSize"), MaxBatch);
+
+		Stages.Add(MakeShared<FJsonValueObject>(StageJson));
+	}
+
+	Json->SetArrayField(TEXT("stages"), Stages);
+
+	return Json;
+}
+
+const TCHAR* UBattleFrameBenchmarkCommandlet::ToString(EBattleFrameBenchmarkScenario Scenario)
+{
+	switch (Scenario)
+	{
+		case EBattleFrameBenchmarkScenario::OpenFieldMarch:  return TEXT("OpenFieldMarch");
+		case EBattleFrameBenchmarkScenario::ChokePointSiege: return TEXT("ChokePointSiege");
+		case EBattleFrameBenchmarkScenario::TwoArmyMelee:    return TEXT("TwoArmyMelee");
+		case EBattleFrameBenchmarkScenario::HeavyAoE:        return TEXT("HeavyAoE");
+	}
+
+	return TEXT("Unknown");
+}
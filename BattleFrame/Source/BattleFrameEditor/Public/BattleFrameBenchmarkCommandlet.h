@@ -0,0 +1,81 @@
+/*
+* BattleFrame
+* Created: 2025
+* Author: Leroy Works, All Rights Reserved.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BattleFrameStats.h"
+
+#include "BattleFrameBenchmarkCommandlet.generated.h"
+
+class UWorld;
+class AAgentSpawner;
+class AFlowField;
+class ABattleFrameGameMode;
+
+// 压测场景
+enum class EBattleFrameBenchmarkScenario : uint8
+{
+	OpenFieldMarch,  // 空旷地形行军，全员朝同一目标移动
+	ChokePointSiege, // 大量单位挤过狭窄通道
+	TwoArmyMelee,    // 两支队伍对冲近战
+	HeavyAoE         // 持续范围伤害，大量受击、死亡与特效
+};
+
+/**
+ * Headless crowd benchmark. Builds a throwaway arena per scenario, steps the battle pipeline for a fixed number of
+ * frames and writes frame time percentiles plus per stage timings to JSON.
+ *
+ * UnrealEditor-Cmd.exe <Project>.uproject -run=BattleFrameBenchmark -nullrhi -unattended
+ *     [-Scenario=All|OpenFieldMarch|ChokePointSiege|TwoArmyMelee|HeavyAoE] [-Agents=10000] [-Frames=600] [-Warmup=60]
+ *     [-DeltaTime=0.0166] [-Configs=/Path/To/AgentConfigA,/Path/To/AgentConfigB] [-Output=<file.json>] [-Label=<text>]
+ */
+UCLASS()
+class BATTLEFRAMEEDITOR_API UBattleFrameBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UBattleFrameBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	struct FSettings
+	{
+		int32 Agents = 10000;
+		int32 Frames = 600;
+		int32 Warmup = 60;
+		float DeltaTime = 1.f / 60.f;
+		TArray<FSoftObjectPath> Configs;
+		FString Output;
+		FString Label;
+	};
+
+	struct FScenarioResult
+	{
+		EBattleFrameBenchmarkScenario Scenario;
+		int32 SpawnedAgents = 0;
+		int32 AliveAgents = 0;
+		TArray<double> FrameTimesMs;
+		TArray<FBattleFrameFrameStats> StageFrames;
+	};
+
+	bool RunScenario(EBattleFrameBenchmarkScenario Scenario, const FSettings& Settings, FScenarioResult& OutResult);
+
+	void BuildArena(UWorld* World, EBattleFrameBenchmarkScenario Scenario, const FSettings& Settings, float HalfExtent, AFlowField*& OutFlowField, AAgentSpawner*& OutSpawner);
+
+	void SpawnAgents(UWorld* World, EBattleFrameBenchmarkScenario Scenario, const FSettings& Settings, float HalfExtent, AFlowField* FlowField, AAgentSpawner* Spawner, FScenarioResult& OutResult);
+
+	void ApplyAoE(ABattleFrameGameMode* GameMode, float HalfExtent, int32 Frame);
+
+	static TSharedRef<class FJsonObject> ToJson(const FScenarioResult& Result, const FSettings& Settings);
+
+	static const TCHAR* ToString(EBattleFrameBenchmarkScenario Scenario);
+};